@@ -1,25 +1,54 @@
-#include <algorithm>
-#include <sstream>
-
 #include "processor.h"
 #include "rob.h"
 
+namespace {
+
+MachineConfig memoryConfig(unsigned memoryLatency, int seed) {
+    MachineConfig config;
+    config.latency = memoryLatency;
+    config.seed = seed;
+    return config;
+}
+
+}  // namespace
+
 /**
  * @brief Construct a new Backend:: Backend object
- * 用于构造后端流水线，同时初始化数据内存
+ * 用于构造后端流水线，同时初始化数据内存，结构参数取默认值
  * @param rf 寄存器堆指针
  * @param data 数据内存初始化数组，从0x80400000开始
  */
 Backend::Backend(const std::vector<unsigned> &data,
                  RegisterFile *const reg,
-                 unsigned memoryLatency)
-    : alu("ALU"),
-      bru("BRU"),
-      lsu("LSU"),
-      mul("MUL"),
-      div("DIV"),
+                 unsigned memoryLatency,
+                 int seed)
+    : Backend(data, reg, memoryConfig(memoryLatency, seed)) {}
+
+/**
+ * @brief 按机器描述构造后端，ROB、保留站、执行单元与主存的参数来自 config
+ *
+ * @param data 数据内存初始化数组，从0x80400000开始
+ * @param reg 寄存器堆指针
+ * @param config
+ */
+Backend::Backend(const std::vector<unsigned> &data,
+                 RegisterFile *const reg,
+                 const MachineConfig &config)
+    : alu(FUType::ALU, config.fuLatency[static_cast<int>(FUType::ALU)]),
+      bru(FUType::BRU, config.fuLatency[static_cast<int>(FUType::BRU)]),
+      lsu(FUType::LSU, config.fuLatency[static_cast<int>(FUType::LSU)]),
+      mul(FUType::MUL, config.fuLatency[static_cast<int>(FUType::MUL)]),
+      div(FUType::DIV, config.fuLatency[static_cast<int>(FUType::DIV)]),
+      rob(config.robSize),
+      rsALU(config.rsSize),
+      rsBRU(config.rsSize),
+      rsMUL(config.rsSize),
+      rsDIV(config.rsSize),
+      rsLSU(config.rsSize),
+      storeBuffer(config.robSize),
+      loadBuffer(config.robSize),
       regFile(reg),
-      memory(memoryLatency) {
+      memory(config.latency, config.seed) {
     memory.functionalWrite(0, data);
 }
 
@@ -33,52 +62,6 @@ std::optional<ROBStatusWritePort> Backend::execute(ExecutePipeline &pipeline) {
     return tmp;
 }
 
-/**
- * @brief 后端执行函数
- *
- * @param frontend cpu的前端，用于调用前端接口
- * @return true 提交了EXIT指令
- * @return false 未提交EXIT指令
- */
-bool Backend::step(Frontend &frontend) {
-    auto commit = rob.getFront();
-
-    std::vector<std::optional<ROBStatusWritePort>> writeSave;
-
-    writeSave.push_back(execute(alu));
-    writeSave.push_back(execute(bru));
-    writeSave.push_back(execute(mul));
-    writeSave.push_back(execute(div));
-    writeSave.push_back(execute(lsu));
-
-    if (rsALU.canIssue() && alu.canExecute()) alu.execute(rsALU.issue());
-    if (rsBRU.canIssue() && bru.canExecute()) bru.execute(rsBRU.issue());
-    if (rsMUL.canIssue() && mul.canExecute()) mul.execute(rsMUL.issue());
-    if (rsDIV.canIssue() && div.canExecute()) div.execute(rsDIV.issue());
-    if (rsLSU.canIssue() && lsu.canExecute()) lsu.execute(rsLSU.issue());
-
-    std::for_each(writeSave.begin(),
-                  writeSave.end(),
-                  [this](std::optional<ROBStatusWritePort> &tmp) {
-                      if (tmp.has_value()) {
-                          rsALU.wakeup(tmp.value());
-                          rsBRU.wakeup(tmp.value());
-                          rsMUL.wakeup(tmp.value());
-                          rsDIV.wakeup(tmp.value());
-                          rsLSU.wakeup(tmp.value());
-                          rob.writeState(tmp.value());
-                      }
-                  });
-
-    bool executeExit = false;
-
-    if (commit.has_value() && commit.value().state.ready) {
-        auto &entry = commit.value();
-        executeExit = commitInstruction(entry, frontend);
-    }
-    return executeExit;
-}
-
 /**
  * @brief 用于刷新后端状态
  * 清空所有正在后端执行的指令数据，以及寄存器的busy标记
@@ -111,12 +94,11 @@ void Backend::flush() {
  * @return unsigned 地址对应的数据
  */
 unsigned Backend::read(unsigned addr) const {
-    return memory.functionalRead((addr - 0x80400000u) >> 2u, 1)[0];
+    return memory.functionalRead((addr - 0x80400000u) >> 2u);
 }
 
 void Backend::functionalWrite(unsigned addr, unsigned value) {
-    memory.functionalWrite((addr - 0x80400000u) >> 2u,
-                           std::vector<unsigned int>({value}));
+    memory.functionalWrite((addr - 0x80400000u) >> 2u, value);
 }
 
 /**
@@ -134,7 +116,92 @@ bool Backend::writeMemoryHierarchy(unsigned address,
     return memory.write((address - 0x80400000u) >> 2u, data, byteEnable);
 }
 
-void Backend::reset(const std::vector<unsigned> &data) {
-    memory.functionalWrite(0, data);
+/**
+ * @brief 装载程序映像的数据区，数据内存直接引用映像中的页，写入时才复制
+ *
+ * @param image 程序映像
+ */
+void Backend::reset(const ProgramImagePtr &image) {
+    memory.mapImage(image);
     flush();
+    rob.resetCommitted();
+}
+
+/**
+ * @brief 回到建立快照时的状态，只复制此后被写入过的数据内存页
+ *
+ */
+void Backend::restoreSnapshot() {
+    memory.restoreSnapshot();
+    flush();
+    rob.resetCommitted();
+}
+
+/**
+ * @brief 后端状态发生变化的累计次数，不含计时器的倒计时
+ * 发射、写回、提交、清空以及主存请求的开始与完成都会使其增加
+ *
+ * @return unsigned long
+ */
+unsigned long Backend::getActivity() const {
+    return alu.getActivity() + bru.getActivity() + mul.getActivity() +
+           div.getActivity() + lsu.getActivity() + rob.getActivity() +
+           memory.getActivity();
+}
+
+/**
+ * @brief 读取后端的所有计时器
+ *
+ * @return Backend::Timers
+ */
+Backend::Timers Backend::getTimers() const {
+    return {alu.getCounter(),
+            bru.getCounter(),
+            mul.getCounter(),
+            div.getCounter(),
+            lsu.getCounter(),
+            memory.getRemainingTime()};
+}
+
+/**
+ * @brief 跳过若干个空闲周期，按每周期的减少量推进计时器
+ *
+ * @param delta 一个空闲周期内各计时器的减少量
+ * @param cycles 跳过的周期数
+ */
+void Backend::advanceTimers(const Timers &delta, unsigned long cycles) {
+    alu.advance(delta[0] * cycles);
+    bru.advance(delta[1] * cycles);
+    mul.advance(delta[2] * cycles);
+    div.advance(delta[3] * cycles);
+    lsu.advance(delta[4] * cycles);
+    memory.advance(delta[5] * cycles);
+}
+
+/**
+ * @brief 保存后端的全部部件，寄存器堆由处理器单独保存
+ *
+ * @param out 检查点
+ */
+void Backend::save(CheckpointWriter &out) const {
+    out.writeTag("BKND");
+    for (const auto *pipeline : {&alu, &bru, &lsu, &mul, &div})
+        pipeline->save(out);
+    rob.save(out);
+    for (const auto *rs : {&rsALU, &rsBRU, &rsMUL, &rsDIV, &rsLSU})
+        rs->save(out);
+    storeBuffer.save(out);
+    loadBuffer.save(out);
+    memory.save(out);
+}
+
+void Backend::restore(CheckpointReader &in) {
+    in.expectTag("BKND");
+    for (auto *pipeline : {&alu, &bru, &lsu, &mul, &div})
+        pipeline->restore(in);
+    rob.restore(in);
+    for (auto *rs : {&rsALU, &rsBRU, &rsMUL, &rsDIV, &rsLSU}) rs->restore(in);
+    storeBuffer.restore(in);
+    loadBuffer.restore(in);
+    memory.restore(in);
 }
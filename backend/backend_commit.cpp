@@ -2,6 +2,7 @@
 
 #include "logger.h"
 #include "processor.h"
+#include "with_predict.h"
 
 /**
  * @brief 处理前端流出的指令
@@ -30,8 +31,9 @@ bool Backend::dispatchInstruction([[maybe_unused]] const Instruction &inst) {
  * @return true 提交了 EXTRA::EXIT
  * @return false 其他情况
  */
+template <typename FrontendPolicy>
 bool Backend::commitInstruction([[maybe_unused]] const ROBEntry &entry,
-                                [[maybe_unused]] Frontend &frontend) {
+                                [[maybe_unused]] FrontendPolicy &frontend) {
     // TODO: Commit instructions here.
     // Set executeExit when committing EXTRA::EXIT
     // NOTE: Be careful about Store Buffer!
@@ -46,3 +48,8 @@ bool Backend::commitInstruction([[maybe_unused]] const ROBEntry &entry,
         "Committing area in backend.cpp is not implemented!");
     return false;
 }
+
+template bool Backend::commitInstruction(const ROBEntry &entry,
+                                         Frontend &frontend);
+template bool Backend::commitInstruction(const ROBEntry &entry,
+                                         FrontendWithPredict &frontend);
@@ -1,12 +1,23 @@
 #include <sstream>
 #include <stdexcept>
-#include <utility>
 
 #include "logger.h"
 #include "processor.h"
+#include "trace.h"
 
-ExecutePipeline::ExecutePipeline(std::string name) : name(std::move(name)) {
+/**
+ * @brief 构造执行单元
+ *
+ * @param type 执行单元种类
+ * @param latency 每条指令的执行周期数
+ */
+ExecutePipeline::ExecutePipeline(FUType type, unsigned latency)
+    : type(type), latency(latency) {
     counter = 0;
+    if (latency == 0) {
+        Logger::Error("Execute pipeline %s has zero latency", getFUName(type));
+        throw std::invalid_argument("Zero execute pipeline latency");
+    }
 }
 
 /**
@@ -16,24 +27,15 @@ ExecutePipeline::ExecutePipeline(std::string name) : name(std::move(name)) {
  */
 void ExecutePipeline::execute(const IssueSlot &x) {
     if (executeSlot.busy) {
-        Logger::Error("ExecutePipeline %s: execute slot busy", name.c_str());
+        Logger::Error("ExecutePipeline %s: execute slot busy",
+                      getFUName(type));
         throw std::runtime_error("Execute slot busy");
     }
     executeSlot = x;
-    if (name == "ALU") {
-        counter = 1;
-    } else if (name == "BRU") {
-        counter = 1;
-    } else if (name == "LSU") {
-        counter = 2;
-    } else if (name == "MUL") {
-        counter = 3;
-    } else if (name == "DIV") {
-        counter = 10;
-    } else {
-        Logger::Error("Unknown execute pipeline %s", name.c_str());
-        throw std::runtime_error("Unexpected execute pipeline name");
-    }
+    activity++;
+    Tracer::recordInstruction(
+        TraceEvent::ISSUE, x.inst, x.robIdx, 0, static_cast<unsigned>(type));
+    counter = latency;
 }
 
 /**
@@ -54,27 +56,29 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Memory &memory,
 
     if (counter != 0) counter--;
 
-    std::stringstream ss;
-    ss << executeSlot.inst;
+    // 反汇编开销较大，仅在开启信息输出时进行
+    if (Logger::isInfoEnabled<LogCategory::EXECUTE>()) {
+        std::stringstream ss;
+        ss << executeSlot.inst;
 
-    Logger::Info("Execute pipeline %s:", name.c_str());
-    Logger::Info("Running %s", ss.str().c_str());
-    Logger::Info("ROB Index: %u", executeSlot.robIdx);
-    Logger::Info("Operand1: %u, Operand2: %u",
-                 executeSlot.readPort1.value,
-                 executeSlot.readPort2.value);
-    Logger::Info("Time Remaining: %d\n", counter);
+        Logger::Info<LogCategory::EXECUTE>(
+            "Execute pipeline %s:", getFUName(type));
+        Logger::Info<LogCategory::EXECUTE>("Running %s", ss.str().c_str());
+        Logger::Info<LogCategory::EXECUTE>("ROB Index: %u", executeSlot.robIdx);
+        Logger::Info<LogCategory::EXECUTE>("Operand1: %u, Operand2: %u",
+                                           executeSlot.readPort1.value,
+                                           executeSlot.readPort2.value);
+        Logger::Info<LogCategory::EXECUTE>("Time Remaining: %d\n", counter);
+    }
 
     if (counter == 0) {
         executeSlot.busy = false;
         ROBStatusWritePort result{};
         ExecuteResultBundle exe = executeSlot.inst.execute(
-            name, executeSlot.readPort1.value, executeSlot.readPort2.value);
-        if (name == "LSU") {
+            type, executeSlot.readPort1.value, executeSlot.readPort2.value);
+        if (type == FUType::LSU) {
             auto const &inst = executeSlot.inst;
-            using namespace RV32I;
-            if (inst == LB || inst == LH || inst == LW || inst == LBU ||
-                inst == LHU) {
+            if (inst.type != InstructionType::S) {
                 unsigned loadResult;
                 auto val = stBuf.query(
                     exe.result, executeSlot.robIdx, rob.getPopPtr());
@@ -92,21 +96,22 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Memory &memory,
                 } else {
                     loadResult = val.value();
                 }
-                if (inst == LW) {
-                } else if (inst == LH || inst == LHU) {
+                if (inst.opcode == Opcode::LW) {
+                } else if (inst.opcode == Opcode::LH || inst.opcode == Opcode::LHU) {
                     if (exe.result & 2u) {
                         loadResult >>= 16u;
                     } else {
                         loadResult &= 0xFFFFu;
                     }
-                    if (inst == LH && (loadResult & 0x8000u)) {
+                    if (inst.opcode == Opcode::LH && (loadResult & 0x8000u)) {
                         loadResult |= 0xFFFF0000u;
                     }
-                } else if (inst == LB || inst == LBU) {
+                } else if (inst.opcode == Opcode::LB ||
+                           inst.opcode == Opcode::LBU) {
                     unsigned offset = exe.result & 0x3u;
                     unsigned shift = offset << 3u;
                     loadResult = (loadResult >> shift) & 0xFFu;
-                    if (inst == LB && (loadResult & 0x80u)) {
+                    if (inst.opcode == Opcode::LB && (loadResult & 0x80u)) {
                         loadResult |= 0xFFFFFF00u;
                     }
                 }
@@ -136,8 +141,9 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Memory &memory,
                         return std::nullopt;
                     }
                     auto tmp = memory.read((exe.result - 0x80400000u) >> 2u);
-                    Logger::Info("Memory Read Flag: %s\n",
-                                 tmp.has_value() ? "true" : "false");
+                    Logger::Info<LogCategory::EXECUTE>(
+                        "Memory Read Flag: %s\n",
+                        tmp.has_value() ? "true" : "false");
                     if (!tmp.has_value()) {
                         executeSlot.busy = true;
                         return std::nullopt;
@@ -147,9 +153,9 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Memory &memory,
                 } else {
                     originalValue = val.value();
                 }
-                if (inst == SW) {
+                if (inst.opcode == Opcode::SW) {
                     originalValue = executeSlot.readPort2.value;
-                } else if (inst == SH) {
+                } else if (inst.opcode == Opcode::SH) {
                     if (exe.result & 2u) {
                         originalValue &= 0xFFFFu;
                         originalValue |= (executeSlot.readPort2.value << 16u);
@@ -158,7 +164,7 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Memory &memory,
                         originalValue |=
                             (executeSlot.readPort2.value & 0xFFFFu);
                     }
-                } else if (inst == SB) {
+                } else if (inst.opcode == Opcode::SB) {
                     unsigned offset = exe.result & 0x3u;
                     unsigned byte = executeSlot.readPort2.value & 0xFFu;
                     switch (offset) {
@@ -222,28 +228,30 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Cache &cache,
 
     if (counter != 0) counter--;
 
-    std::stringstream ss;
-    ss << executeSlot.inst;
+    // 反汇编开销较大，仅在开启信息输出时进行
+    if (Logger::isInfoEnabled<LogCategory::EXECUTE>()) {
+        std::stringstream ss;
+        ss << executeSlot.inst;
 
-    Logger::Info("Execute pipeline %s:", name.c_str());
-    Logger::Info("Running %s", ss.str().c_str());
-    Logger::Info("ROB Index: %u", executeSlot.robIdx);
-    Logger::Info("Operand1: %u, Operand2: %u",
-                 executeSlot.readPort1.value,
-                 executeSlot.readPort2.value);
-    Logger::Info("Time Remaining: %d\n", counter);
+        Logger::Info<LogCategory::EXECUTE>(
+            "Execute pipeline %s:", getFUName(type));
+        Logger::Info<LogCategory::EXECUTE>("Running %s", ss.str().c_str());
+        Logger::Info<LogCategory::EXECUTE>("ROB Index: %u", executeSlot.robIdx);
+        Logger::Info<LogCategory::EXECUTE>("Operand1: %u, Operand2: %u",
+                                           executeSlot.readPort1.value,
+                                           executeSlot.readPort2.value);
+        Logger::Info<LogCategory::EXECUTE>("Time Remaining: %d\n", counter);
+    }
 
     if (counter == 0) {
         executeSlot.busy = false;
         ROBStatusWritePort result{};
         ExecuteResultBundle exe = executeSlot.inst.execute(
-            name, executeSlot.readPort1.value, executeSlot.readPort2.value);
+            type, executeSlot.readPort1.value, executeSlot.readPort2.value);
         bool cacheHit;
-        if (name == "LSU") {
+        if (type == FUType::LSU) {
             auto const &inst = executeSlot.inst;
-            using namespace RV32I;
-            if (inst == LB || inst == LH || inst == LW || inst == LBU ||
-                inst == LHU) {
+            if (inst.type != InstructionType::S) {
                 unsigned loadResult;
                 auto val = stBuf.query(
                     exe.result, executeSlot.robIdx, rob.getPopPtr());
@@ -264,21 +272,22 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Cache &cache,
                     // store-to-load forwarding is regarded as cache hit
                     cacheHit = true;
                 }
-                if (inst == LW) {
-                } else if (inst == LH || inst == LHU) {
+                if (inst.opcode == Opcode::LW) {
+                } else if (inst.opcode == Opcode::LH || inst.opcode == Opcode::LHU) {
                     if (exe.result & 2u) {
                         loadResult >>= 16u;
                     } else {
                         loadResult &= 0xFFFFu;
                     }
-                    if (inst == LH && (loadResult & 0x8000u)) {
+                    if (inst.opcode == Opcode::LH && (loadResult & 0x8000u)) {
                         loadResult |= 0xFFFF0000u;
                     }
-                } else if (inst == LB || inst == LBU) {
+                } else if (inst.opcode == Opcode::LB ||
+                           inst.opcode == Opcode::LBU) {
                     unsigned offset = exe.result & 0x3u;
                     unsigned shift = offset << 3u;
                     loadResult = (loadResult >> shift) & 0xFFu;
-                    if (inst == LB && (loadResult & 0x80u)) {
+                    if (inst.opcode == Opcode::LB && (loadResult & 0x80u)) {
                         loadResult |= 0xFFFFFF00u;
                     }
                 }
@@ -308,8 +317,9 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Cache &cache,
                     }
                     auto tmp =
                         cache.query(exe.result & 0xFFFFFFFCu, memory, cacheHit);
-                    Logger::Info("Memory Read Flag: %s\n",
-                                 tmp.has_value() ? "true" : "false");
+                    Logger::Info<LogCategory::EXECUTE>(
+                        "Memory Read Flag: %s\n",
+                        tmp.has_value() ? "true" : "false");
                     if (!tmp.has_value()) {
                         executeSlot.busy = true;
                         return std::nullopt;
@@ -321,9 +331,9 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Cache &cache,
                     // store-to-load forwarding is regarded as cache hit
                     cacheHit = true;
                 }
-                if (inst == SW) {
+                if (inst.opcode == Opcode::SW) {
                     originalValue = executeSlot.readPort2.value;
-                } else if (inst == SH) {
+                } else if (inst.opcode == Opcode::SH) {
                     if (exe.result & 2u) {
                         originalValue &= 0xFFFFu;
                         originalValue |= (executeSlot.readPort2.value << 16u);
@@ -332,7 +342,7 @@ std::optional<ROBStatusWritePort> ExecutePipeline::step(Cache &cache,
                         originalValue |=
                             (executeSlot.readPort2.value & 0xFFFFu);
                     }
-                } else if (inst == SB) {
+                } else if (inst.opcode == Opcode::SB) {
                     unsigned offset = exe.result & 0x3u;
                     unsigned byte = executeSlot.readPort2.value & 0xFFu;
                     switch (offset) {
@@ -391,3 +401,17 @@ bool ExecutePipeline::canExecute() const { return !executeSlot.busy; }
  *
  */
 void ExecutePipeline::flush() { executeSlot.busy = false; }
+
+void ExecutePipeline::save(CheckpointWriter &out) const {
+    out.writeTag("EXEC");
+    out.write(type);
+    out.write(executeSlot);
+    out.write(counter);
+}
+
+void ExecutePipeline::restore(CheckpointReader &in) {
+    in.expectTag("EXEC");
+    in.expect(type, "execute pipeline order");
+    in.read(executeSlot);
+    in.read(counter);
+}
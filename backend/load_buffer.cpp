@@ -1,15 +1,15 @@
 #include "load_buffer.h"
 
-#include <algorithm>
 #include <stdexcept>
 
+#include "checkpoint.h"
 #include "defines.h"
 #include "logger.h"
 
-LoadBuffer::LoadBuffer() {
-    std::for_each(buffer, buffer + ROB_SIZE, [](LoadBufferSlot &slot) {
+LoadBuffer::LoadBuffer(unsigned size) : buffer(size) {
+    for (auto &slot : buffer) {
         slot.valid = false;
-    });
+    }
 }
 
 /**
@@ -23,9 +23,9 @@ void LoadBuffer::push(unsigned addr, unsigned robIdx) {
     buffer[robIdx].robIdx = robIdx;
     buffer[robIdx].valid = true;
     buffer[robIdx].invalidate = false;
-    Logger::Info("Load buffer push:");
-    Logger::Info("Index: %u", robIdx);
-    Logger::Info("Address: %08x, robIdx: %u\n", addr, robIdx);
+    Logger::Info<LogCategory::LSU>("Load buffer push:");
+    Logger::Info<LogCategory::LSU>("Index: %u", robIdx);
+    Logger::Info<LogCategory::LSU>("Address: %08x, robIdx: %u\n", addr, robIdx);
 }
 
 /**
@@ -35,7 +35,7 @@ void LoadBuffer::push(unsigned addr, unsigned robIdx) {
  * @return LoadBufferSlot 返回对应项目
  */
 LoadBufferSlot LoadBuffer::pop(unsigned robIdx) {
-    Logger::Info("Load buffer pop");
+    Logger::Info<LogCategory::LSU>("Load buffer pop");
     buffer[robIdx].valid = false;
     return buffer[robIdx];
 }
@@ -45,9 +45,9 @@ LoadBufferSlot LoadBuffer::pop(unsigned robIdx) {
  *
  */
 void LoadBuffer::flush() {
-    std::for_each(buffer, buffer + ROB_SIZE, [](LoadBufferSlot &slot) {
+    for (auto &slot : buffer) {
         slot.valid = false;
-    });
+    }
 }
 
 /**
@@ -63,3 +63,27 @@ void LoadBuffer::check([[maybe_unused]] unsigned addr,
     // TODO: 完成 Load Buffer 的检验逻辑，寻找顺序错误的 load 指令
     throw std::runtime_error("Load Buffer Check not implemented");
 }
+
+void LoadBuffer::save(CheckpointWriter &out) const {
+    out.writeTag("LDBF");
+    out.write((unsigned) buffer.size());
+    for (const auto &slot : buffer) {
+        out.write(slot.valid);
+        if (!slot.valid) continue;
+        out.write(slot.robIdx);
+        out.write(slot.loadAddress);
+        out.write(slot.invalidate);
+    }
+}
+
+void LoadBuffer::restore(CheckpointReader &in) {
+    in.expectTag("LDBF");
+    in.expect((unsigned) buffer.size(), "load buffer size");
+    for (auto &slot : buffer) {
+        in.read(slot.valid);
+        if (!slot.valid) continue;
+        in.read(slot.robIdx);
+        in.read(slot.loadAddress);
+        in.read(slot.invalidate);
+    }
+}
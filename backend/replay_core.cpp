@@ -0,0 +1,303 @@
+#include "replay.h"
+#include "with_predict.h"
+
+namespace {
+
+// 与 Backend::step 相同的写回与发射顺序
+constexpr FUType unitOrder[] = {
+    FUType::ALU, FUType::BRU, FUType::MUL, FUType::DIV, FUType::LSU};
+
+}  // namespace
+
+ReplayCore::ReplayCore(const InstTrace &trace, const MachineConfig &config)
+    : config(config), trace(trace), memory(config.latency, config.seed),
+      rob(config.robSize) {
+    config.validate();
+
+    if (config.type == ProcessorType::predict)
+        predictor = std::make_unique<FrontendWithPredict>(
+            std::vector<unsigned>(), config);
+    else
+        predictor = std::make_unique<Frontend>(std::vector<unsigned>());
+    if (config.type == ProcessorType::cache)
+        dcache = std::make_unique<Cache>(config.cacheSize,
+                                         config.blockSize,
+                                         config.associativity,
+                                         config.writeThrough,
+                                         config.replaceType,
+                                         config.seed);
+
+    for (auto &station : stations) station.resize(config.rsSize, RSSlot{});
+    producer.fill(NONE);
+    jump(0);
+}
+
+/**
+ * @brief 读取源寄存器时需要等待的 ROB 表项
+ *
+ * @param reg 寄存器号，0 表示指令不读该操作数
+ * @return unsigned 写者尚未写回时为其 ROB 表项，否则为 NONE
+ */
+unsigned ReplayCore::operand(unsigned reg) const {
+    if (reg == 0) return NONE;
+    unsigned x = producer[reg];
+    return x != NONE && !rob[x].ready ? x : NONE;
+}
+
+/**
+ * @brief 取出下一条记录，用预测器判断跳转是否预测错误
+ *
+ * @return std::optional<FetchSlot> 追踪结束或停止取指时为 std::nullopt
+ */
+std::optional<ReplayCore::FetchSlot> ReplayCore::fetch() {
+    if (fetchBlocked || fetchSeq >= trace.size()) return std::nullopt;
+    unsigned long seq = fetchSeq++;
+    const auto &inst = decode(seq);
+    bool mispredict = inst.fuType == FUType::BRU &&
+                      predictor->calculateNextPC(inst.pc) != trace[seq].value;
+    fetchBlocked = mispredict;
+    return FetchSlot{seq, mispredict};
+}
+
+/**
+ * @brief 清空前端并从第 seq 条记录重新取指，与 Frontend::jump 相同
+ *
+ * @param seq
+ */
+void ReplayCore::jump(unsigned long seq) {
+    DISPATCH = std::nullopt;
+    ID = std::nullopt;
+    IF2 = std::nullopt;
+    fetchSeq = seq;
+    fetchBlocked = false;
+    IF1 = fetch();
+}
+
+/**
+ * @brief 前端步进，流水级之间的移动与 Frontend::step 相同
+ *
+ * @return std::optional<FetchSlot> 本周期流出的记录
+ */
+std::optional<ReplayCore::FetchSlot> ReplayCore::stepFrontend() {
+    if (DISPATCH == std::nullopt || !dispatchHalt) {
+        DISPATCH = ID;
+        ID = std::nullopt;
+    }
+    dispatchHalt = false;
+    auto x = DISPATCH;
+    if (ID == std::nullopt) {
+        ID = IF2;
+        IF2 = std::nullopt;
+    }
+    if (IF2 == std::nullopt) {
+        IF2 = IF1;
+        IF1 = std::nullopt;
+    }
+    if (IF1 == std::nullopt) IF1 = fetch();
+    return x;
+}
+
+/**
+ * @brief 把一条记录放入 ROB 与对应的保留站
+ *
+ * @param x
+ * @return true 后端接受该指令
+ * @return false ROB 或保留站已满
+ */
+bool ReplayCore::dispatch(const FetchSlot &x) {
+    if (robCount == config.robSize) return false;
+    const auto &inst = decode(x.seq);
+    RSSlot *slot = nullptr;
+    if (inst.fuType != FUType::NONE) {
+        for (auto &s : stations[static_cast<unsigned>(inst.fuType)]) {
+            if (s.busy) continue;
+            slot = &s;
+            break;
+        }
+        if (slot == nullptr) return false;
+    }
+
+    unsigned robIdx = (robHead + robCount) % config.robSize;
+    robCount++;
+    rob[robIdx] = {
+        x.seq, inst.fuType == FUType::NONE, x.mispredict, false, false};
+    if (slot != nullptr)
+        *slot = {x.seq, robIdx, {operand(inst.rs1), operand(inst.rs2)}, true};
+    if (inst.rd != 0) producer[inst.rd] = robIdx;
+    return true;
+}
+
+/**
+ * @brief LSU 执行完成时访问存储层次，load 与 store 都读取一次
+ * 较早的 store 已经执行但尚未提交时直接前递，视为 Cache 命中
+ *
+ * @param robIdx 访存指令的 ROB 表项
+ * @return true 访问完成
+ * @return false 主存或 Cache 尚未返回，下一周期重试
+ */
+bool ReplayCore::access(unsigned robIdx) {
+    auto &entry = rob[robIdx];
+    unsigned address = trace[entry.seq].value;
+    for (unsigned i = robHead; i != robIdx; i = (i + 1) % config.robSize) {
+        const auto &older = rob[i];
+        if (older.executed &&
+            decode(older.seq).type == InstructionType::S &&
+            (trace[older.seq].value >> 2u) == (address >> 2u)) {
+            entry.executed = entry.cacheHit = true;
+            return true;
+        }
+    }
+    if (dcache != nullptr) {
+        bool hit = false;
+        if (!dcache->query(address & ~0x3u, memory, hit).has_value())
+            return false;
+        entry.cacheHit = hit;
+    } else if (!memory.read((address - 0x80400000u) >> 2u).has_value()) {
+        return false;
+    }
+    entry.executed = true;
+    return true;
+}
+
+/**
+ * @brief 提交 ROB 头部的指令，store 在此时写入存储层次
+ *
+ * @return true 提交了 EXIT
+ * @return false 其他情况
+ */
+bool ReplayCore::commit() {
+    const auto entry = rob[robHead];
+    const auto &record = trace[entry.seq];
+    const auto &inst = decode(entry.seq);
+
+    if (inst.type == InstructionType::S) {
+        unsigned address = record.value & ~0x3u;
+        bool hit = false;
+        bool done =
+            dcache != nullptr
+                ? dcache->write(address, 0, memory, 0xF, hit)
+                : memory.write((address - 0x80400000u) >> 2u, 0, 0xF);
+        if (!done) return false;
+        if (dcache != nullptr) {
+            result.memoryAccesses++;
+            if (hit) result.cacheHits++;
+        }
+    }
+    if (dcache != nullptr && inst.fuType == FUType::LSU) {
+        result.memoryAccesses++;
+        if (entry.cacheHit) result.cacheHits++;
+    }
+    if (inst.fuType == FUType::BRU) {
+        BpuUpdateData x{};
+        x.pc = inst.pc;
+        x.isCall = inst.opcode == Opcode::JAL && inst.rd == 1;
+        x.isReturn = inst.opcode == Opcode::JALR && inst.rs1 == 1;
+        x.isBranch = inst.type == InstructionType::B;
+        x.branchTaken = !x.isBranch || record.value != inst.pc + 4;
+        x.jumpTarget = x.branchTaken ? record.value : inst.pc + inst.imm;
+        predictor->bpuBackendUpdate(x);
+    }
+
+    if (inst.rd != 0 && producer[inst.rd] == robHead) producer[inst.rd] = NONE;
+    robHead = (robHead + 1) % config.robSize;
+    robCount--;
+    result.instructions++;
+
+    if (inst.opcode == Opcode::EXIT) return true;
+    if (entry.mispredict) {
+        result.mispredicts++;
+        flush();
+        jump(entry.seq + 1);
+    }
+    return false;
+}
+
+/**
+ * @brief 清空后端，与 BackendWithCache::flush 相同
+ */
+void ReplayCore::flush() {
+    for (auto &station : stations) {
+        for (auto &slot : station) slot.busy = false;
+    }
+    for (auto &unit : units) unit.busy = false;
+    producer.fill(NONE);
+    robHead = robCount = 0;
+    memory.resetState();
+    if (dcache != nullptr) dcache->resetState();
+}
+
+/**
+ * @brief 回放一个周期，各部分的先后顺序与 ProcessorCore::step 相同
+ *
+ * @return true 提交了 EXIT
+ * @return false 其他情况
+ */
+bool ReplayCore::step() {
+    bool canCommit = robCount != 0 && rob[robHead].ready;
+
+    std::array<unsigned, std::size(unitOrder)> written{};
+    unsigned writes = 0;
+    for (auto type : unitOrder) {
+        auto &unit = units[static_cast<unsigned>(type)];
+        if (!unit.busy) continue;
+        if (unit.counter != 0) unit.counter--;
+        if (unit.counter != 0) continue;
+        if (type == FUType::LSU && !access(unit.robIdx)) continue;
+        unit.busy = false;
+        written[writes++] = unit.robIdx;
+    }
+
+    for (auto type : unitOrder) {
+        auto &unit = units[static_cast<unsigned>(type)];
+        if (unit.busy) continue;
+        RSSlot *oldest = nullptr, *ready = nullptr;
+        for (auto &slot : stations[static_cast<unsigned>(type)]) {
+            if (!slot.busy) continue;
+            if (oldest == nullptr || slot.seq < oldest->seq) oldest = &slot;
+            if (slot.wait[0] != NONE || slot.wait[1] != NONE) continue;
+            if (ready == nullptr || slot.seq < ready->seq) ready = &slot;
+        }
+        // 访存指令按程序顺序发射
+        if (type == FUType::LSU && ready != oldest) continue;
+        if (ready == nullptr) continue;
+        ready->busy = false;
+        unit = {ready->robIdx, config.fuLatency[static_cast<unsigned>(type)],
+                true};
+    }
+
+    for (unsigned i = 0; i < writes; i++) {
+        for (auto &station : stations) {
+            for (auto &slot : station) {
+                if (!slot.busy) continue;
+                for (auto &x : slot.wait) {
+                    if (x == written[i]) x = NONE;
+                }
+            }
+        }
+        rob[written[i]].ready = true;
+    }
+
+    bool finish = canCommit && commit();
+    auto x = stepFrontend();
+    if (x.has_value() && !dispatch(x.value())) dispatchHalt = true;
+    return finish;
+}
+
+/**
+ * @brief 回放到提交 EXIT，追踪不以 EXIT 结尾时回放到全部记录提交
+ *
+ * @return ReplayResult
+ */
+ReplayResult ReplayCore::run() {
+    bool finish = false;
+    while (!finish && result.instructions < trace.size()) {
+        finish = step();
+        result.cycles++;
+    }
+    return result;
+}
+
+ReplayResult replayTrace(const InstTrace &trace, const MachineConfig &config) {
+    ReplayCore core(trace, config);
+    return core.run();
+}
@@ -2,12 +2,12 @@
 
 #include <stdexcept>
 
+#include "checkpoint.h"
 #include "logger.h"
+#include "trace.h"
 
-ReorderBuffer::ReorderBuffer() {
-    for (auto &x : buffer) {
-        x.valid = false;
-    }
+ReorderBuffer::ReorderBuffer(unsigned size) : buffer(size) {
+    pushPtr = popPtr = 0;
 }
 
 /**
@@ -44,12 +44,14 @@ unsigned ReorderBuffer::push(const Instruction &x, bool ready) {
         Logger::Error("ReorderBuffer::push: ROB full!");
         throw std::runtime_error("ROB full when push!");
     }
+    activity++;
     buffer[pushPtr].valid = true;
     buffer[pushPtr].inst = x;
     buffer[pushPtr].state.ready = ready;
+    Tracer::recordInstruction(TraceEvent::DISPATCH, x, pushPtr);
     unsigned ret = pushPtr;
     pushPtr++;
-    if (pushPtr == ROB_SIZE) pushPtr -= ROB_SIZE;
+    if (pushPtr == buffer.size()) pushPtr = 0;
     return ret;
 }
 
@@ -65,9 +67,15 @@ void ReorderBuffer::pop() {
     if (!buffer[popPtr].state.ready) {
         Logger::Warn("ReorderBuffer::pop: ROB pop when entry is not ready!");
     }
+    activity++;
+    Tracer::recordInstruction(TraceEvent::COMMIT,
+                              buffer[popPtr].inst,
+                              popPtr,
+                              buffer[popPtr].state.result);
     buffer[popPtr].valid = false;
+    committed++;
     popPtr++;
-    if (popPtr == ROB_SIZE) popPtr -= ROB_SIZE;
+    if (popPtr == buffer.size()) popPtr = 0;
 }
 
 /**
@@ -75,6 +83,7 @@ void ReorderBuffer::pop() {
  *
  */
 void ReorderBuffer::flush() {
+    activity++;
     for (auto &x : buffer) {
         x.valid = false;
     }
@@ -89,18 +98,21 @@ std::optional<ROBEntry> ReorderBuffer::getFront() const {
 }
 
 void ReorderBuffer::writeState(const ROBStatusWritePort &x) {
-    Logger::Info("Writing entry %u\n", x.robIdx);
+    Logger::Info<LogCategory::ROB>("Writing entry %u\n", x.robIdx);
     if (!buffer[x.robIdx].valid) {
         Logger::Error(
             "ReorderBuffer::writeState writing state into an invalid entry!");
         throw std::runtime_error("Writing state into invalid entry!");
     }
+    activity++;
     buffer[x.robIdx].state.actualTaken = x.actualTaken;
     buffer[x.robIdx].state.mispredict = x.mispredict;
     buffer[x.robIdx].state.result = x.result;
     buffer[x.robIdx].state.jumpTarget = x.jumpTarget;
     buffer[x.robIdx].state.ready = true;
     buffer[x.robIdx].state.cacheHit = x.cacheHit;
+    Tracer::recordInstruction(
+        TraceEvent::WRITEBACK, buffer[x.robIdx].inst, x.robIdx, x.result);
 }
 
 unsigned ReorderBuffer::getPopPtr() const { return popPtr; }
@@ -112,3 +124,47 @@ unsigned ReorderBuffer::read(unsigned addr) const {
 bool ReorderBuffer::checkReady(unsigned addr) const {
     return buffer[addr].state.ready;
 }
+
+/**
+ * @brief 保存 ROB 的全部表项与指针，累计的提交条数一并保存
+ *
+ * @param out 检查点
+ */
+void ReorderBuffer::save(CheckpointWriter &out) const {
+    out.writeTag("ROB ");
+    out.write((unsigned) buffer.size());
+    out.write(pushPtr);
+    out.write(popPtr);
+    out.write(committed);
+    for (const auto &entry : buffer) {
+        out.write(entry.valid);
+        if (!entry.valid) continue;
+        out.write(entry.inst);
+        out.write(entry.state.result);
+        out.write(entry.state.mispredict);
+        out.write(entry.state.actualTaken);
+        out.write(entry.state.jumpTarget);
+        out.write(entry.state.ready);
+        out.write(entry.state.cacheHit);
+    }
+}
+
+void ReorderBuffer::restore(CheckpointReader &in) {
+    in.expectTag("ROB ");
+    in.expect((unsigned) buffer.size(), "ROB size");
+    in.read(pushPtr);
+    in.read(popPtr);
+    in.read(committed);
+    for (auto &entry : buffer) {
+        entry = ROBEntry{};
+        in.read(entry.valid);
+        if (!entry.valid) continue;
+        in.read(entry.inst);
+        in.read(entry.state.result);
+        in.read(entry.state.mispredict);
+        in.read(entry.state.actualTaken);
+        in.read(entry.state.jumpTarget);
+        in.read(entry.state.ready);
+        in.read(entry.state.cacheHit);
+    }
+}
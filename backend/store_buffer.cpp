@@ -2,10 +2,11 @@
 
 #include <stdexcept>
 
+#include "checkpoint.h"
 #include "logger.h"
 
 
-StoreBuffer::StoreBuffer() {
+StoreBuffer::StoreBuffer(unsigned size) : buffer(size) {
     pushPtr = popPtr = 0;
     for (auto &slot : buffer) {
         slot.valid = false;
@@ -23,12 +24,12 @@ void StoreBuffer::push(unsigned addr, unsigned value, unsigned robIdx) {
     buffer[pushPtr].storeData = value;
     buffer[pushPtr].robIdx = robIdx;
     buffer[pushPtr].valid = true;
-    Logger::Info("Store buffer push:");
-    Logger::Info("Index: %u", pushPtr);
-    Logger::Info("Address: %08x, value: %u\n", addr, value);
+    Logger::Info<LogCategory::LSU>("Store buffer push:");
+    Logger::Info<LogCategory::LSU>("Index: %u", pushPtr);
+    Logger::Info<LogCategory::LSU>("Address: %08x, value: %u\n", addr, value);
     pushPtr++;
-    if (pushPtr == ROB_SIZE) {
-        pushPtr -= ROB_SIZE;
+    if (pushPtr == buffer.size()) {
+        pushPtr = 0;
     }
 }
 
@@ -39,13 +40,14 @@ void StoreBuffer::push(unsigned addr, unsigned value, unsigned robIdx) {
  */
 StoreBufferSlot StoreBuffer::pop() {
     auto ret = buffer[popPtr];
-    Logger::Info("Store buffer pop:");
-    Logger::Info("Index: %u", popPtr);
-    Logger::Info("Address: %08x, value: %u\n", ret.storeAddress, ret.storeData);
+    Logger::Info<LogCategory::LSU>("Store buffer pop:");
+    Logger::Info<LogCategory::LSU>("Index: %u", popPtr);
+    Logger::Info<LogCategory::LSU>(
+        "Address: %08x, value: %u\n", ret.storeAddress, ret.storeData);
     buffer[popPtr].valid = false;
     popPtr++;
-    if (popPtr == ROB_SIZE) {
-        popPtr -= ROB_SIZE;
+    if (popPtr == buffer.size()) {
+        popPtr = 0;
     }
     return ret;
 }
@@ -81,3 +83,31 @@ std::optional<unsigned> StoreBuffer::query([[maybe_unused]] unsigned addr,
     // TODO: 完成 Store Buffer 的查询逻辑
     throw std::runtime_error("Store Buffer query not implemented.");
 }
+
+void StoreBuffer::save(CheckpointWriter &out) const {
+    out.writeTag("STBF");
+    out.write((unsigned) buffer.size());
+    out.write(pushPtr);
+    out.write(popPtr);
+    for (const auto &slot : buffer) {
+        out.write(slot.valid);
+        if (!slot.valid) continue;
+        out.write(slot.storeAddress);
+        out.write(slot.storeData);
+        out.write(slot.robIdx);
+    }
+}
+
+void StoreBuffer::restore(CheckpointReader &in) {
+    in.expectTag("STBF");
+    in.expect((unsigned) buffer.size(), "store buffer size");
+    in.read(pushPtr);
+    in.read(popPtr);
+    for (auto &slot : buffer) {
+        in.read(slot.valid);
+        if (!slot.valid) continue;
+        in.read(slot.storeAddress);
+        in.read(slot.storeData);
+        in.read(slot.robIdx);
+    }
+}
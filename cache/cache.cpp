@@ -2,9 +2,12 @@
 
 #include <cstring>
 #include <optional>
+#include <sstream>
 
+#include "checkpoint.h"
 #include "defines.h"
 #include "logger.h"
+#include "trace.h"
 
 CacheBlock::CacheBlock(size_t size) : size(size) {
     data = new unsigned char[size];
@@ -45,12 +48,15 @@ Cache::Cache(unsigned size,
              unsigned blockSize,
              unsigned associativity,
              bool writeThrough,
-             ReplaceType replaceType)
+             ReplaceType replaceType,
+             int seed)
     : size(size),
       blockSize(blockSize),
       associativity(associativity),
       writeThrough(writeThrough),
-      replaceType(replaceType) {
+      replaceType(replaceType),
+      seed(seed),
+      engine(seed) {
     unsigned setNum = size / blockSize / associativity;
     for (unsigned i = 0; i < setNum; i++) {
         cacheSets.emplace_back(associativity, blockSize);
@@ -66,6 +72,7 @@ Cache::Cache(unsigned size,
     replaceID = -1u;
     saveOffset = -1u;
 
+    activity = 0;
     occupied = false;
     occupyWriteFlag = false;
     occupyAddress = 0u;
@@ -94,7 +101,9 @@ void Cache::reset() {
 
     replaceID = -1u;
     saveOffset = -1u;
+    engine.seed(seed);
 
+    activity = 0;
     occupied = false;
     occupyWriteFlag = false;
     occupyAddress = 0u;
@@ -125,15 +134,17 @@ std::optional<unsigned> Cache::query(unsigned physAddr,
     unsigned index = (physAddr >> log2(blockSize)) & (setNum - 1u);
     unsigned tag = (physAddr >> log2(blockSize)) >> log2(setNum);
 
-    Logger::Info("Address: 0x%08x, tag: 0x%08x, index: %d, offset: %d\n",
-                 physAddr,
-                 tag,
-                 index,
-                 offset);
+    Logger::Info<LogCategory::CACHE>(
+        "Address: 0x%08x, tag: 0x%08x, index: %d, offset: %d\n",
+        physAddr,
+        tag,
+        index,
+        offset);
 
     for (unsigned i = 0; i < associativity; i++) {
         if (cacheSets[index][i].valid && cacheSets[index][i].tag == tag) {
-            Logger::Info("Query cache hit, index = %d", i);
+            Logger::Info<LogCategory::CACHE>("Query cache hit, index = %d", i);
+            recordEvent(TraceEvent::CACHE_HIT, physAddr, i, 0);
             if (replaceType == ReplaceType::LRU) {
                 auto it = lruPointers[index].begin();
                 while (*it != i) it++;
@@ -163,14 +174,23 @@ std::optional<unsigned> Cache::query(unsigned physAddr,
             replaceID = lruPointers[index].front();
             break;
         case ReplaceType::RANDOM:
-            replaceID = rand() % associativity;
+            replaceID = engine() % associativity;
             break;
         }
+        recordEvent(TraceEvent::CACHE_MISS, physAddr, replaceID, 0);
     }
 
     if (cacheSets[index][replaceID].valid &&
         cacheSets[index][replaceID].dirty) {
-        if (saveOffset == -1u) saveOffset = 0;
+        if (saveOffset == -1u) {
+            saveOffset = 0;
+            recordEvent(
+                TraceEvent::CACHE_EVICT,
+                ((cacheSets[index][replaceID].tag << log2(setNum)) | index)
+                    << log2(blockSize),
+                1,
+                0);
+        }
         unsigned reconstructedAddr =
             (((cacheSets[index][replaceID].tag << log2(setNum)) | index)
              << log2(blockSize)) +
@@ -190,13 +210,20 @@ std::optional<unsigned> Cache::query(unsigned physAddr,
     }
 
     if (saveOffset == -1u) {
-        saveOffset = 0u;
+        if (cacheSets[index][replaceID].valid)
+            recordEvent(
+                TraceEvent::CACHE_EVICT,
+                ((cacheSets[index][replaceID].tag << log2(setNum)) | index)
+                    << log2(blockSize),
+                0,
+                0);
         cacheSets[index][replaceID].valid = false;
+        saveOffset = 0u;
     }
     if (saveOffset != blockSize) {
         unsigned replaceAddr =
             (physAddr & (~(blockSize - 1u))) + saveOffset - 0x80400000u;
-        Logger::Info(
+        Logger::Info<LogCategory::CACHE>(
             "saveOffset = %d, replaceAddr = 0x%08x", saveOffset, replaceAddr);
         auto result = memory.read(replaceAddr >> 2u);
         if (result.has_value()) {
@@ -256,6 +283,72 @@ std::optional<unsigned> Cache::query(unsigned physAddr) const {
     return std::nullopt;
 }
 
+/**
+ * @brief 不建模时序地访问 Cache，只更新标签、替换与脏位状态，用于功能预热
+ * 缺失时直接从主存读入整块数据，替换出的脏块不写回：预热在体系结构状态
+ * 装载完成后进行，主存中已经是最新的数据
+ *
+ * @param physAddr 物理地址 (0x80400000u ~ 0x807FFFFCu)
+ * @param write 是否为写访问
+ * @param memory 使用的主存
+ * @return CacheAccess 是否命中，供区间模型统计缺失
+ */
+CacheAccess Cache::warm(unsigned physAddr, bool write, const Memory &memory) {
+    unsigned setNum = size / blockSize / associativity;
+    unsigned index = (physAddr >> log2(blockSize)) & (setNum - 1u);
+    unsigned tag = (physAddr >> log2(blockSize)) >> log2(setNum);
+
+    unsigned way = associativity;
+    for (unsigned i = 0; i < associativity; i++) {
+        if (cacheSets[index][i].valid && cacheSets[index][i].tag == tag) {
+            way = i;
+            break;
+        }
+    }
+
+    auto access = CacheAccess::HIT;
+    if (way == associativity) {
+        switch (replaceType) {
+        case ReplaceType::FIFO:
+            way = fifoPointers[index];
+            (fifoPointers[index] += 1) &= (associativity - 1);
+            break;
+        case ReplaceType::LRU:
+            way = lruPointers[index].front();
+            break;
+        case ReplaceType::RANDOM:
+            way = engine() % associativity;
+            break;
+        }
+        access = cacheSets[index][way].valid && cacheSets[index][way].dirty
+                     ? CacheAccess::WRITEBACK
+                     : CacheAccess::MISS;
+        unsigned base = (physAddr & ~(blockSize - 1u)) - 0x80400000u;
+        for (unsigned offset = 0; offset < blockSize; offset += 4) {
+            *((unsigned *) (cacheSets[index][way].data + offset)) =
+                memory.functionalRead((base + offset) >> 2u);
+        }
+        cacheSets[index][way].valid = true;
+        cacheSets[index][way].dirty = false;
+        cacheSets[index][way].tag = tag;
+    }
+
+    if (replaceType == ReplaceType::LRU) {
+        auto it = lruPointers[index].begin();
+        while (*it != way) it++;
+        while (true) {
+            auto it1 = it;
+            it1++;
+            if (it1 == lruPointers[index].end()) break;
+            *it = *it1;
+            it++;
+        }
+        lruPointers[index].back() = way;
+    }
+    if (write && !writeThrough) cacheSets[index][way].dirty = true;
+    return access;
+}
+
 /**
  * @brief 写 Cache
  * 
@@ -285,7 +378,7 @@ bool Cache::write(unsigned int physAddr,
     unsigned index = (physAddr >> log2(blockSize)) & (setNum - 1u);
     unsigned tag = (physAddr >> log2(blockSize)) >> log2(setNum);
 
-    Logger::Info(
+    Logger::Info<LogCategory::CACHE>(
         "205: Address: 0x%08x, tag: 0x%08x, index: %d, offset: %d, data: %d\n",
         physAddr,
         tag,
@@ -294,9 +387,10 @@ bool Cache::write(unsigned int physAddr,
         data);
 
     for (unsigned i = 0; i < associativity; i++) {
-        Logger::Info("Checking index = %d", i);
+        Logger::Info<LogCategory::CACHE>("Checking index = %d", i);
         if (cacheSets[index][i].valid && cacheSets[index][i].tag == tag) {
-            Logger::Info("Cache hit, index = %d", i);
+            Logger::Info<LogCategory::CACHE>("Cache hit, index = %d", i);
+            recordEvent(TraceEvent::CACHE_HIT, physAddr, i, 1);
             if (replaceType == ReplaceType::LRU) {
                 auto it = lruPointers[index].begin();
                 while (*it != i) it++;
@@ -317,7 +411,7 @@ bool Cache::write(unsigned int physAddr,
             }
 
             if (writeThrough) {
-                Logger::Info("Writing through");
+                Logger::Info<LogCategory::CACHE>("Writing through");
                 if (memory.write(
                         (physAddr - 0x80400000u) >> 2u, data, byteEnable)) {
                     occupied = false;
@@ -343,21 +437,32 @@ bool Cache::write(unsigned int physAddr,
             replaceID = lruPointers[index].front();
             break;
         case ReplaceType::RANDOM:
-            replaceID = rand() % associativity;
+            replaceID = engine() % associativity;
             break;
         }
+        recordEvent(TraceEvent::CACHE_MISS, physAddr, replaceID, 1);
     }
 
-    Logger::Info("ReplaceID = %d, saveOffset = %d", replaceID, saveOffset);
+    Logger::Info<LogCategory::CACHE>(
+        "ReplaceID = %d, saveOffset = %d", replaceID, saveOffset);
 
     if (cacheSets[index][replaceID].valid &&
         cacheSets[index][replaceID].dirty) {
-        if (saveOffset == -1u) saveOffset = 0;
+        if (saveOffset == -1u) {
+            saveOffset = 0;
+            recordEvent(
+                TraceEvent::CACHE_EVICT,
+                ((cacheSets[index][replaceID].tag << log2(setNum)) | index)
+                    << log2(blockSize),
+                1,
+                1);
+        }
         unsigned reconstructedAddr =
             (((cacheSets[index][replaceID].tag << log2(setNum)) | index)
              << log2(blockSize)) +
             saveOffset - 0x80400000u;
-        Logger::Info("reconstructAddr = 0x%08x", reconstructedAddr);
+        Logger::Info<LogCategory::CACHE>(
+            "reconstructAddr = 0x%08x", reconstructedAddr);
         bool finished = memory.write(
             reconstructedAddr >> 2u,
             *((unsigned *) (cacheSets[index][replaceID].data + saveOffset)),
@@ -372,19 +477,27 @@ bool Cache::write(unsigned int physAddr,
         return false;
     }
 
-    Logger::Info("ReplaceID = %d, saveOffset = %d", replaceID, saveOffset);
+    Logger::Info<LogCategory::CACHE>(
+        "ReplaceID = %d, saveOffset = %d", replaceID, saveOffset);
 
     if (saveOffset == -1u) {
+        if (cacheSets[index][replaceID].valid)
+            recordEvent(
+                TraceEvent::CACHE_EVICT,
+                ((cacheSets[index][replaceID].tag << log2(setNum)) | index)
+                    << log2(blockSize),
+                0,
+                1);
         cacheSets[index][replaceID].valid = false;
         saveOffset = 0u;
     }
     if (saveOffset != blockSize) {
         unsigned replaceAddr =
             (physAddr & (~(blockSize - 1u))) + saveOffset - 0x80400000u;
-        Logger::Info("replaceAddr = 0x%08x", replaceAddr);
+        Logger::Info<LogCategory::CACHE>("replaceAddr = 0x%08x", replaceAddr);
         auto result = memory.read(replaceAddr >> 2u);
         if (result.has_value()) {
-            Logger::Info("Finish replacing");
+            Logger::Info<LogCategory::CACHE>("Finish replacing");
             auto *tmp =
                 (unsigned *) (cacheSets[index][replaceID].data + saveOffset);
             *tmp = result.value();
@@ -415,7 +528,7 @@ bool Cache::write(unsigned int physAddr,
     }
 
     if (writeThrough) {
-        Logger::Info("Wait for possible write through.");
+        Logger::Info<LogCategory::CACHE>("Wait for possible write through.");
         if (memory.write((physAddr - 0x80400000u) >> 2u, data, byteEnable)) {
             cacheSets[index][replaceID].tag = tag;
             replaceID = -1u;
@@ -444,3 +557,74 @@ void Cache::resetState() {
     replaceID = -1u;
     saveOffset = -1u;
 }
+
+/**
+ * @brief 保存每个 Cache 块以及替换指针与当前请求的状态
+ * 几何参数与替换策略只用于恢复时检查配置是否一致，
+ * RANDOM 替换的随机数发生器状态以文本形式保存
+ *
+ * @param out 检查点
+ */
+void Cache::save(CheckpointWriter &out) const {
+    out.writeTag("CACH");
+    out.write(size);
+    out.write(blockSize);
+    out.write(associativity);
+    out.write(writeThrough);
+    out.write(replaceType);
+
+    for (const auto &set : cacheSets) {
+        for (const auto &block : set.set) {
+            out.write(block.valid);
+            if (!block.valid) continue;
+            out.write(block.tag);
+            out.write(block.dirty);
+            out.writeBytes(block.data, block.size);
+        }
+    }
+    for (unsigned x : fifoPointers) out.write(x);
+    for (const auto &pointers : lruPointers)
+        for (unsigned x : pointers) out.write(x);
+
+    out.write(replaceID);
+    out.write(saveOffset);
+    out.write(occupied);
+    out.write(occupyAddress);
+    out.write(occupyWriteFlag);
+    std::stringstream ss;
+    ss << engine;
+    out.write(ss.str());
+}
+
+void Cache::restore(CheckpointReader &in) {
+    in.expectTag("CACH");
+    in.expect(size, "cache size");
+    in.expect(blockSize, "cache block size");
+    in.expect(associativity, "cache associativity");
+    in.expect(writeThrough, "cache write policy");
+    in.expect(replaceType, "cache replace policy");
+
+    for (auto &set : cacheSets) {
+        for (auto &block : set.set) {
+            in.read(block.valid);
+            block.dirty = false;
+            if (!block.valid) continue;
+            in.read(block.tag);
+            in.read(block.dirty);
+            in.readBytes(block.data, block.size);
+        }
+    }
+    for (unsigned &x : fifoPointers) in.read(x);
+    for (auto &pointers : lruPointers)
+        for (unsigned &x : pointers) in.read(x);
+
+    in.read(replaceID);
+    in.read(saveOffset);
+    in.read(occupied);
+    in.read(occupyAddress);
+    in.read(occupyWriteFlag);
+    std::string state;
+    in.read(state);
+    std::stringstream ss(state);
+    ss >> engine;
+}
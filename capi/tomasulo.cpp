@@ -0,0 +1,294 @@
+#include "tomasulo.h"
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "logger.h"
+#include "machine_config.h"
+#include "program_image.h"
+#include "runner.h"
+#include "with_cache.h"
+
+struct tomasulo_image {
+    ProgramImagePtr image;
+};
+
+struct tomasulo_processor {
+    std::unique_ptr<ProcessorAbstract> core;
+    // 带 Cache 时指向 core，用于读取 Cache 统计
+    ProcessorWithCache *withCache = nullptr;
+    bool loaded = false;
+    bool exited = false;
+    unsigned long cycles = 0;
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+int fail(int status, const std::string &reason) {
+    lastError = reason;
+    return status;
+}
+
+/**
+ * @brief 检查一段数据内存地址是否合法
+ *
+ * @param address 起始地址
+ * @param count 字数
+ * @return true 按 4 字节对齐且整段位于数据内存中
+ */
+bool validRange(uint32_t address, size_t count) {
+    return address % 4 == 0 && address >= 0x80400000u &&
+           (address - 0x80400000u) / 4 + count <= DATA_MEM_SIZE / 4;
+}
+
+/**
+ * @brief 捕获 C++ 异常并转换为错误码，异常不能跨越 C 接口
+ *
+ * @param body 实际的操作
+ * @return int body 的返回值，抛出异常时为 TOMASULO_ERROR_INTERNAL
+ */
+template <typename Body>
+int guarded(Body body) {
+    try {
+        lastError.clear();
+        return body();
+    } catch (const std::exception &e) {
+        return fail(TOMASULO_ERROR_INTERNAL, e.what());
+    }
+}
+
+/**
+ * @brief 由机器描述创建处理器，两种创建方式共用
+ *
+ * @param config 检查过的机器描述
+ * @return tomasulo_processor* 实例化失败时为 NULL
+ */
+tomasulo_processor *createProcessor(const MachineConfig &config) {
+    auto p = std::make_unique<tomasulo_processor>();
+    int status = guarded([&] {
+        p->core = makeProcessor(config);
+        if (config.type == ProcessorType::cache)
+            p->withCache = static_cast<ProcessorWithCache *>(p->core.get());
+        return TOMASULO_OK;
+    });
+    return status == TOMASULO_OK ? p.release() : nullptr;
+}
+
+}  // namespace
+
+int tomasulo_api_version(void) { return TOMASULO_API_VERSION; }
+
+const char *tomasulo_last_error(void) { return lastError.c_str(); }
+
+void tomasulo_set_warnings(int enabled) { Logger::setWarnOutput(enabled); }
+
+tomasulo_image *tomasulo_image_load(const char *path) {
+    if (path == nullptr) {
+        fail(TOMASULO_ERROR_ARGUMENT, "Path is null");
+        return nullptr;
+    }
+    tomasulo_image *result = nullptr;
+    guarded([&] {
+        result = new tomasulo_image{readProgramImage(path)};
+        return TOMASULO_OK;
+    });
+    return result;
+}
+
+void tomasulo_image_free(tomasulo_image *image) { delete image; }
+
+uint32_t tomasulo_image_entry(const tomasulo_image *image) {
+    return image == nullptr ? 0 : image->image->entry;
+}
+
+void tomasulo_default_config(struct tomasulo_config *config) {
+    if (config == nullptr) return;
+    MachineConfig machine;
+    *config = tomasulo_config{};
+    config->type = TOMASULO_NORMAL;
+    config->latency = machine.latency;
+    config->cache_size = machine.cacheSize;
+    config->block_size = machine.blockSize;
+    config->associativity = machine.associativity;
+    config->write_through = machine.writeThrough;
+    config->replace_type = static_cast<int>(machine.replaceType);
+    config->seed = machine.seed;
+}
+
+/**
+ * @brief 按配置创建处理器，处理器在装载程序之前不能运行
+ * 配置转换为机器描述后与配置文件使用相同的检查与构造方式，
+ * 其余结构参数取默认值
+ *
+ * @param config 配置
+ * @return tomasulo_processor* 配置无效时为 NULL
+ */
+tomasulo_processor *tomasulo_create(const struct tomasulo_config *config) {
+    if (config == nullptr) {
+        fail(TOMASULO_ERROR_ARGUMENT, "Config is null");
+        return nullptr;
+    }
+    MachineConfig machine;
+    switch (config->type) {
+    case TOMASULO_NORMAL:
+        machine.type = ProcessorType::normal;
+        break;
+    case TOMASULO_PREDICT:
+        machine.type = ProcessorType::predict;
+        break;
+    case TOMASULO_CACHE:
+        machine.type = ProcessorType::cache;
+        break;
+    default:
+        fail(TOMASULO_ERROR_ARGUMENT, "Unknown processor type");
+        return nullptr;
+    }
+    machine.latency = config->latency;
+    machine.seed = config->seed;
+    // 其他处理器不使用 Cache 的配置项，保留默认值使检查总能通过
+    if (machine.type == ProcessorType::cache) {
+        if (config->replace_type < TOMASULO_FIFO ||
+            config->replace_type > TOMASULO_RANDOM) {
+            fail(TOMASULO_ERROR_ARGUMENT, "Unknown cache replace type");
+            return nullptr;
+        }
+        machine.cacheSize = config->cache_size;
+        machine.blockSize = config->block_size;
+        machine.associativity = config->associativity;
+        machine.writeThrough = config->write_through != 0;
+        machine.replaceType = static_cast<ReplaceType>(config->replace_type);
+    }
+    if (auto reason = machine.invalidReason()) {
+        fail(TOMASULO_ERROR_ARGUMENT,
+             std::string("Invalid machine configuration: ") + reason);
+        return nullptr;
+    }
+    return createProcessor(machine);
+}
+
+/**
+ * @brief 按机器配置文件创建处理器
+ *
+ * @param path 配置文件路径
+ * @return tomasulo_processor* 文件无法读取或配置无效时为 NULL
+ */
+tomasulo_processor *tomasulo_create_from_file(const char *path) {
+    if (path == nullptr) {
+        fail(TOMASULO_ERROR_ARGUMENT, "Path is null");
+        return nullptr;
+    }
+    MachineConfig config;
+    int status = guarded([&] {
+        config = readMachineConfig(path);
+        return TOMASULO_OK;
+    });
+    return status == TOMASULO_OK ? createProcessor(config) : nullptr;
+}
+
+void tomasulo_destroy(tomasulo_processor *p) { delete p; }
+
+int tomasulo_load(tomasulo_processor *p, const tomasulo_image *image) {
+    if (p == nullptr || image == nullptr)
+        return fail(TOMASULO_ERROR_ARGUMENT, "Processor or image is null");
+    return guarded([&] {
+        p->core->loadImage(image->image);
+        p->loaded = true;
+        p->exited = false;
+        p->cycles = 0;
+        return TOMASULO_OK;
+    });
+}
+
+int tomasulo_read_registers(const tomasulo_processor *p,
+                            unsigned first,
+                            uint32_t *values,
+                            unsigned count) {
+    if (p == nullptr || values == nullptr || first > 32 || count > 32 - first)
+        return fail(TOMASULO_ERROR_ARGUMENT, "Invalid register range");
+    for (unsigned i = 0; i < count; i++)
+        values[i] = p->core->readReg(first + i);
+    return TOMASULO_OK;
+}
+
+int tomasulo_write_registers(tomasulo_processor *p,
+                             unsigned first,
+                             const uint32_t *values,
+                             unsigned count) {
+    if (p == nullptr || values == nullptr || first > 32 || count > 32 - first)
+        return fail(TOMASULO_ERROR_ARGUMENT, "Invalid register range");
+    for (unsigned i = 0; i < count; i++)
+        if (first + i != 0) p->core->writeReg(first + i, values[i]);
+    return TOMASULO_OK;
+}
+
+int tomasulo_read_memory(const tomasulo_processor *p,
+                         uint32_t address,
+                         uint32_t *words,
+                         size_t count) {
+    if (p == nullptr || words == nullptr || !validRange(address, count))
+        return fail(TOMASULO_ERROR_ARGUMENT, "Invalid memory range");
+    for (size_t i = 0; i < count; i++)
+        words[i] = p->core->readMem(address + i * 4);
+    return TOMASULO_OK;
+}
+
+int tomasulo_write_memory(tomasulo_processor *p,
+                          uint32_t address,
+                          const uint32_t *words,
+                          size_t count) {
+    if (p == nullptr || words == nullptr || !validRange(address, count))
+        return fail(TOMASULO_ERROR_ARGUMENT, "Invalid memory range");
+    return guarded([&] {
+        for (size_t i = 0; i < count; i++)
+            p->core->writeMem(address + i * 4, words[i]);
+        return TOMASULO_OK;
+    });
+}
+
+/**
+ * @brief 按周期预算运行，跳过空闲周期时不会超出预算
+ * 可以多次调用，每次从上一次停下的周期继续
+ *
+ * @param p 处理器
+ * @param cycles 周期预算，0 表示运行到程序结束
+ * @param ran 本次实际运行的周期数，可以为 NULL
+ * @return int TOMASULO_RUNNING 或 TOMASULO_EXITED
+ */
+int tomasulo_run(tomasulo_processor *p, uint64_t cycles, uint64_t *ran) {
+    if (ran != nullptr) *ran = 0;
+    if (p == nullptr) return fail(TOMASULO_ERROR_ARGUMENT, "Processor is null");
+    if (!p->loaded)
+        return fail(TOMASULO_ERROR_NO_PROGRAM, "No program is loaded");
+    if (p->exited) return TOMASULO_EXITED;
+
+    // 与 runner 的各个入口使用同一个执行循环，0 表示不限制周期数
+    std::function<unsigned long()> limit;
+    if (cycles != 0) limit = [cycles] { return (unsigned long) cycles; };
+    unsigned long counter = 0;
+    int status = guarded([&] {
+        counter = runUntil(p->core.get(), 0, p->exited, limit);
+        return p->exited ? TOMASULO_EXITED : TOMASULO_RUNNING;
+    });
+    p->cycles += counter;
+    if (ran != nullptr) *ran = counter;
+    return status;
+}
+
+int tomasulo_get_stats(const tomasulo_processor *p,
+                       struct tomasulo_stats *stats) {
+    if (p == nullptr || stats == nullptr)
+        return fail(TOMASULO_ERROR_ARGUMENT, "Processor or stats is null");
+    *stats = tomasulo_stats{};
+    stats->cycles = p->cycles;
+    stats->instructions = p->core->getCommittedInstructions();
+    if (p->withCache != nullptr) {
+        stats->memory_accesses = p->withCache->getTotalMemoryTime();
+        stats->cache_hits = p->withCache->getTotalCacheHitTime();
+    }
+    stats->exited = p->exited;
+    return TOMASULO_OK;
+}
@@ -0,0 +1,336 @@
+#include "batch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include "interval.h"
+#include "logger.h"
+#include "work_pool.h"
+
+namespace {
+
+const char *const timingModelNames[] = {"detailed", "interval"};
+
+// 清单中沿用的键名与机器描述中的键名
+const char *const machineKeys[][2] = {{"type", "core.type"},
+                                      {"cache-size", "cache.size"},
+                                      {"block-size", "cache.block_size"},
+                                      {"associativity", "cache.associativity"},
+                                      {"write-through", "cache.write_through"},
+                                      {"replace-type", "cache.replace"},
+                                      {"latency", "memory.latency"},
+                                      {"seed", "memory.seed"}};
+
+[[noreturn]] void invalidManifest(unsigned line, const std::string &reason) {
+    Logger::Error("Batch manifest line %u: %s", line, reason.c_str());
+    throw std::invalid_argument("Invalid batch manifest");
+}
+
+unsigned long parseNumber(const std::string &key,
+                          const std::string &value,
+                          unsigned line) {
+    size_t used = 0;
+    unsigned long result = 0;
+    try {
+        result = std::stoul(value, &used, 0);
+    } catch (const std::exception &) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size())
+        invalidManifest(line, "bad value " + value + " for " + key);
+    return result;
+}
+
+template <typename T, size_t N>
+T parseName(const char *const (&names)[N],
+            const std::string &key,
+            const std::string &value,
+            unsigned line) {
+    for (size_t i = 0; i < N; i++)
+        if (value == names[i]) return static_cast<T>(i);
+    invalidManifest(line, "bad value " + value + " for " + key);
+}
+
+/**
+ * @brief 解析清单中的一个 key=value
+ *
+ * @param job 当前行的任务
+ * @param key
+ * @param value
+ * @param line 行号，用于报错
+ */
+void parseOption(BatchJob &job,
+                 const std::string &key,
+                 const std::string &value,
+                 unsigned line) {
+    if (key == "model") {
+        job.model = parseName<TimingModel>(timingModelNames, key, value, line);
+    } else if (key == "args") {
+        job.args.clear();
+        std::stringstream ss(value);
+        std::string x;
+        while (std::getline(ss, x, ','))
+            job.args.push_back((int) parseNumber(key, x, line));
+    } else if (key == "config") {
+        try {
+            job.machine = readMachineConfig(value);
+        } catch (const std::exception &) {
+            invalidManifest(line, "cannot load machine configuration " + value);
+        }
+    } else {
+        auto machineKey = key;
+        for (const auto &x : machineKeys)
+            if (key == x[0]) machineKey = x[1];
+        try {
+            job.machine.set(machineKey, value);
+        } catch (const std::invalid_argument &) {
+            invalidManifest(line, "bad option " + key + "=" + value);
+        }
+    }
+}
+
+std::string csvField(const std::string &x) {
+    if (x.find_first_of(",\"\n") == std::string::npos) return x;
+    std::string result = "\"";
+    for (char c : x) {
+        if (c == '"') result += '"';
+        result += c;
+    }
+    return result + "\"";
+}
+
+std::string jsonString(const std::string &x) {
+    std::string result = "\"";
+    for (char c : x) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if ((unsigned char) c < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            result += buffer;
+        } else {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+}  // namespace
+
+/**
+ * @brief 读取批量运行的任务清单
+ * 每行一个任务：elf 路径之后是任意个 key=value，# 之后为注释。
+ * key 为 type（normal、predict、cache）、model（detailed、interval）、
+ * args（逗号分隔）、cache-size、
+ * block-size、associativity、write-through（0 或 1）、
+ * replace-type（FIFO、LRU、RANDOM）、latency 与 seed；
+ * config 以一个机器配置文件替换该任务之前的全部机器参数，
+ * 形如 core.rob_size 的 key 直接设置机器配置中的对应项
+ *
+ * @param in 清单
+ * @param base 每个任务初始的机器描述
+ * @return std::vector<BatchJob>
+ */
+std::vector<BatchJob> readBatchManifest(std::istream &in,
+                                        const MachineConfig &base) {
+    std::vector<BatchJob> jobs;
+    std::string text;
+    for (unsigned line = 1; std::getline(in, text); line++) {
+        text = text.substr(0, text.find('#'));
+        std::stringstream ss(text);
+        BatchJob job;
+        job.machine = base;
+        if (!(ss >> job.elf)) continue;
+        std::string option;
+        while (ss >> option) {
+            auto split = option.find('=');
+            if (split == std::string::npos)
+                invalidManifest(line, "expected key=value, got " + option);
+            parseOption(
+                job, option.substr(0, split), option.substr(split + 1), line);
+        }
+        try {
+            job.machine.validate();
+        } catch (const std::invalid_argument &) {
+            invalidManifest(line, "machine cannot be instantiated");
+        }
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+namespace {
+
+/**
+ * @brief 在新建的处理器上逐周期执行一个任务
+ *
+ * @param job 任务
+ * @param result 填入周期数与提交的指令条数
+ */
+void runDetailedJob(const BatchJob &job, BatchResult &result) {
+    auto p = makeProcessor(job.machine);
+    if (job.machine.type == ProcessorType::cache) {
+        result.cycles =
+            executeWithCache(static_cast<ProcessorWithCache *>(p.get()),
+                             result.memoryAccesses,
+                             result.cacheHits,
+                             job.elf,
+                             job.args);
+    } else {
+        result.cycles = execute(p.get(), job.elf, job.args);
+    }
+    result.instructions = p->getCommittedInstructions();
+}
+
+/**
+ * @brief 用区间模型估计一个任务的周期数
+ *
+ * @param job 任务
+ * @param result 填入估计的周期数与事件数
+ */
+void runIntervalJob(const BatchJob &job, BatchResult &result) {
+    IntervalConfig config;
+    config.machine = job.machine;
+
+    RegisterFile regFile;
+    Memory memory(0);
+    auto stats = executeInterval(job.elf, config, regFile, memory, job.args);
+    result.cycles = stats.cycles;
+    result.instructions = stats.instructions;
+    if (job.machine.type == ProcessorType::cache) {
+        result.memoryAccesses = stats.memoryAccesses;
+        result.cacheHits = stats.cacheHits;
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief 在新建的处理器上执行一个任务，异常记录在结果中而不向外抛出
+ *
+ * @param job 任务
+ * @return BatchResult
+ */
+BatchResult runBatchJob(const BatchJob &job) {
+    BatchResult result;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        if (job.model == TimingModel::interval) {
+            runIntervalJob(job, result);
+        } else {
+            runDetailedJob(job, result);
+        }
+    } catch (const std::exception &e) {
+        result.error = e.what();
+    }
+    result.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    return result;
+}
+
+/**
+ * @brief 在线程池上执行全部任务，每个任务使用独立的处理器
+ * 同一 elf 的程序映像只读取一次，由所有任务共享
+ *
+ * @param jobs 任务
+ * @param threads 线程数，0 表示全部硬件线程
+ * @param done 任务完成时的回调，可以为空
+ * @return std::vector<BatchResult>
+ */
+std::vector<BatchResult> runBatch(
+    const std::vector<BatchJob> &jobs,
+    unsigned threads,
+    const std::function<void(const BatchResult &)> &done) {
+    std::vector<BatchResult> results(jobs.size());
+    std::mutex mutex;
+    parallelFor(jobs.size(), threads, [&](unsigned long i) {
+        auto result = runBatchJob(jobs[i]);
+        result.job = i;
+        if (!result.error.empty())
+            Logger::Error("Job %lu (%s) failed: %s",
+                          i,
+                          jobs[i].elf.c_str(),
+                          result.error.c_str());
+        std::lock_guard<std::mutex> lock(mutex);
+        results[i] = result;
+        if (done) done(results[i]);
+    });
+    return results;
+}
+
+void writeBatchHeader(std::ostream &out, BatchFormat format) {
+    if (format != BatchFormat::CSV) return;
+    out << "job,elf,type,model,args,cache_size,block_size,associativity,"
+           "write_through,replace_type,latency,seed,rob_size,rs_size,"
+           "btb_size,fu_latency,cycles,instructions,memory_accesses,"
+           "cache_hits,seconds,error\n";
+}
+
+/**
+ * @brief 输出一个任务的配置与结果，CSV 为一行，JSON 为一行一个对象
+ * 机器描述的全部结构参数都写入结果，可据此重现该任务
+ *
+ * @param out
+ * @param format
+ * @param job
+ * @param result
+ */
+void writeBatchResult(std::ostream &out,
+                      BatchFormat format,
+                      const BatchJob &job,
+                      const BatchResult &result) {
+    const auto &machine = job.machine;
+    const char *separator = format == BatchFormat::CSV ? " " : ",";
+    std::string args, fuLatency;
+    for (size_t i = 0; i < job.args.size(); i++)
+        args += (i == 0 ? "" : separator) + std::to_string(job.args[i]);
+    for (size_t i = 0; i < machine.fuLatency.size(); i++)
+        fuLatency +=
+            (i == 0 ? "" : separator) + std::to_string(machine.fuLatency[i]);
+    const char *type = getProcessorTypeName(machine.type);
+    const char *model = timingModelNames[static_cast<int>(job.model)];
+    const char *replace = getReplaceTypeName(machine.replaceType);
+    char seconds[32];
+    snprintf(seconds, sizeof(seconds), "%.6f", result.seconds);
+
+    if (format == BatchFormat::CSV) {
+        out << result.job << ',' << csvField(job.elf) << ',' << type << ','
+            << model << ',' << args << ',' << machine.cacheSize << ','
+            << machine.blockSize << ',' << machine.associativity << ','
+            << machine.writeThrough << ',' << replace << ','
+            << machine.latency << ',' << machine.seed << ','
+            << machine.robSize << ',' << machine.rsSize << ','
+            << machine.btbSize << ',' << fuLatency << ',' << result.cycles
+            << ',' << result.instructions << ',' << result.memoryAccesses
+            << ',' << result.cacheHits << ',' << seconds << ','
+            << csvField(result.error) << '\n';
+    } else {
+        out << "{\"job\":" << result.job << ",\"elf\":" << jsonString(job.elf)
+            << ",\"type\":\"" << type << "\",\"model\":\"" << model
+            << "\",\"args\":[" << args
+            << "],\"cache_size\":" << machine.cacheSize
+            << ",\"block_size\":" << machine.blockSize
+            << ",\"associativity\":" << machine.associativity
+            << ",\"write_through\":"
+            << (machine.writeThrough ? "true" : "false")
+            << ",\"replace_type\":\"" << replace
+            << "\",\"latency\":" << machine.latency
+            << ",\"seed\":" << machine.seed
+            << ",\"rob_size\":" << machine.robSize
+            << ",\"rs_size\":" << machine.rsSize
+            << ",\"btb_size\":" << machine.btbSize << ",\"fu_latency\":["
+            << fuLatency << "],\"cycles\":" << result.cycles
+            << ",\"instructions\":" << result.instructions
+            << ",\"memory_accesses\":" << result.memoryAccesses
+            << ",\"cache_hits\":" << result.cacheHits
+            << ",\"seconds\":" << seconds << ",\"error\":"
+            << (result.error.empty() ? "null" : jsonString(result.error))
+            << "}\n";
+    }
+    out.flush();
+}
@@ -0,0 +1,193 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "logger.h"
+
+namespace {
+
+unsigned long fnv1a(const std::vector<unsigned char> &data) {
+    unsigned long hash = 0xcbf29ce484222325ul;
+    for (unsigned char x : data) {
+        hash ^= x;
+        hash *= 0x100000001b3ul;
+    }
+    return hash;
+}
+
+}  // namespace
+
+/**
+ * @brief 写入指令，只保存编码、pc 与预测结果，译码结果在恢复时重新计算
+ *
+ * @param x 指令
+ */
+void CheckpointWriter::write(const Instruction &x) {
+    write(x.instruction);
+    write(x.pc);
+    write(x.predictBundle.predictJump);
+    write(x.predictBundle.predictTarget);
+}
+
+void CheckpointWriter::write(const std::optional<Instruction> &x) {
+    write(x.has_value());
+    if (x.has_value()) write(x.value());
+}
+
+void CheckpointWriter::write(const IssueSlot &x) {
+    write(x.busy);
+    if (!x.busy) return;
+    write(x.inst);
+    for (const auto &port : {x.readPort1, x.readPort2}) {
+        write(port.waitForWakeup);
+        write(port.robIdx);
+        write(port.value);
+    }
+    write(x.robIdx);
+}
+
+void CheckpointWriter::write(const std::string &x) {
+    write((unsigned) x.size());
+    writeBytes(x.data(), x.size());
+}
+
+void CheckpointWriter::writeBytes(const void *source, size_t length) {
+    auto bytes = static_cast<const unsigned char *>(source);
+    buffer.insert(buffer.end(), bytes, bytes + length);
+}
+
+void CheckpointWriter::writeTag(const char *tag) { writeBytes(tag, 4); }
+
+/**
+ * @brief 把已写入的状态连同文件头保存到文件
+ *
+ * @param file 检查点路径
+ */
+void CheckpointWriter::saveFile(const std::string &file) const {
+    CheckpointHeader header{};
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.payloadSize = buffer.size();
+    header.checksum = fnv1a(buffer);
+
+    FILE *out = fopen(file.c_str(), "wb");
+    if (out == nullptr) {
+        Logger::Error("Cannot open checkpoint file %s", file.c_str());
+        throw std::runtime_error("Cannot open checkpoint file");
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size();
+    if (fclose(out) != 0 || !ok) {
+        Logger::Error("Failed to write checkpoint file %s", file.c_str());
+        throw std::runtime_error("Failed to write checkpoint file");
+    }
+}
+
+/**
+ * @brief 读入整个检查点文件并校验文件头
+ *
+ * @param file 检查点路径
+ */
+CheckpointReader::CheckpointReader(const std::string &file) {
+    FILE *in = fopen(file.c_str(), "rb");
+    if (in == nullptr) {
+        Logger::Error("Cannot open checkpoint file %s", file.c_str());
+        throw std::runtime_error("Cannot open checkpoint file");
+    }
+
+    CheckpointHeader header{};
+    bool ok = fread(&header, sizeof(header), 1, in) == 1 &&
+              memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) ==
+                  0;
+    if (ok && header.version != CHECKPOINT_VERSION) {
+        fclose(in);
+        Logger::Error("Checkpoint %s has version %u, expected %u",
+                      file.c_str(),
+                      header.version,
+                      CHECKPOINT_VERSION);
+        throw std::runtime_error("Unsupported checkpoint version");
+    }
+    if (ok) {
+        buffer.resize(header.payloadSize);
+        ok = fread(buffer.data(), 1, buffer.size(), in) == buffer.size() &&
+             fnv1a(buffer) == header.checksum;
+    }
+    fclose(in);
+    if (!ok) {
+        Logger::Error("%s is not a valid checkpoint file", file.c_str());
+        throw std::runtime_error("Invalid checkpoint file");
+    }
+}
+
+void CheckpointReader::read(Instruction &x) {
+    unsigned instruction, pc;
+    read(instruction);
+    read(pc);
+    x = Instruction::predecode(instruction);
+    x.pc = pc;
+    read(x.predictBundle.predictJump);
+    read(x.predictBundle.predictTarget);
+}
+
+void CheckpointReader::read(std::optional<Instruction> &x) {
+    bool valid;
+    read(valid);
+    if (!valid) {
+        x = std::nullopt;
+        return;
+    }
+    x.emplace();
+    read(x.value());
+}
+
+void CheckpointReader::read(IssueSlot &x) {
+    x = IssueSlot{};
+    read(x.busy);
+    if (!x.busy) return;
+    read(x.inst);
+    for (auto port : {&x.readPort1, &x.readPort2}) {
+        read(port->waitForWakeup);
+        read(port->robIdx);
+        read(port->value);
+    }
+    read(x.robIdx);
+}
+
+void CheckpointReader::read(std::string &x) {
+    unsigned length;
+    read(length);
+    x.resize(length);
+    readBytes(x.data(), length);
+}
+
+void CheckpointReader::readBytes(void *target, size_t length) {
+    if (buffer.size() - offset < length) {
+        Logger::Error("Checkpoint ends unexpectedly at offset %lu", offset);
+        throw std::runtime_error("Truncated checkpoint");
+    }
+    memcpy(target, buffer.data() + offset, length);
+    offset += length;
+}
+
+/**
+ * @brief 读取部件标签，与期望不符说明检查点来自不同类型的处理器
+ *
+ * @param tag 四字节标签
+ */
+void CheckpointReader::expectTag(const char *tag) {
+    char saved[4];
+    readBytes(saved, sizeof(saved));
+    if (memcmp(saved, tag, sizeof(saved)) != 0) {
+        Logger::Error("Checkpoint section %.4s found where %.4s is expected",
+                      saved,
+                      tag);
+        throw std::runtime_error("Checkpoint does not match processor");
+    }
+}
+
+void CheckpointReader::mismatch(const char *name) const {
+    Logger::Error("Checkpoint was saved with a different %s", name);
+    throw std::runtime_error("Checkpoint does not match processor");
+}
@@ -0,0 +1,697 @@
+#include "dse.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+#include "logger.h"
+#include "runner.h"
+#include "work_pool.h"
+
+namespace {
+
+const char *const statusNames[] = {"done", "pruned", "failed"};
+
+// 未给出空间文件时探索的参数
+const char *const defaultParameters[][2] = {
+    {"cache.size", "1024 2048 4096 8192 16384"},
+    {"cache.block_size", "8 16 32"},
+    {"cache.associativity", "1 2 4"},
+    {"cache.replace", "FIFO LRU RANDOM"},
+    {"cache.write_through", "0 1"},
+    {"core.rob_size", "4 8 16 32"},
+    {"core.rs_size", "2 4 8"},
+    {"memory.latency", "5 10 20"}};
+
+// 网格搜索允许的最多点数
+constexpr unsigned long maxGridPoints = 1000000;
+// 随机搜索与爬山法为每个新点最多尝试的采样次数
+constexpr unsigned long sampleAttempts = 100;
+
+// 一个表项保存的位数：ROB 为指令、pc、结果与 4 个状态位；
+// BTB 为 pc、目标地址、2 位计数器与有效位
+constexpr unsigned long robEntryBits = 32 + 32 + 32 + 4;
+constexpr unsigned long btbEntryBits = 32 + 32 + 2 + 1;
+
+unsigned log2Ceil(unsigned long x) {
+    unsigned result = 0;
+    while ((1ul << result) < x) result++;
+    return result;
+}
+
+std::string trim(const std::string &x) {
+    auto begin = x.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    auto end = x.find_last_not_of(" \t\r");
+    return x.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief 结果缓存的键，由完整的机器配置与负载得到的 64 位 FNV-1a 散列
+ * 与 readProgramImage 一样以修改时间和大小识别 elf，重新编译后旧结果失效
+ *
+ * @param machine
+ * @param options 提供 elf 路径与参数
+ * @return unsigned long long
+ */
+unsigned long long hashJob(const MachineConfig &machine,
+                           const DseOptions &options) {
+    auto key = machine.toString() + options.elf;
+    struct stat status {};
+    if (stat(options.elf.c_str(), &status) == 0) {
+        key += ' ' + std::to_string(status.st_mtim.tv_sec) + '.' +
+               std::to_string(status.st_mtim.tv_nsec) + ' ' +
+               std::to_string(status.st_size);
+    }
+    for (int x : options.args) key += ' ' + std::to_string(x);
+    unsigned long long hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// 缓存文件中的一条记录
+struct CachedResult {
+    DseStatus status;
+    unsigned long cycles;
+    unsigned long instructions;
+};
+
+/**
+ * @brief 一次探索的状态：已评估的点、Pareto 前沿与结果缓存
+ * 同一批点在线程池上并行评估，前沿在每个点完成时更新，
+ * 正在运行的点随之收紧周期上限
+ */
+class Explorer {
+    const DseSpace &space;
+    const DseOptions &options;
+    std::mt19937 engine;
+
+    std::mutex mutex;
+    // 已完成的点中互不支配的 (存储, 周期数)
+    std::vector<std::pair<unsigned long, unsigned long>> front;
+    std::unordered_map<unsigned long long, CachedResult> cache;
+    std::ofstream cacheOut;
+    std::vector<DseResult> results;
+    // 点到 results 下标的映射
+    std::map<DsePoint, size_t> visited;
+
+    [[nodiscard]] unsigned long limit(unsigned long storage,
+                                      unsigned long bound) const;
+    void addToFront(unsigned long storage, unsigned long cycles);
+    void readCache();
+    void record(DseResult &result);
+    void run(DseResult &result, unsigned long bound);
+
+public:
+    Explorer(const DseSpace &space, const DseOptions &options);
+
+    [[nodiscard]] bool configure(const DsePoint &point,
+                                 MachineConfig &machine) const;
+    std::optional<DsePoint> sample();
+    std::vector<size_t> evaluate(const std::vector<DsePoint> &points,
+                                 unsigned long bound = ULONG_MAX);
+    [[nodiscard]] std::string describe(const DsePoint &point) const;
+    std::vector<DseResult> finish();
+
+    [[nodiscard]] unsigned long getVisited() const { return visited.size(); }
+    [[nodiscard]] bool isVisited(const DsePoint &point) const {
+        return visited.count(point) != 0;
+    }
+    [[nodiscard]] const DseResult &operator[](size_t i) const {
+        return results[i];
+    }
+};
+
+Explorer::Explorer(const DseSpace &space, const DseOptions &options)
+    : space(space), options(options), engine(options.seed) {
+    if (options.cacheFile.empty()) return;
+    readCache();
+    cacheOut.open(options.cacheFile, std::ios::app);
+    if (!cacheOut) {
+        Logger::Error("Cannot open result cache %s",
+                      options.cacheFile.c_str());
+        throw std::runtime_error("Cannot open result cache");
+    }
+}
+
+/**
+ * @brief 读取结果缓存，忽略被中断的运行留下的不完整行
+ */
+void Explorer::readCache() {
+    std::ifstream in(options.cacheFile);
+    std::string text;
+    for (unsigned line = 1; std::getline(in, text); line++) {
+        std::stringstream ss(text.substr(0, text.find('#')));
+        std::string hash, status;
+        CachedResult x{};
+        if (!(ss >> hash)) continue;
+        if (!(ss >> status >> x.cycles >> x.instructions)) {
+            Logger::Warn("Ignore incomplete line %u of result cache %s",
+                         line,
+                         options.cacheFile.c_str());
+            continue;
+        }
+        if (status == statusNames[static_cast<int>(DseStatus::done)]) {
+            x.status = DseStatus::done;
+        } else if (status ==
+                   statusNames[static_cast<int>(DseStatus::pruned)]) {
+            x.status = DseStatus::pruned;
+        } else {
+            continue;
+        }
+        cache[std::stoull(hash, nullptr, 16)] = x;
+    }
+    Logger::Warn("Loaded %lu cached results from %s",
+                 cache.size(),
+                 options.cacheFile.c_str());
+}
+
+/**
+ * @brief 由空间中的点得到机器配置
+ *
+ * @param point
+ * @param machine 得到的配置
+ * @return true 配置能够实例化且不超过存储限制
+ * @return false 其他情况
+ */
+bool Explorer::configure(const DsePoint &point, MachineConfig &machine) const {
+    machine = space.base;
+    for (size_t i = 0; i < point.size(); i++) {
+        const auto &parameter = space.parameters[i];
+        machine.set(parameter.key, parameter.values[point[i]]);
+    }
+    if (machine.invalidReason() != nullptr) return false;
+    return options.maxStorage == 0 ||
+           estimateStorage(machine) <= options.maxStorage;
+}
+
+/**
+ * @brief 随机选取一个未评估过的有效点
+ *
+ * @return std::optional<DsePoint> 多次尝试都没有找到时为 std::nullopt
+ */
+std::optional<DsePoint> Explorer::sample() {
+    DsePoint point(space.parameters.size());
+    MachineConfig machine;
+    for (unsigned long i = 0; i < sampleAttempts; i++) {
+        for (size_t j = 0; j < point.size(); j++) {
+            std::uniform_int_distribution<unsigned> distribution(
+                0, space.parameters[j].values.size() - 1);
+            point[j] = distribution(engine);
+        }
+        if (visited.count(point) == 0 && configure(point, machine))
+            return point;
+    }
+    return std::nullopt;
+}
+
+std::string Explorer::describe(const DsePoint &point) const {
+    std::string result;
+    for (size_t i = 0; i < point.size(); i++) {
+        const auto &parameter = space.parameters[i];
+        result += (i == 0 ? "" : " ") + parameter.key + "=" +
+                  parameter.values[point[i]];
+    }
+    return result;
+}
+
+/**
+ * @brief 存储为 storage 的点运行到多少周期时可以停止，调用者持有锁
+ * 前沿上存储不多于 storage 的点中周期数最少者为 c 时，周期数达到 c 的运行
+ * 在两个目标上都不优于该点，继续运行不会改变前沿。
+ * 爬山法只关心能否优于当前点，由调用者以 bound 给出，不使用前沿
+ *
+ * @param storage
+ * @param bound 调用者给出的上限
+ * @return unsigned long
+ */
+unsigned long Explorer::limit(unsigned long storage,
+                              unsigned long bound) const {
+    if (!options.prune || options.strategy == SearchStrategy::hillClimb)
+        return bound;
+    for (const auto &x : front)
+        if (x.first <= storage) bound = std::min(bound, x.second);
+    return bound;
+}
+
+/**
+ * @brief 把一个完成的点加入前沿，调用者持有锁
+ *
+ * @param storage
+ * @param cycles
+ */
+void Explorer::addToFront(unsigned long storage, unsigned long cycles) {
+    for (const auto &x : front)
+        if (x.first <= storage && x.second <= cycles) return;
+    front.erase(std::remove_if(front.begin(),
+                               front.end(),
+                               [&](const auto &x) {
+                                   return storage <= x.first &&
+                                          cycles <= x.second;
+                               }),
+                front.end());
+    front.emplace_back(storage, cycles);
+}
+
+/**
+ * @brief 评估一个点：缓存中的结果仍然有效时直接使用，否则在新建的处理器上
+ * 运行到程序结束或被前沿支配
+ *
+ * @param result 已填入点、配置、散列与存储
+ * @param bound 调用者给出的周期上限
+ */
+void Explorer::run(DseResult &result, unsigned long bound) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(result.hash);
+        // 提前停止的记录只是周期数的下界，仍被支配时才能沿用
+        if (it != cache.end() &&
+            (it->second.status == DseStatus::done ||
+             it->second.cycles >= limit(result.storage, bound))) {
+            result.status = it->second.status;
+            result.cycles = it->second.cycles;
+            result.instructions = it->second.instructions;
+            result.cached = true;
+            return;
+        }
+    }
+    try {
+        auto p = makeProcessor(result.machine);
+        bool finished = false;
+        result.cycles = executeWithLimit(
+            p.get(),
+            options.elf,
+            options.args,
+            [&] {
+                std::lock_guard<std::mutex> lock(mutex);
+                return limit(result.storage, bound);
+            },
+            finished);
+        result.instructions = p->getCommittedInstructions();
+        result.status = finished ? DseStatus::done : DseStatus::pruned;
+    } catch (const std::exception &e) {
+        result.status = DseStatus::failed;
+        result.error = e.what();
+    }
+}
+
+/**
+ * @brief 记录一个点的结果，新的结果追加到缓存文件，调用者持有锁
+ * 失败的运行不写入缓存，恢复时重新运行
+ *
+ * @param result
+ */
+void Explorer::record(DseResult &result) {
+    if (result.status == DseStatus::done)
+        addToFront(result.storage, result.cycles);
+    if (!result.cached && result.status != DseStatus::failed) {
+        cache[result.hash] = {
+            result.status, result.cycles, result.instructions};
+        if (cacheOut.is_open()) {
+            char hash[24];
+            snprintf(hash, sizeof(hash), "%016llx", result.hash);
+            cacheOut << hash << ' '
+                     << statusNames[static_cast<int>(result.status)] << ' '
+                     << result.cycles << ' ' << result.instructions << " # "
+                     << describe(result.point) << std::endl;
+        }
+    }
+    if (result.status == DseStatus::failed) {
+        Logger::Error("%s failed: %s",
+                      describe(result.point).c_str(),
+                      result.error.c_str());
+    } else {
+        Logger::Warn("%s: %s%s at %lu cycles, %lu bytes",
+                     describe(result.point).c_str(),
+                     result.cached ? "cached, " : "",
+                     statusNames[static_cast<int>(result.status)],
+                     result.cycles,
+                     result.storage);
+    }
+    visited[result.point] = results.size();
+    results.push_back(result);
+}
+
+/**
+ * @brief 在线程池上评估一批点，已经评估过的点直接返回之前的结果
+ * 存储较少的点先开始，尽早建立前沿以停止之后存储较多的运行
+ *
+ * @param points 有效的点
+ * @param bound 周期上限，爬山法中为当前点的周期数
+ * @return std::vector<size_t> 各点结果的下标，与 points 顺序相同
+ */
+std::vector<size_t> Explorer::evaluate(const std::vector<DsePoint> &points,
+                                       unsigned long bound) {
+    std::vector<DseResult> pending;
+    for (const auto &point : points) {
+        if (visited.count(point) != 0) continue;
+        if (std::any_of(pending.begin(), pending.end(), [&](const auto &x) {
+                return x.point == point;
+            }))
+            continue;
+        DseResult result;
+        result.point = point;
+        static_cast<void>(configure(point, result.machine));
+        result.hash = hashJob(result.machine, options);
+        result.storage = estimateStorage(result.machine);
+        pending.push_back(result);
+    }
+    std::stable_sort(
+        pending.begin(), pending.end(), [](const auto &x, const auto &y) {
+            return x.storage < y.storage;
+        });
+
+    // 缓存中已经完成的点先建立前沿，之后才能判断提前停止的记录是否仍被支配
+    std::vector<DseResult> running;
+    for (auto &x : pending) {
+        auto it = cache.find(x.hash);
+        if (it == cache.end() || it->second.status != DseStatus::done) {
+            running.push_back(x);
+            continue;
+        }
+        run(x, bound);
+        record(x);
+    }
+    parallelFor(running.size(), options.threads, [&](unsigned long i) {
+        run(running[i], bound);
+        std::lock_guard<std::mutex> lock(mutex);
+        record(running[i]);
+    });
+
+    std::vector<size_t> indexes;
+    for (const auto &point : points) indexes.push_back(visited[point]);
+    return indexes;
+}
+
+/**
+ * @brief 标出最终前沿上的点并返回全部结果
+ *
+ * @return std::vector<DseResult>
+ */
+std::vector<DseResult> Explorer::finish() {
+    for (auto &x : results)
+        x.pareto = x.status == DseStatus::done &&
+                   std::find(front.begin(),
+                             front.end(),
+                             std::make_pair(x.storage, x.cycles)) !=
+                       front.end();
+    return std::move(results);
+}
+
+/**
+ * @brief 网格搜索，评估空间中的全部有效点
+ *
+ * @param explorer
+ * @param space
+ */
+void searchGrid(Explorer &explorer, const DseSpace &space) {
+    unsigned long count = 1;
+    for (const auto &x : space.parameters) {
+        count *= x.values.size();
+        if (count > maxGridPoints) {
+            Logger::Error("Design space has more than %lu points, use random "
+                          "or hill-climb search",
+                          maxGridPoints);
+            throw std::invalid_argument("Design space too large");
+        }
+    }
+    std::vector<DsePoint> points;
+    DsePoint point(space.parameters.size());
+    MachineConfig machine;
+    for (unsigned long i = 0; i < count; i++) {
+        unsigned long x = i;
+        for (size_t j = 0; j < point.size(); j++) {
+            point[j] = x % space.parameters[j].values.size();
+            x /= space.parameters[j].values.size();
+        }
+        if (explorer.configure(point, machine)) points.push_back(point);
+    }
+    explorer.evaluate(points);
+}
+
+/**
+ * @brief 随机搜索，评估 samples 个不同的有效点
+ *
+ * @param explorer
+ * @param samples
+ */
+void searchRandom(Explorer &explorer, unsigned long samples) {
+    std::vector<DsePoint> points;
+    std::map<DsePoint, bool> chosen;
+    while (points.size() < samples) {
+        auto point = explorer.sample();
+        if (!point.has_value()) break;
+        if (chosen[point.value()]) continue;
+        chosen[point.value()] = true;
+        points.push_back(point.value());
+    }
+    explorer.evaluate(points);
+}
+
+/**
+ * @brief 带随机重启的最陡下降爬山法，在存储限制内最小化周期数
+ * 每一步并行评估所有只有一维相差一个候选值的邻居，移动到周期数最少的邻居，
+ * 没有更优的邻居时从新的随机点重新开始；邻居运行到当前点的周期数时即可停止
+ *
+ * @param explorer
+ * @param space
+ * @param options
+ */
+void searchHillClimb(Explorer &explorer,
+                     const DseSpace &space,
+                     const DseOptions &options) {
+    MachineConfig machine;
+    while (explorer.getVisited() < options.samples) {
+        auto start = explorer.sample();
+        if (!start.has_value()) break;
+        auto current = explorer.evaluate({start.value()}).front();
+        if (explorer[current].status != DseStatus::done) continue;
+
+        while (explorer.getVisited() < options.samples) {
+            std::vector<DsePoint> neighbours;
+            unsigned long fresh = 0;
+            for (size_t i = 0; i < space.parameters.size(); i++) {
+                for (int delta : {-1, 1}) {
+                    auto point = explorer[current].point;
+                    long x = (long) point[i] + delta;
+                    if (x < 0 || x >= (long) space.parameters[i].values.size())
+                        continue;
+                    point[i] = (unsigned) x;
+                    if (!explorer.configure(point, machine)) continue;
+                    bool seen = explorer.isVisited(point);
+                    if (!seen && explorer.getVisited() + fresh >=
+                                     options.samples)
+                        continue;
+                    fresh += !seen;
+                    neighbours.push_back(point);
+                }
+            }
+            auto bound = options.prune ? explorer[current].cycles : ULONG_MAX;
+            auto next = current;
+            for (auto i : explorer.evaluate(neighbours, bound)) {
+                const auto &x = explorer[i];
+                if (x.status != DseStatus::done) continue;
+                const auto &best = explorer[next];
+                if (std::tie(x.cycles, x.storage) <
+                    std::tie(best.cycles, best.storage))
+                    next = i;
+            }
+            if (next == current) break;
+            current = next;
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief 读取设计空间文件
+ * 格式与机器配置文件相同，但每个键给出以空白分隔的多个候选值，
+ * 只有一个候选值的键相当于修改 base 中的配置
+ *
+ * @param fileName
+ * @param base 未作为维度的配置项
+ * @return DseSpace
+ */
+DseSpace readDseSpace(const std::string &fileName, const MachineConfig &base) {
+    std::ifstream in(fileName);
+    if (!in) {
+        Logger::Error("Cannot open design space %s", fileName.c_str());
+        throw std::runtime_error("Cannot open design space");
+    }
+    DseSpace space{base, {}};
+    std::string section, text;
+    for (unsigned line = 1; std::getline(in, text); line++) {
+        text = trim(text.substr(0, text.find_first_of("#;")));
+        if (text.empty()) continue;
+        if (text.front() == '[' && text.back() == ']') {
+            section = trim(text.substr(1, text.size() - 2));
+            continue;
+        }
+        auto split = text.find('=');
+        if (split == std::string::npos || section.empty()) {
+            Logger::Error("%s line %u: expected key = values in a section",
+                          fileName.c_str(),
+                          line);
+            throw std::invalid_argument("Invalid design space");
+        }
+        DseParameter parameter{section + "." + trim(text.substr(0, split)),
+                               {}};
+        std::stringstream ss(text.substr(split + 1));
+        std::string value;
+        while (ss >> value) {
+            auto machine = base;
+            try {
+                machine.set(parameter.key, value);
+            } catch (const std::invalid_argument &) {
+                Logger::Error("In %s line %u", fileName.c_str(), line);
+                throw;
+            }
+            parameter.values.push_back(value);
+        }
+        bool duplicate = std::any_of(
+            space.parameters.begin(),
+            space.parameters.end(),
+            [&](const auto &x) { return x.key == parameter.key; });
+        if (parameter.values.empty() || duplicate) {
+            Logger::Error("%s line %u: %s needs values and may appear once",
+                          fileName.c_str(),
+                          line,
+                          parameter.key.c_str());
+            throw std::invalid_argument("Invalid design space");
+        }
+        if (parameter.values.size() == 1) {
+            space.base.set(parameter.key, parameter.values.front());
+        } else {
+            space.parameters.push_back(parameter);
+        }
+    }
+    if (space.parameters.empty()) {
+        Logger::Error("Design space %s has no parameter with several values",
+                      fileName.c_str());
+        throw std::invalid_argument("Invalid design space");
+    }
+    return space;
+}
+
+/**
+ * @brief 默认的设计空间：Cache 容量、块大小、相联度、替换与写策略，
+ * ROB 与保留站大小以及主存延迟
+ *
+ * @param base 未作为维度的配置项
+ * @return DseSpace
+ */
+DseSpace defaultDseSpace(const MachineConfig &base) {
+    DseSpace space{base, {}};
+    for (const auto &x : defaultParameters) {
+        DseParameter parameter{x[0], {}};
+        std::stringstream ss(x[1]);
+        std::string value;
+        while (ss >> value) parameter.values.push_back(value);
+        space.parameters.push_back(parameter);
+    }
+    return space;
+}
+
+/**
+ * @brief 估计配置的片上存储，单位为字节
+ * 统计 ROB、各保留站、load/store buffer、BTB（带预测器时）与数据 Cache
+ * （带 Cache 时）的全部表项。保留站表项为指令、两个操作数及其 ROB 标签；
+ * load buffer 为 ROB 标签、地址与 2 个状态位；store buffer 为地址、数据
+ * 与 ROB 标签；Cache 块为数据、tag、有效位、写回时的脏位与 LRU 的次序，
+ * FIFO 为每组一个替换指针
+ *
+ * @param config
+ * @return unsigned long
+ */
+unsigned long estimateStorage(const MachineConfig &config) {
+    unsigned long robTag = log2Ceil(config.robSize);
+    unsigned long operandBits = 32 + robTag + 1;
+    unsigned long bits = config.robSize * robEntryBits;
+    bits += config.fuLatency.size() * config.rsSize *
+            (32 + 2 * operandBits + robTag + 1);
+    bits += config.robSize * (robTag + 32 + 2);
+    bits += config.robSize * (32 + 32 + robTag + 1);
+    if (config.type == ProcessorType::predict)
+        bits += config.btbSize * btbEntryBits;
+    if (config.type == ProcessorType::cache) {
+        unsigned long sets =
+            config.cacheSize / config.blockSize / config.associativity;
+        unsigned long way = log2Ceil(config.associativity);
+        unsigned long block = config.blockSize * 8ul + 32 - log2Ceil(sets) -
+                              log2Ceil(config.blockSize) + 1 +
+                              (config.writeThrough ? 0 : 1);
+        if (config.replaceType == ReplaceType::LRU) block += way;
+        bits += sets * config.associativity * block;
+        if (config.replaceType == ReplaceType::FIFO) bits += sets * way;
+    }
+    return (bits + 7) / 8;
+}
+
+/**
+ * @brief 探索设计空间，以周期数与片上存储为目标
+ * 给出缓存文件时先读入之前的结果，每个新结果完成后立即追加写入，
+ * 中断的探索以相同的参数重新运行即可从中断处继续
+ *
+ * @param space
+ * @param options
+ * @return std::vector<DseResult>
+ */
+std::vector<DseResult> exploreDesignSpace(const DseSpace &space,
+                                          const DseOptions &options) {
+    Explorer explorer(space, options);
+    switch (options.strategy) {
+    case SearchStrategy::grid:
+        searchGrid(explorer, space);
+        break;
+    case SearchStrategy::random:
+        searchRandom(explorer, options.samples);
+        break;
+    case SearchStrategy::hillClimb:
+        searchHillClimb(explorer, space, options);
+        break;
+    }
+    return explorer.finish();
+}
+
+void writeDseHeader(std::ostream &out, const DseSpace &space) {
+    out << "hash";
+    for (const auto &x : space.parameters) out << ',' << x.key;
+    out << ",storage,cycles,instructions,status,cached,pareto,error\n";
+}
+
+/**
+ * @brief 以 CSV 输出一个点的参数与结果，提前停止的点的周期数为下界
+ *
+ * @param out
+ * @param space
+ * @param result
+ */
+void writeDseResult(std::ostream &out,
+                    const DseSpace &space,
+                    const DseResult &result) {
+    char hash[24];
+    snprintf(hash, sizeof(hash), "%016llx", result.hash);
+    out << hash;
+    for (size_t i = 0; i < space.parameters.size(); i++)
+        out << ',' << space.parameters[i].values[result.point[i]];
+    out << ',' << result.storage << ',' << result.cycles << ','
+        << result.instructions << ','
+        << statusNames[static_cast<int>(result.status)] << ','
+        << result.cached << ',' << result.pareto << ',' << result.error
+        << '\n';
+}
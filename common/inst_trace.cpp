@@ -0,0 +1,140 @@
+#include "inst_trace.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "logger.h"
+
+namespace {
+
+// 写出前在内存中缓冲的记录条数
+constexpr size_t WRITE_BUFFER_RECORDS = 1u << 16u;
+
+}  // namespace
+
+/**
+ * @brief 创建追踪文件，写入文件头与指令区
+ *
+ * @param fileName 追踪文件名，已存在时被覆盖
+ * @param image 被追踪的程序映像
+ */
+InstTraceWriter::InstTraceWriter(const std::string &fileName,
+                                 const ProgramImage &image)
+    : out(fileName, std::ios::binary | std::ios::trunc), fileName(fileName) {
+    if (!out) {
+        Logger::Error("Cannot create trace file %s", fileName.c_str());
+        throw std::runtime_error("Cannot create trace file");
+    }
+    memcpy(header.magic, INST_TRACE_MAGIC, sizeof(INST_TRACE_MAGIC));
+    header.version = INST_TRACE_VERSION;
+    header.recordSize = sizeof(InstTraceRecord);
+    header.entry = image.entry;
+    header.codeSize = (unsigned) image.decoded.size();
+    header.count = 0;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (unsigned i = 0; i < header.codeSize; i++) {
+        unsigned word = image.word(i);
+        out.write(reinterpret_cast<const char *>(&word), sizeof(word));
+    }
+    buffer.reserve(WRITE_BUFFER_RECORDS);
+}
+
+InstTraceWriter::~InstTraceWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void InstTraceWriter::flushBuffer() {
+    out.write(reinterpret_cast<const char *>(buffer.data()),
+              (std::streamsize) (buffer.size() * sizeof(InstTraceRecord)));
+    buffer.clear();
+}
+
+void InstTraceWriter::append(const InstTraceRecord &record) {
+    buffer.push_back(record);
+    header.count++;
+    if (buffer.size() == WRITE_BUFFER_RECORDS) flushBuffer();
+}
+
+/**
+ * @brief 写出剩余的记录并更新文件头中的记录条数
+ */
+void InstTraceWriter::close() {
+    if (!out.is_open()) return;
+    flushBuffer();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        Logger::Error("Cannot write trace file %s", fileName.c_str());
+        throw std::runtime_error("Cannot write trace file");
+    }
+}
+
+/**
+ * @brief 映射追踪文件并检查文件头与长度
+ *
+ * @param fileName 追踪文件名
+ */
+InstTrace::InstTrace(const std::string &fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::Error("Cannot open trace file %s", fileName.c_str());
+        throw std::runtime_error("Cannot open trace file");
+    }
+    struct stat st {};
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(InstTraceHeader)) {
+        mapSize = st.st_size;
+        map = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == nullptr || map == MAP_FAILED) {
+        map = nullptr;
+        Logger::Error("%s: not an instruction trace", fileName.c_str());
+        throw std::invalid_argument("Invalid trace file");
+    }
+
+    header = static_cast<const InstTraceHeader *>(map);
+    auto invalid = [&](const char *reason) {
+        munmap(map, mapSize);
+        map = nullptr;
+        Logger::Error("%s: %s", fileName.c_str(), reason);
+        throw std::invalid_argument("Invalid trace file");
+    };
+    if (memcmp(header->magic, INST_TRACE_MAGIC, sizeof(INST_TRACE_MAGIC)) != 0)
+        invalid("not an instruction trace");
+    if (header->version != INST_TRACE_VERSION ||
+        header->recordSize != sizeof(InstTraceRecord))
+        invalid("unsupported trace version");
+    if (header->codeSize > (INST_MEM_SIZE >> 2u))
+        invalid("instruction memory exceeds 4MB");
+    size_t codeBytes = header->codeSize * sizeof(unsigned);
+    size_t available = mapSize - sizeof(InstTraceHeader);
+    if (available < codeBytes ||
+        (available - codeBytes) / sizeof(InstTraceRecord) < header->count)
+        invalid("trace is truncated");
+
+    const auto *words = reinterpret_cast<const unsigned *>(header + 1);
+    code.reserve(header->codeSize);
+    for (unsigned i = 0; i < header->codeSize; i++) {
+        code.push_back(Instruction::predecode(words[i]));
+        code.back().pc = 0x80000000u + (i << 2u);
+    }
+    records =
+        reinterpret_cast<const InstTraceRecord *>(words + header->codeSize);
+    for (unsigned long i = 0; i < header->count; i++) {
+        if (records[i].index >= header->codeSize)
+            invalid("record outside instruction memory");
+    }
+}
+
+InstTrace::~InstTrace() {
+    if (map != nullptr) munmap(map, mapSize);
+}
@@ -1,6 +1,5 @@
 #include "instructions.h"
 
-#include <functional>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -8,53 +7,212 @@
 #include "csr.h"
 #include "logger.h"
 
+namespace {
+
 /**
- * @brief Construct a new Instruction:: Instruction object
+ * @brief 根据 opcode/funct3/funct7 识别指令
  *
  * @param inst 指令编码
+ * @return Opcode 无法识别时返回 Opcode::INVALID
  */
-Instruction::Instruction(unsigned int inst) {
-    instruction = inst;
-    using namespace RV32I;
-    using namespace RV32M;
-    if (inst == LUI || inst == AUIPC || inst == EXTRA::EXIT)
-        type = InstructionType::U;
-    else if (inst == JAL) {
-        type = InstructionType::J;
-    } else if (inst == JALR) {
-        type = InstructionType::I;
-    } else if (inst == BEQ || inst == BNE || inst == BLT || inst == BGE ||
-               inst == BLTU || inst == BGEU)
-        type = InstructionType::B;
-    else if (inst == LB || inst == LH || inst == LW || inst == LBU ||
-             inst == LHU)
-        type = InstructionType::I;
-    else if (inst == SB || inst == SH || inst == SW)
-        type = InstructionType::S;
-    else if (inst == ADDI || inst == SLTI || inst == SLTIU || inst == XORI ||
-             inst == ORI || inst == ANDI || inst == SLLI || inst == SRLI ||
-             inst == SRAI)
-        type = InstructionType::I;
-    else if (inst == ADD || inst == SUB || inst == SLL || inst == SLT ||
-             inst == SLTU || inst == XOR || inst == SRL || inst == SRA ||
-             inst == OR || inst == AND)
-        type = InstructionType::R;
-    else if (inst == MUL || inst == MULH || inst == MULHSU || inst == MULHU ||
-             inst == DIV || inst == DIVU || inst == REM || inst == REMU)
-        type = InstructionType::R;
-    else if (inst == CSRRW || inst == CSRRS || inst == CSRRC)
-        type = InstructionType::I;
-    else if (inst == CSRRWI || inst == CSRRSI || inst == CSRRCI)
-        type = InstructionType::U;
-    else if (inst == FENCE)
-        type = InstructionType::I;
-    else {
-        std::stringstream ss;
-        ss << inst;
-        std::string tmp;
-        ss >> std::hex >> tmp;
-        tmp = "Instruction " + tmp + " not implemented.";
-        throw std::invalid_argument(tmp.c_str());
+Opcode decodeOpcode(unsigned inst) {
+    unsigned funct3 = (inst >> 12u) & 0x7u;
+    unsigned funct7 = inst >> 25u;
+    switch (inst & 0x7Fu) {
+    case 0b0110111:
+        return Opcode::LUI;
+    case 0b0010111:
+        return Opcode::AUIPC;
+    case 0b0001011:
+        return Opcode::EXIT;
+    case 0b1101111:
+        return Opcode::JAL;
+    case 0b1100111:
+        return funct3 == 0 ? Opcode::JALR : Opcode::INVALID;
+    case 0b1100011: {
+        constexpr Opcode table[8] = {Opcode::BEQ,
+                                     Opcode::BNE,
+                                     Opcode::INVALID,
+                                     Opcode::INVALID,
+                                     Opcode::BLT,
+                                     Opcode::BGE,
+                                     Opcode::BLTU,
+                                     Opcode::BGEU};
+        return table[funct3];
+    }
+    case 0b0000011: {
+        constexpr Opcode table[8] = {Opcode::LB,
+                                     Opcode::LH,
+                                     Opcode::LW,
+                                     Opcode::INVALID,
+                                     Opcode::LBU,
+                                     Opcode::LHU,
+                                     Opcode::INVALID,
+                                     Opcode::INVALID};
+        return table[funct3];
+    }
+    case 0b0100011: {
+        constexpr Opcode table[8] = {Opcode::SB,
+                                     Opcode::SH,
+                                     Opcode::SW,
+                                     Opcode::INVALID,
+                                     Opcode::INVALID,
+                                     Opcode::INVALID,
+                                     Opcode::INVALID,
+                                     Opcode::INVALID};
+        return table[funct3];
+    }
+    case 0b0010011:
+        switch (funct3) {
+        case 0b000:
+            return Opcode::ADDI;
+        case 0b010:
+            return Opcode::SLTI;
+        case 0b011:
+            return Opcode::SLTIU;
+        case 0b100:
+            return Opcode::XORI;
+        case 0b110:
+            return Opcode::ORI;
+        case 0b111:
+            return Opcode::ANDI;
+        case 0b001:
+            return funct7 == 0 ? Opcode::SLLI : Opcode::INVALID;
+        default:
+            if (funct7 == 0) return Opcode::SRLI;
+            if (funct7 == 0b0100000) return Opcode::SRAI;
+            return Opcode::INVALID;
+        }
+    case 0b0110011:
+        if (funct7 == 0) {
+            constexpr Opcode table[8] = {Opcode::ADD,
+                                         Opcode::SLL,
+                                         Opcode::SLT,
+                                         Opcode::SLTU,
+                                         Opcode::XOR,
+                                         Opcode::SRL,
+                                         Opcode::OR,
+                                         Opcode::AND};
+            return table[funct3];
+        } else if (funct7 == 0b0000001) {
+            constexpr Opcode table[8] = {Opcode::MUL,
+                                         Opcode::MULH,
+                                         Opcode::MULHSU,
+                                         Opcode::MULHU,
+                                         Opcode::DIV,
+                                         Opcode::DIVU,
+                                         Opcode::REM,
+                                         Opcode::REMU};
+            return table[funct3];
+        } else if (funct7 == 0b0100000) {
+            if (funct3 == 0b000) return Opcode::SUB;
+            if (funct3 == 0b101) return Opcode::SRA;
+        }
+        return Opcode::INVALID;
+    case 0b0001111:
+        return funct3 == 0 ? Opcode::FENCE : Opcode::INVALID;
+    case 0b1110011: {
+        constexpr Opcode table[8] = {Opcode::INVALID,
+                                     Opcode::CSRRW,
+                                     Opcode::CSRRS,
+                                     Opcode::CSRRC,
+                                     Opcode::INVALID,
+                                     Opcode::CSRRWI,
+                                     Opcode::CSRRSI,
+                                     Opcode::CSRRCI};
+        return table[funct3];
+    }
+    default:
+        return Opcode::INVALID;
+    }
+}
+
+/**
+ * @brief 获取指令的编码格式
+ */
+InstructionType typeOf(Opcode opcode) {
+    switch (opcode) {
+    case Opcode::LUI:
+    case Opcode::AUIPC:
+    case Opcode::EXIT:
+    case Opcode::CSRRWI:
+    case Opcode::CSRRSI:
+    case Opcode::CSRRCI:
+        return InstructionType::U;
+    case Opcode::JAL:
+        return InstructionType::J;
+    case Opcode::BEQ:
+    case Opcode::BNE:
+    case Opcode::BLT:
+    case Opcode::BGE:
+    case Opcode::BLTU:
+    case Opcode::BGEU:
+        return InstructionType::B;
+    case Opcode::SB:
+    case Opcode::SH:
+    case Opcode::SW:
+        return InstructionType::S;
+    case Opcode::ADD:
+    case Opcode::SUB:
+    case Opcode::SLL:
+    case Opcode::SLT:
+    case Opcode::SLTU:
+    case Opcode::XOR:
+    case Opcode::SRL:
+    case Opcode::SRA:
+    case Opcode::OR:
+    case Opcode::AND:
+    case Opcode::MUL:
+    case Opcode::MULH:
+    case Opcode::MULHSU:
+    case Opcode::MULHU:
+    case Opcode::DIV:
+    case Opcode::DIVU:
+    case Opcode::REM:
+    case Opcode::REMU:
+        return InstructionType::R;
+    default:
+        return InstructionType::I;
+    }
+}
+
+/**
+ * @brief 获取指令的执行单元种类
+ */
+FUType fuTypeOf(Opcode opcode) {
+    switch (opcode) {
+    case Opcode::JAL:
+    case Opcode::JALR:
+    case Opcode::BEQ:
+    case Opcode::BNE:
+    case Opcode::BLT:
+    case Opcode::BGE:
+    case Opcode::BLTU:
+    case Opcode::BGEU:
+        return FUType::BRU;
+    case Opcode::LB:
+    case Opcode::LH:
+    case Opcode::LW:
+    case Opcode::LBU:
+    case Opcode::LHU:
+    case Opcode::SB:
+    case Opcode::SH:
+    case Opcode::SW:
+        return FUType::LSU;
+    case Opcode::MUL:
+    case Opcode::MULH:
+    case Opcode::MULHSU:
+    case Opcode::MULHU:
+        return FUType::MUL;
+    case Opcode::DIV:
+    case Opcode::DIVU:
+    case Opcode::REM:
+    case Opcode::REMU:
+        return FUType::DIV;
+    case Opcode::EXIT:
+        return FUType::NONE;
+    default:
+        return FUType::ALU;
     }
 }
 
@@ -63,7 +221,7 @@ Instruction::Instruction(unsigned int inst) {
  *
  * @return unsigned 立即数，没有则返回0
  */
-unsigned Instruction::getImmediate() const {
+unsigned immediateOf(unsigned instruction, InstructionType type) {
     bool flag = (instruction >> 31u);
     switch (type) {
     case InstructionType::R:
@@ -89,60 +247,155 @@ unsigned Instruction::getImmediate() const {
     return 0;
 }
 
+}  // namespace
+
 /**
- * @brief 根据指令类型获取指令的rd域
+ * @brief Construct a new Instruction:: Instruction object
  *
- * @return unsigned 指令有rd时返回rd，没有时返回0
+ * @param inst 指令编码
  */
-unsigned Instruction::getRd() const {
-    if (type != InstructionType::B && type != InstructionType::S)
-        return ((instruction >> 7u) & 0x1Fu);
-    return 0;
+Instruction::Instruction(unsigned int inst) {
+    decode(inst);
+    if (opcode == Opcode::INVALID) {
+        std::stringstream ss;
+        ss << inst;
+        std::string tmp;
+        ss >> std::hex >> tmp;
+        tmp = "Instruction " + tmp + " not implemented.";
+        throw std::invalid_argument(tmp.c_str());
+    }
 }
 
 /**
- * @brief 根据指令类型获取指令的rs1域
+ * @brief 译码指令，计算类型、寄存器号、立即数、执行单元与指令编号
+ * 无法识别的编码不会抛出异常，opcode 被置为 Opcode::INVALID
  *
- * @return unsigned 指令有rs1时返回rs1，没有时返回0
+ * @param inst 指令编码
  */
-unsigned Instruction::getRs1() const {
-    if (type != InstructionType::U && type != InstructionType::J)
-        return ((instruction >> 15u) & 0x1Fu);
-    return 0;
+void Instruction::decode(unsigned int inst) {
+    instruction = inst;
+    opcode = decodeOpcode(inst);
+    type = typeOf(opcode);
+    fuType = fuTypeOf(opcode);
+    imm = immediateOf(inst, type);
+    // 指令有rd/rs1/rs2时返回对应域，没有时为0
+    rd = (type != InstructionType::B && type != InstructionType::S)
+             ? ((inst >> 7u) & 0x1Fu)
+             : 0;
+    rs1 = (type != InstructionType::U && type != InstructionType::J)
+              ? ((inst >> 15u) & 0x1Fu)
+              : 0;
+    rs2 = (type == InstructionType::S || type == InstructionType::R ||
+           type == InstructionType::B)
+              ? ((inst >> 20u) & 0x1Fu)
+              : 0;
 }
 
 /**
- * @brief 根据指令类型获取指令的rs2域
+ * @brief 预译码指令，不识别的编码不抛出异常
  *
- * @return unsigned 指令有rs2时返回rs2，没有时返回0
+ * @param inst 指令编码
+ * @return Instruction opcode 为 Opcode::INVALID 时表示无法识别
  */
-unsigned Instruction::getRs2() const {
-    if (type == InstructionType::S || type == InstructionType::R ||
-        type == InstructionType::B)
-        return ((instruction >> 20u) & 0x1Fu);
-    return 0;
+Instruction Instruction::predecode(unsigned int inst) {
+    Instruction ret;
+    ret.decode(inst);
+    return ret;
+}
+
+namespace {
+
+// 与 Opcode 的定义顺序一致
+constexpr const char *opcodeName[] = {
+    // clang-format off
+    "LUI", "AUIPC", "JAL", "JALR",
+    "BEQ", "BNE", "BLT", "BGE", "BLTU", "BGEU",
+    "LB", "LH", "LW", "LBU", "LHU",
+    "SB", "SH", "SW",
+    "ADDI", "SLTI", "SLTIU", "XORI", "ORI", "ANDI", "SLLI", "SRLI", "SRAI",
+    "ADD", "SUB", "SLL", "SLT", "SLTU", "XOR", "SRL", "SRA", "OR", "AND",
+    "FENCE",
+    "CSRRW", "CSRRS", "CSRRC", "CSRRWI", "CSRRSI", "CSRRCI",
+    "MUL", "MULH", "MULHSU", "MULHU", "DIV", "DIVU", "REM", "REMU",
+    "EXIT",
+    "INVALID"
+    // clang-format on
+};
+
+static_assert(sizeof(opcodeName) / sizeof(opcodeName[0]) ==
+                  static_cast<size_t>(Opcode::INVALID) + 1,
+              "opcodeName must cover every Opcode");
+
+void printCSR(std::ostream &os, unsigned id) {
+    if (id == MEPC)
+        os << "MEPC";
+    else if (id == MSTATUS)
+        os << "MSTATUS";
+    else if (id == MIP)
+        os << "MIP";
+    else if (id == MIE)
+        os << "MIE";
+    else
+        os << id;
 }
 
+}  // namespace
+
 /**
- * @brief 用于判断指令是否为某种类型的指令
+ * @brief 获取指令名称
  *
- * @param rhs 指令类型
- * @return true
- * @return false
+ * @param opcode
+ * @return const char*
  */
-bool Instruction::operator==(const MaskedLiteral &rhs) const {
-    return rhs == instruction;
+const char *getOpcodeName(Opcode opcode) {
+    return opcodeName[static_cast<size_t>(opcode)];
 }
 
 /**
- * @brief 用于判断指令是否不为某种类型的指令
+ * @brief 获取执行单元的执行周期数，访存指令不含主存或 Cache 的延迟
  *
- * @param rhs 指令类型
- * @return true
- * @return false
+ * @param type
+ * @return unsigned 没有执行单元的指令返回 0
  */
-bool Instruction::operator!=(const MaskedLiteral &rhs) const {
-    return !(*this == rhs);
+unsigned getFULatency(FUType type) {
+    switch (type) {
+    case FUType::ALU:
+    case FUType::BRU:
+        return 1;
+    case FUType::LSU:
+        return 2;
+    case FUType::MUL:
+        return 3;
+    case FUType::DIV:
+        return 10;
+    case FUType::NONE:
+        break;
+    }
+    return 0;
+}
+
+/**
+ * @brief 获取执行单元名称
+ *
+ * @param type
+ * @return const char*
+ */
+const char *getFUName(FUType type) {
+    switch (type) {
+    case FUType::ALU:
+        return "ALU";
+    case FUType::BRU:
+        return "BRU";
+    case FUType::LSU:
+        return "LSU";
+    case FUType::MUL:
+        return "MUL";
+    case FUType::DIV:
+        return "DIV";
+    case FUType::NONE:
+        break;
+    }
+    return "NONE";
 }
 
 /**
@@ -153,193 +406,58 @@ bool Instruction::operator!=(const MaskedLiteral &rhs) const {
  * @return std::ostream&
  */
 std::ostream &operator<<(std::ostream &os, const Instruction &inst) {
-    using namespace RV32I;
-    using namespace RV32M;
-
     const std::string &rs1 = xreg_name[inst.getRs1()];
     const std::string &rs2 = xreg_name[inst.getRs2()];
     const std::string &rd = xreg_name[inst.getRd()];
     unsigned imm = inst.getImmediate();
-    unsigned shaft = imm & 31u;
-
-    if (inst == FENCE) {
-        os << "FENCE";
-        return os;
-    }
 
-    if (inst == EXTRA::EXIT) {
-        os << "EXIT";
-        return os;
-    }
-
-    if (inst == CSRRW || inst == CSRRS || inst == CSRRC) {
-        if (inst == CSRRW)
-            os << "CSRRW ";
-        else if (inst == CSRRS)
-            os << "CSRRS ";
-        else if (inst == CSRRC)
-            os << "CSRRC ";
-        os << rd << " ";
-        unsigned id = imm & 0xFFFu;
-        if (id == MEPC)
-            os << "MEPC";
-        else if (id == MSTATUS)
-            os << "MSTATUS";
-        else if (id == MIP)
-            os << "MIP";
-        else if (id == MIE)
-            os << "MIE";
-        else
-            os << id;
-        os << " " << rs1;
-        return os;
+    switch (inst.opcode) {
+    case Opcode::INVALID: {
+        std::stringstream ss;
+        ss << inst.instruction;
+        std::string tmp;
+        ss >> std::hex >> tmp;
+        tmp = "Instruction " + tmp + " not implemented.";
+        throw std::invalid_argument(tmp.c_str());
     }
-
-    if (inst == CSRRWI || inst == CSRRSI || inst == CSRRCI) {
-        unsigned uimm = inst.get(15, 5);
-        unsigned id = inst.get(20, 12);
-        if (inst == CSRRWI)
-            os << "CSRRWI ";
-        else if (inst == CSRRSI)
-            os << "CSRRSI ";
-        else if (inst == CSRRCI)
-            os << "CSRRCI ";
-        os << rd << " ";
-        if (id == MEPC)
-            os << "MEPC";
-        else if (id == MSTATUS)
-            os << "MSTATUS";
-        else if (id == MIP)
-            os << "MIP";
-        else if (id == MIE)
-            os << "MIE";
-        else
-            os << id;
-        os << " " << uimm;
-        return os;
+    case Opcode::FENCE:
+    case Opcode::EXIT:
+        return os << getOpcodeName(inst.opcode);
+    case Opcode::CSRRW:
+    case Opcode::CSRRS:
+    case Opcode::CSRRC:
+        os << getOpcodeName(inst.opcode) << " " << rd << " ";
+        printCSR(os, imm & 0xFFFu);
+        return os << " " << rs1;
+    case Opcode::CSRRWI:
+    case Opcode::CSRRSI:
+    case Opcode::CSRRCI:
+        os << getOpcodeName(inst.opcode) << " " << rd << " ";
+        printCSR(os, inst.get(20, 12));
+        return os << " " << inst.get(15, 5);
+    case Opcode::SLLI:
+    case Opcode::SRLI:
+    case Opcode::SRAI:
+        // 移位指令只输出移位量
+        imm &= 31u;
+        break;
+    default:
+        break;
     }
 
+    os << getOpcodeName(inst.opcode) << " ";
     switch (inst.type) {
     case InstructionType::U:
     case InstructionType::J:
-        if (inst == LUI)
-            os << "LUI ";
-        else if (inst == AUIPC)
-            os << "AUIPC ";
-        else if (inst == JAL)
-            os << "JAL ";
-        os << rd << ", " << imm;
-        return os;
-
+        return os << rd << ", " << imm;
     case InstructionType::B:
     case InstructionType::S:
-        if (inst == BEQ)
-            os << "BEQ ";
-        else if (inst == BNE)
-            os << "BNE ";
-        else if (inst == BLT)
-            os << "BLT ";
-        else if (inst == BGE)
-            os << "BGE ";
-        else if (inst == BLTU)
-            os << "BLTU ";
-        else if (inst == BGEU)
-            os << "BGEU ";
-        else if (inst == SB)
-            os << "SB ";
-        else if (inst == SH)
-            os << "SH ";
-        else if (inst == SW)
-            os << "SW ";
-        os << rs1 << ", " << rs2 << ", " << imm;
-        return os;
-
+        return os << rs1 << ", " << rs2 << ", " << imm;
     case InstructionType::I:
-        if (inst == ADDI)
-            os << "ADDI ";
-        else if (inst == SLTI)
-            os << "SLTI ";
-        else if (inst == SLTIU)
-            os << "SLTIU ";
-        else if (inst == XORI)
-            os << "XORI ";
-        else if (inst == ORI)
-            os << "ORI ";
-        else if (inst == ANDI)
-            os << "ANDI ";
-        else if (inst == SLLI) {
-            os << "SLLI ";
-            imm = shaft;
-        } else if (inst == SRLI) {
-            os << "SRLI ";
-            imm = shaft;
-        } else if (inst == SRAI) {
-            os << "SRAI ";
-            imm = shaft;
-        } else if (inst == JALR)
-            os << "JALR ";
-        else if (inst == LW)
-            os << "LW ";
-        else if (inst == LH)
-            os << "LH ";
-        else if (inst == LHU)
-            os << "LHU ";
-        else if (inst == LB)
-            os << "LB ";
-        else if (inst == LBU)
-            os << "LBU ";
-        else if (inst == JALR)
-            os << "JALR ";
-        os << rd << ", " << rs1 << ", " << imm;
-        return os;
-
+        return os << rd << ", " << rs1 << ", " << imm;
     case InstructionType::R:
-        if (inst == ADD)
-            os << "ADD ";
-        else if (inst == SUB)
-            os << "SUB ";
-        else if (inst == SLL)
-            os << "SLL ";
-        else if (inst == SLT)
-            os << "SLT ";
-        else if (inst == SLTU)
-            os << "SLTU ";
-        else if (inst == XOR)
-            os << "XOR ";
-        else if (inst == SRL)
-            os << "SRL ";
-        else if (inst == SRA)
-            os << "SRA ";
-        else if (inst == OR)
-            os << "OR ";
-        else if (inst == AND)
-            os << "AND ";
-        else if (inst == MUL)
-            os << "MUL ";
-        else if (inst == MULH)
-            os << "MULH ";
-        else if (inst == MULHSU)
-            os << "MULHSU ";
-        else if (inst == MULHU)
-            os << "MULHU ";
-        else if (inst == DIV)
-            os << "DIV ";
-        else if (inst == DIVU)
-            os << "DIVU ";
-        else if (inst == REM)
-            os << "REM ";
-        else if (inst == REMU)
-            os << "REMU ";
-        os << rd << ", " << rs1 << ", " << rs2;
-        return os;
+        return os << rd << ", " << rs1 << ", " << rs2;
     }
-
-    std::stringstream ss;
-    ss << inst.instruction;
-    std::string tmp;
-    ss >> std::hex >> tmp;
-    tmp = "Instruction " + tmp + " not implemented.";
-    throw std::invalid_argument(tmp.c_str());
     return os;
 }
 
@@ -385,227 +503,178 @@ unsigned Instruction::get(int index, int length) const {
     return (instruction >> index) & tmp;
 }
 
-/**
- * @brief 获取指令的执行单元种类
- *
- * @param inst
- * @return FUType
- */
-FUType getFUType(const Instruction &inst) {
-    using namespace RV32I;
-    using namespace RV32M;
+namespace {
 
-    if (inst == JAL || inst == JALR || inst == BEQ || inst == BNE ||
-        inst == BLT || inst == BGE || inst == BLTU || inst == BGEU) {
-        return FUType::BRU;
-    }
-
-    if (inst == LB || inst == LH || inst == LW || inst == LBU || inst == LHU ||
-        inst == SB || inst == SH || inst == SW) {
-        return FUType::LSU;
-    }
-
-    if (inst == MUL || inst == MULH || inst == MULHSU || inst == MULHU) {
-        return FUType::MUL;
-    }
-
-    if (inst == DIV || inst == DIVU || inst == REM || inst == REMU) {
-        return FUType::DIV;
-    }
-
-    if (inst == EXTRA::EXIT) {
-        return FUType::NONE;
-    }
-
-    return FUType::ALU;
+[[noreturn]] void incorrectInstruction(const Instruction &inst, FUType type) {
+    std::stringstream ss;
+    ss << inst;
+    Logger::Error("Incorrect instruction %s executed in %s",
+                  ss.str().c_str(),
+                  getFUName(type));
+    throw std::runtime_error("Incorrect instruction executed");
 }
 
+}  // namespace
+
 /**
  * @brief 执行指令，获取执行结果
  *
- * @param name 执行指令的单元名称
+ * @param type 执行指令的单元种类
  * @param operand1 操作数1，只需传入寄存器读取结果
  * @param operand2
  * 操作数2，只需传入寄存器读取结果，使用立即数时会在函数内自行读取处理
  * @return ExecuteResultBundle
  */
-ExecuteResultBundle Instruction::execute(const std::string &name,
+ExecuteResultBundle Instruction::execute(FUType type,
                                          unsigned operand1,
                                          unsigned operand2) const {
-    using namespace RV32I;
-    using namespace RV32M;
-
-    const Instruction &inst = *this;
-
     ExecuteResultBundle ret{};
     unsigned &result = ret.result;
-    bool &mispredict = ret.mispredict;
-    bool &actualTaken = ret.actualTaken;
-    unsigned &jumpTarget = ret.jumpTarget;
-
-    if (name == "ALU") {
-        if (inst == LUI)
-            result = getImmediate();
-        else if (inst == AUIPC)
-            result = pc + getImmediate();
-        else {
-            std::function<unsigned(unsigned, unsigned)> func;
-            if (inst == ADD || inst == ADDI)
-                func = [](unsigned a, unsigned b) { return a + b; };
-            else if (inst == SUB)
-                func = [](unsigned a, unsigned b) { return a - b; };
-            else if (inst == SLT || inst == SLTI)
-                func = [](unsigned a, unsigned b) {
-                    return (int) a < (int) b ? 1 : 0;
-                };
-            else if (inst == SLTU || inst == SLTIU)
-                func = [](unsigned a, unsigned b) { return a < b ? 1 : 0; };
-            else if (inst == SLL || inst == SLLI)
-                func = [](unsigned a, unsigned b) { return a << (b & 31); };
-            else if (inst == SRL || inst == SRLI)
-                func = [](unsigned a, unsigned b) { return a >> (b & 31); };
-            else if (inst == SRA || inst == SRAI)
-                func = [](unsigned a, unsigned b) {
-                    return (int) a >> ((int) b & 31);
-                };
-            else if (inst == AND || inst == ANDI)
-                func = [](unsigned a, unsigned b) { return a & b; };
-            else if (inst == OR || inst == ORI)
-                func = [](unsigned a, unsigned b) { return a | b; };
-            else if (inst == XOR || inst == XORI)
-                func = [](unsigned a, unsigned b) { return a ^ b; };
-            else {
-                std::stringstream ss;
-                ss << (*this);
-                Logger::Error("Incorrect instruction %s executed in %s",
-                              ss.str().c_str(),
-                              name.c_str());
-                throw std::runtime_error("Incorrect instruction executed");
-            }
-            result =
-                func(operand1,
-                     type == InstructionType::R ? operand2 : getImmediate());
+    unsigned b = this->type == InstructionType::R ? operand2 : imm;
+
+    ret.mispredict = predictBundle.predictJump;
+    ret.actualTaken = false;
+
+    switch (type) {
+    case FUType::ALU:
+        switch (opcode) {
+        case Opcode::LUI:
+            result = imm;
+            break;
+        case Opcode::AUIPC:
+            result = pc + imm;
+            break;
+        case Opcode::ADD:
+        case Opcode::ADDI:
+            result = operand1 + b;
+            break;
+        case Opcode::SUB:
+            result = operand1 - b;
+            break;
+        case Opcode::SLT:
+        case Opcode::SLTI:
+            result = (int) operand1 < (int) b ? 1 : 0;
+            break;
+        case Opcode::SLTU:
+        case Opcode::SLTIU:
+            result = operand1 < b ? 1 : 0;
+            break;
+        case Opcode::SLL:
+        case Opcode::SLLI:
+            result = operand1 << (b & 31);
+            break;
+        case Opcode::SRL:
+        case Opcode::SRLI:
+            result = operand1 >> (b & 31);
+            break;
+        case Opcode::SRA:
+        case Opcode::SRAI:
+            result = (int) operand1 >> ((int) b & 31);
+            break;
+        case Opcode::AND:
+        case Opcode::ANDI:
+            result = operand1 & b;
+            break;
+        case Opcode::OR:
+        case Opcode::ORI:
+            result = operand1 | b;
+            break;
+        case Opcode::XOR:
+        case Opcode::XORI:
+            result = operand1 ^ b;
+            break;
+        default:
+            incorrectInstruction(*this, type);
         }
-        mispredict = predictBundle.predictJump;
-        actualTaken = false;
         return ret;
-    } else if (name == "BRU") {
+    case FUType::BRU: {
         bool jump = false;
-        if (inst == JAL) {
+        switch (opcode) {
+        case Opcode::JAL:
             result = pc + 4;
-            jumpTarget = pc + inst.getImmediate();
+            ret.jumpTarget = pc + imm;
             jump = true;
-        } else if (inst == JALR) {
+            break;
+        case Opcode::JALR:
             result = pc + 4;
-            jumpTarget = operand1 + getImmediate();
+            ret.jumpTarget = operand1 + imm;
             jump = true;
-        } else if (inst == BEQ || inst == BNE || inst == BLT || inst == BGE ||
-                   inst == BLTU || inst == BGEU) {
-            jumpTarget = pc + getImmediate();
-            if (inst == BEQ)
-                jump = operand1 == operand2;
-            else if (inst == BNE)
-                jump = operand1 != operand2;
-            else if (inst == BLT)
-                jump = (int) operand1 < (int) operand2;
-            else if (inst == BGE)
-                jump = (int) operand1 >= (int) operand2;
-            else if (inst == BLTU)
-                jump = operand1 < operand2;
-            else if (inst == BGEU)
-                jump = operand1 >= operand2;
-        } else {
-            std::stringstream ss;
-            ss << (*this);
-            Logger::Error("Incorrect instruction %s executed in %s",
-                          ss.str().c_str(),
-                          name.c_str());
-            throw std::runtime_error("Incorrect instruction executed");
+            break;
+        case Opcode::BEQ:
+            jump = operand1 == operand2;
+            break;
+        case Opcode::BNE:
+            jump = operand1 != operand2;
+            break;
+        case Opcode::BLT:
+            jump = (int) operand1 < (int) operand2;
+            break;
+        case Opcode::BGE:
+            jump = (int) operand1 >= (int) operand2;
+            break;
+        case Opcode::BLTU:
+            jump = operand1 < operand2;
+            break;
+        case Opcode::BGEU:
+            jump = operand1 >= operand2;
+            break;
+        default:
+            incorrectInstruction(*this, type);
         }
-        actualTaken = jump;
-        mispredict = (predictBundle.predictJump != jump) ||
-                     (jump && predictBundle.predictTarget != jumpTarget);
+        if (this->type == InstructionType::B) ret.jumpTarget = pc + imm;
+        ret.actualTaken = jump;
+        ret.mispredict =
+            (predictBundle.predictJump != jump) ||
+            (jump && predictBundle.predictTarget != ret.jumpTarget);
         return ret;
-    } else if (name == "MUL") {
-        std::function<unsigned(unsigned, unsigned)> func;
-        if (inst == MUL)
-            func = [](unsigned a, unsigned b) {
-                return (unsigned) ((1LLU * a * b) & 0xFFFFFFFFu);
-            };
-        else if (inst == MULH)
-            func = [](unsigned a, unsigned b) {
-                long long tmp = 1LL * (int) a * (int) b;
-                return (unsigned) ((tmp >> 32u) & 0xFFFFFFFFU);
-            };
-        else if (inst == MULHSU)
-            func = [](unsigned a, unsigned b) {
-                long long tmp = 1LL * (int) a * b;
-                return (unsigned) ((tmp >> 32u) & 0xFFFFFFFFU);
-            };
-        else if (inst == MULHU)
-            func = [](unsigned a, unsigned b) {
-                long long tmp = 1LLU * a * b;
-                return (unsigned) ((tmp >> 32u) & 0xFFFFFFFFU);
-            };
-        else {
-            std::stringstream ss;
-            ss << (*this);
-            Logger::Error("Incorrect instruction %s executed in %s",
-                          ss.str().c_str(),
-                          name.c_str());
-            throw std::runtime_error("Incorrect instruction executed");
+    }
+    case FUType::MUL:
+        switch (opcode) {
+        case Opcode::MUL:
+            result = (unsigned) ((1LLU * operand1 * b) & 0xFFFFFFFFu);
+            break;
+        case Opcode::MULH:
+            result = (unsigned) (((1LL * (int) operand1 * (int) b) >> 32u) &
+                                 0xFFFFFFFFU);
+            break;
+        case Opcode::MULHSU:
+            result = (unsigned) (((1LL * (int) operand1 * b) >> 32u) &
+                                 0xFFFFFFFFU);
+            break;
+        case Opcode::MULHU:
+            result = (unsigned) (((long long) (1LLU * operand1 * b) >> 32u) &
+                                 0xFFFFFFFFU);
+            break;
+        default:
+            incorrectInstruction(*this, type);
         }
-        result = func(operand1,
-                      type == InstructionType::R ? operand2 : getImmediate());
-        actualTaken = false;
-        mispredict = predictBundle.predictJump;
         return ret;
-    } else if (name == "DIV") {
-        std::function<unsigned(unsigned, unsigned)> func;
-        if (inst == DIV)
-            func = [](unsigned a, unsigned b) {
-                return (unsigned) ((int) a / (int) b);
-            };
-        else if (inst == DIVU)
-            func = [](unsigned a, unsigned b) { return a / b; };
-        else if (inst == REM)
-            func = [](unsigned a, unsigned b) {
-                return (unsigned) ((int) a % (int) b);
-            };
-        else if (inst == REMU)
-            func = [](unsigned a, unsigned b) { return a % b; };
-        else {
-            std::stringstream ss;
-            ss << (*this);
-            Logger::Error("Incorrect instruction %s executed in %s",
-                          ss.str().c_str(),
-                          name.c_str());
-            throw std::runtime_error("Incorrect instruction executed");
+    case FUType::DIV:
+        switch (opcode) {
+        case Opcode::DIV:
+            result = (unsigned) ((int) operand1 / (int) b);
+            break;
+        case Opcode::DIVU:
+            result = operand1 / b;
+            break;
+        case Opcode::REM:
+            result = (unsigned) ((int) operand1 % (int) b);
+            break;
+        case Opcode::REMU:
+            result = operand1 % b;
+            break;
+        default:
+            incorrectInstruction(*this, type);
         }
-        result = func(operand1,
-                      type == InstructionType::R ? operand2 : getImmediate());
-        actualTaken = false;
-        mispredict = predictBundle.predictJump;
         return ret;
-    } else if (name == "LSU") {
-        if (inst == LB || inst == LH || inst == LW || inst == LBU ||
-            inst == LHU || inst == SB || inst == SH || inst == SW) {
-            result = operand1 + getImmediate();
-        } else {
-            std::stringstream ss;
-            ss << (*this);
-            Logger::Error("Incorrect instruction %s executed in %s",
-                          ss.str().c_str(),
-                          name.c_str());
-            throw std::runtime_error("Incorrect instruction executed");
-        }
-        actualTaken = false;
-        mispredict = predictBundle.predictJump;
+    case FUType::LSU:
+        if (fuType != FUType::LSU) incorrectInstruction(*this, type);
+        result = operand1 + imm;
         return ret;
+    case FUType::NONE:
+        break;
     }
 
-    Logger::Error("Unknown component name %s", name.c_str());
+    Logger::Error("Unknown component name %s", getFUName(type));
     throw std::runtime_error("Unknown component name");
-
-    return ret;
-}
\ No newline at end of file
+}
@@ -1,24 +1,102 @@
 #include "logger.h"
 
 #include <cstdio>
+#include <cstring>
+#include <vector>
 
-bool Logger::debugOutput = false;
-bool Logger::infoOutput = true;
-bool Logger::warnOutput = true;
+std::atomic<bool> Logger::debugOutput = false;
+std::atomic<bool> Logger::infoOutput = true;
+std::atomic<bool> Logger::warnOutput = true;
+std::atomic<unsigned> Logger::categoryMask = ~0u;
+
+namespace {
+
+constexpr std::size_t LOG_BUFFER_SIZE = 1u << 16;
+// 剩余空间不足该值时先写出缓冲区，避免单条日志被截断
+constexpr std::size_t LOG_LINE_RESERVE = 1u << 10;
+
+// 每个线程的日志缓冲区，线程结束时写出剩余的日志
+struct LogBuffer {
+    char data[LOG_BUFFER_SIZE];
+    std::size_t used = 0;
+    FILE *sink = stderr;
+
+    ~LogBuffer() { Logger::flush(); }
+};
+
+thread_local LogBuffer logBuffer;
+
+const char *const categoryNames[] = {
+    "general", "frontend", "rs", "execute", "lsu",
+    "rob",     "commit",   "cache", "memory",
+};
+static_assert(sizeof(categoryNames) / sizeof(categoryNames[0]) ==
+              static_cast<unsigned>(LogCategory::NUM_CATEGORIES));
+
+/**
+ * @brief 将一条日志追加到输出缓冲区，过长的日志直接写出
+ *
+ * @param prefix 日志等级前缀
+ * @param format
+ * @param args
+ */
+void append(const char *prefix, const char *format, va_list args) {
+    auto &buffer = logBuffer;
+    if (LOG_BUFFER_SIZE - buffer.used < LOG_LINE_RESERVE) Logger::flush();
+
+    auto room = LOG_BUFFER_SIZE - buffer.used;
+    auto prefixLength = strlen(prefix);
+    memcpy(buffer.data + buffer.used, prefix, prefixLength);
+
+    va_list copy;
+    va_copy(copy, args);
+    auto length = vsnprintf(buffer.data + buffer.used + prefixLength,
+                            room - prefixLength,
+                            format,
+                            copy);
+    va_end(copy);
+
+    if (length >= 0 && prefixLength + length + 1 < room) {
+        buffer.used += prefixLength + length;
+        buffer.data[buffer.used++] = '\n';
+        return;
+    }
+
+    // 过长的日志单独格式化后一次写出，避免与其他线程的输出交错
+    Logger::flush();
+    if (length < 0) return;
+    std::vector<char> line(prefixLength + length + 2);
+    memcpy(line.data(), prefix, prefixLength);
+    vsnprintf(line.data() + prefixLength, length + 1, format, args);
+    line[prefixLength + length] = '\n';
+    fwrite(line.data(), 1, prefixLength + length + 1, buffer.sink);
+}
+
+}  // namespace
 
 /**
  * @brief 是否开启调试输出
  *
  * @param flag
  */
-void Logger::setDebugOutput(bool flag) { debugOutput = flag; }
+void Logger::setDebugOutput(bool flag) {
+    if (flag && LOG_LEVEL > LOG_LEVEL_DEBUG)
+        Warn("Debug output is compiled out, rebuild with "
+             "SIMULATOR_LOG_LEVEL=DEBUG");
+    debugOutput = flag;
+}
 
 /**
  * @brief 是否开启信息输出
  *
  * @param flag
  */
-void Logger::setInfoOutput(bool flag) { infoOutput = flag; }
+void Logger::setInfoOutput(bool flag) {
+    if (flag && LOG_LEVEL > LOG_LEVEL_INFO)
+        Warn("Info output is compiled out, rebuild with "
+             "SIMULATOR_LOG_LEVEL=INFO");
+    infoOutput = flag;
+}
 
 /**
  * @brief 是否开启警告输出
@@ -28,39 +106,82 @@ void Logger::setInfoOutput(bool flag) { infoOutput = flag; }
 void Logger::setWarnOutput(bool flag) { warnOutput = flag; }
 
 /**
- * @brief 用于调试输出，格式与printf一样
+ * @brief 开启或关闭某一子系统的调试与信息输出
  *
- * @param format
- * @param ...
+ * @param category
+ * @param flag
  */
-void Logger::Debug(const char *format, ...) {
-    if (debugOutput) {
-        fprintf(stderr, "[  DEBUG  ] ");
-        va_list args;
-        va_start(args, format);
-        [[maybe_unused]] auto ret = vfprintf(stderr, format, args);
-        va_end(args);
-        fprintf(stderr, "\n");
-        fflush(stderr);
+void Logger::setCategoryOutput(LogCategory category, bool flag) {
+    auto bit = 1u << static_cast<unsigned>(category);
+    if (flag)
+        categoryMask |= bit;
+    else
+        categoryMask &= ~bit;
+}
+
+/**
+ * @brief 只开启列出的子系统的调试与信息输出，general 始终开启
+ *
+ * @param categories 以逗号分隔的子系统名，如 "cache,rob"
+ * @return true 解析成功
+ * @return false 存在无法识别的子系统名，输出设置保持不变
+ */
+bool Logger::setCategoryOutput(const char *categories) {
+    unsigned mask = 1u << static_cast<unsigned>(LogCategory::GENERAL);
+    while (*categories != '\0') {
+        auto length = strcspn(categories, ",");
+        unsigned id = 0;
+        while (id < static_cast<unsigned>(LogCategory::NUM_CATEGORIES) &&
+               (strlen(categoryNames[id]) != length ||
+                strncmp(categoryNames[id], categories, length) != 0))
+            id++;
+        if (id == static_cast<unsigned>(LogCategory::NUM_CATEGORIES)) {
+            Error("Unknown log category %.*s", static_cast<int>(length),
+                  categories);
+            return false;
+        }
+        mask |= 1u << id;
+        categories += length;
+        if (*categories == ',') categories++;
+    }
+    categoryMask = mask;
+    return true;
+}
+
+/**
+ * @brief 设置当前线程的输出目标，之前缓冲的日志先写出到原来的目标
+ *
+ * @param sink 已打开的文件，由调用者负责关闭
+ */
+void Logger::setThreadOutput(FILE *sink) {
+    flush();
+    logBuffer.sink = sink;
+}
+
+/**
+ * @brief 写出当前线程缓冲区中的日志
+ */
+void Logger::flush() {
+    auto &buffer = logBuffer;
+    if (buffer.used != 0) {
+        fwrite(buffer.data, 1, buffer.used, buffer.sink);
+        buffer.used = 0;
     }
+    fflush(buffer.sink);
 }
 
 /**
- * @brief 用于执行信息输出，格式与printf一样
+ * @brief 调试与信息输出的实现，日志先写入缓冲区
  *
+ * @param prefix
  * @param format
  * @param ...
  */
-void Logger::Info(const char *format, ...) {
-    if (infoOutput) {
-        fprintf(stderr, "[  INFO   ] ");
-        va_list args;
-        va_start(args, format);
-        [[maybe_unused]] auto ret = vfprintf(stderr, format, args);
-        va_end(args);
-        fprintf(stderr, "\n");
-        fflush(stderr);
-    }
+void Logger::write(const char *prefix, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    append(prefix, format, args);
+    va_end(args);
 }
 
 /**
@@ -70,14 +191,12 @@ void Logger::Info(const char *format, ...) {
  * @param ...
  */
 void Logger::Warn(const char *format, ...) {
-    if (warnOutput) {
-        fprintf(stderr, "[ WARNING ] ");
+    if (LOG_LEVEL <= LOG_LEVEL_WARN && warnOutput) {
         va_list args;
         va_start(args, format);
-        [[maybe_unused]] auto ret = vfprintf(stderr, format, args);
+        append("[ WARNING ] ", format, args);
         va_end(args);
-        fprintf(stderr, "\n");
-        fflush(stderr);
+        flush();
     }
 }
 
@@ -88,11 +207,9 @@ void Logger::Warn(const char *format, ...) {
  * @param ...
  */
 void Logger::Error(const char *format, ...) {
-    fprintf(stderr, "[  ERROR  ] ");
     va_list args;
     va_start(args, format);
-    [[maybe_unused]] auto ret = vfprintf(stderr, format, args);
+    append("[  ERROR  ] ", format, args);
     va_end(args);
-    fprintf(stderr, "\n");
-    fflush(stderr);
+    flush();
 }
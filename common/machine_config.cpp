@@ -0,0 +1,261 @@
+#include "machine_config.h"
+
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "instructions.h"
+#include "logger.h"
+
+namespace {
+
+const char *const processorTypeNames[] = {"normal", "predict", "cache"};
+const char *const replaceTypeNames[] = {"FIFO", "LRU", "RANDOM"};
+// 各执行单元周期数的键名，顺序与 FUType 相同
+const char *const fuLatencyKeys[] = {"core.alu_latency",
+                                     "core.bru_latency",
+                                     "core.lsu_latency",
+                                     "core.mul_latency",
+                                     "core.div_latency"};
+
+[[noreturn]] void invalidValue(const std::string &key,
+                               const std::string &value) {
+    Logger::Error("Bad value \"%s\" for machine configuration key %s",
+                  value.c_str(),
+                  key.c_str());
+    throw std::invalid_argument("Invalid machine configuration");
+}
+
+long parseInteger(const std::string &key, const std::string &value) {
+    size_t used = 0;
+    long result = 0;
+    try {
+        result = std::stol(value, &used, 0);
+    } catch (const std::exception &) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size()) invalidValue(key, value);
+    return result;
+}
+
+unsigned parseUnsigned(const std::string &key, const std::string &value) {
+    auto result = parseInteger(key, value);
+    if (result < 0 || result > UINT_MAX) invalidValue(key, value);
+    return (unsigned) result;
+}
+
+bool parseBool(const std::string &key, const std::string &value) {
+    if (value == "1" || value == "true" || value == "yes") return true;
+    if (value == "0" || value == "false" || value == "no") return false;
+    invalidValue(key, value);
+}
+
+template <typename T, size_t N>
+T parseName(const char *const (&names)[N],
+            const std::string &key,
+            const std::string &value) {
+    for (size_t i = 0; i < N; i++)
+        if (value == names[i]) return static_cast<T>(i);
+    invalidValue(key, value);
+}
+
+std::string trim(const std::string &x) {
+    auto begin = x.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    auto end = x.find_last_not_of(" \t\r");
+    return x.substr(begin, end - begin + 1);
+}
+
+bool isPowerOfTwo(unsigned x) { return x != 0 && (x & (x - 1)) == 0; }
+
+}  // namespace
+
+MachineConfig::MachineConfig() {
+    for (unsigned i = 0; i < fuLatency.size(); i++)
+        fuLatency[i] = getFULatency(static_cast<FUType>(i));
+}
+
+/**
+ * @brief 设置一项配置，键名为 节名.键名
+ * core: type（normal、predict、cache）、rob_size、rs_size、btb_size、
+ * alu_latency、bru_latency、lsu_latency、mul_latency、div_latency，
+ * 以及按 ALU、BRU、LSU、MUL、DIV 顺序以逗号分隔的 fu_latency；
+ * memory: latency、seed；
+ * cache: size、block_size、associativity、write_through（0 或 1）、
+ * replace（FIFO、LRU、RANDOM）、max_size
+ *
+ * @param key
+ * @param value
+ */
+void MachineConfig::set(const std::string &key, const std::string &value) {
+    if (key == "core.type") {
+        type = parseName<ProcessorType>(processorTypeNames, key, value);
+    } else if (key == "core.rob_size") {
+        robSize = parseUnsigned(key, value);
+    } else if (key == "core.rs_size") {
+        rsSize = parseUnsigned(key, value);
+    } else if (key == "core.btb_size") {
+        btbSize = parseUnsigned(key, value);
+    } else if (key == "core.fu_latency") {
+        std::stringstream ss(value);
+        std::string x;
+        unsigned i = 0;
+        for (; std::getline(ss, x, ','); i++) {
+            if (i == fuLatency.size()) invalidValue(key, value);
+            fuLatency[i] = parseUnsigned(key, trim(x));
+        }
+        if (i != fuLatency.size()) invalidValue(key, value);
+    } else if (key == "memory.latency") {
+        latency = parseUnsigned(key, value);
+    } else if (key == "memory.seed") {
+        auto x = parseInteger(key, value);
+        if (x < INT_MIN || x > INT_MAX) invalidValue(key, value);
+        seed = (int) x;
+    } else if (key == "cache.size") {
+        cacheSize = parseUnsigned(key, value);
+    } else if (key == "cache.block_size") {
+        blockSize = parseUnsigned(key, value);
+    } else if (key == "cache.associativity") {
+        associativity = parseUnsigned(key, value);
+    } else if (key == "cache.write_through") {
+        writeThrough = parseBool(key, value);
+    } else if (key == "cache.replace") {
+        replaceType = parseName<ReplaceType>(replaceTypeNames, key, value);
+    } else if (key == "cache.max_size") {
+        maxCacheSize = parseUnsigned(key, value);
+    } else {
+        for (unsigned i = 0; i < fuLatency.size(); i++) {
+            if (key != fuLatencyKeys[i]) continue;
+            fuLatency[i] = parseUnsigned(key, value);
+            return;
+        }
+        Logger::Error("Unknown machine configuration key %s", key.c_str());
+        throw std::invalid_argument("Invalid machine configuration");
+    }
+}
+
+/**
+ * @brief 检查配置能否实例化，不报错，供需要跳过无效配置的调用者使用
+ * Cache 按地址的低位选择组，因此组数与块大小须为 2 的幂；
+ * BTB 同样按 pc 的低位索引
+ *
+ * @return const char* 不能实例化的原因，能实例化时为 nullptr
+ */
+const char *MachineConfig::invalidReason() const {
+    if (robSize == 0) return "rob_size must be positive";
+    if (rsSize == 0) return "rs_size must be positive";
+    if (!isPowerOfTwo(btbSize)) return "btb_size must be a power of two";
+    for (auto x : fuLatency)
+        if (x == 0) return "FU latencies must be positive";
+    if (!isPowerOfTwo(blockSize) || blockSize < 4)
+        return "cache block_size must be a power of two of at least 4 bytes";
+    if (associativity == 0) return "cache associativity must be positive";
+    if (cacheSize % (blockSize * associativity) != 0 ||
+        !isPowerOfTwo(cacheSize / blockSize / associativity))
+        return "cache set count must be a power of two";
+    if (cacheSize > maxCacheSize) return "cache size exceeds max_size";
+    return nullptr;
+}
+
+/**
+ * @brief 检查配置能否实例化，不能时报错并抛出异常
+ */
+void MachineConfig::validate() const {
+    auto reason = invalidReason();
+    if (reason == nullptr) return;
+    Logger::Error("Invalid machine configuration: %s", reason);
+    throw std::invalid_argument("Invalid machine configuration");
+}
+
+/**
+ * @brief 以配置文件的格式输出全部配置项，读回后得到相同的配置
+ *
+ * @return std::string
+ */
+std::string MachineConfig::toString() const {
+    std::stringstream ss;
+    ss << "[core]\n"
+       << "type = " << getProcessorTypeName(type) << '\n'
+       << "rob_size = " << robSize << '\n'
+       << "rs_size = " << rsSize << '\n'
+       << "btb_size = " << btbSize << '\n';
+    for (unsigned i = 0; i < fuLatency.size(); i++)
+        ss << std::string(fuLatencyKeys[i]).substr(5) << " = "
+           << fuLatency[i] << '\n';
+    ss << "\n[memory]\n"
+       << "latency = " << latency << '\n'
+       << "seed = " << seed << '\n'
+       << "\n[cache]\n"
+       << "size = " << cacheSize << '\n'
+       << "block_size = " << blockSize << '\n'
+       << "associativity = " << associativity << '\n'
+       << "write_through = " << writeThrough << '\n'
+       << "replace = " << getReplaceTypeName(replaceType) << '\n'
+       << "max_size = " << maxCacheSize << '\n';
+    return ss.str();
+}
+
+/**
+ * @brief 在结果之前输出完整的机器配置，每行以 [ MACHINE ] 开头
+ * 与测试结果一样直接写到 stderr，不受警告输出开关的影响，
+ * 保存下来的结果总能对应到产生它的配置
+ *
+ * @param config 运行使用的配置
+ */
+void printMachineConfig(const MachineConfig &config) {
+    std::stringstream ss(config.toString());
+    std::string line;
+    while (std::getline(ss, line))
+        if (!line.empty()) fprintf(stderr, "[ MACHINE ] %s\n", line.c_str());
+}
+
+const char *getProcessorTypeName(ProcessorType type) {
+    return processorTypeNames[static_cast<int>(type)];
+}
+
+const char *getReplaceTypeName(ReplaceType type) {
+    return replaceTypeNames[static_cast<int>(type)];
+}
+
+/**
+ * @brief 读取 INI 格式的机器配置文件，读取后检查配置能否实例化
+ *
+ * @param fileName
+ * @return MachineConfig
+ */
+MachineConfig readMachineConfig(const std::string &fileName) {
+    std::ifstream in(fileName);
+    if (!in) {
+        Logger::Error("Cannot open machine configuration %s",
+                      fileName.c_str());
+        throw std::runtime_error("Cannot open machine configuration");
+    }
+    MachineConfig config;
+    std::string section, text;
+    for (unsigned line = 1; std::getline(in, text); line++) {
+        text = trim(text.substr(0, text.find_first_of("#;")));
+        if (text.empty()) continue;
+        if (text.front() == '[' && text.back() == ']') {
+            section = trim(text.substr(1, text.size() - 2));
+            continue;
+        }
+        auto split = text.find('=');
+        if (split == std::string::npos || section.empty()) {
+            Logger::Error("%s line %u: expected key = value in a section",
+                          fileName.c_str(),
+                          line);
+            throw std::invalid_argument("Invalid machine configuration");
+        }
+        try {
+            config.set(section + "." + trim(text.substr(0, split)),
+                       trim(text.substr(split + 1)));
+        } catch (const std::invalid_argument &) {
+            Logger::Error("In %s line %u", fileName.c_str(), line);
+            throw;
+        }
+    }
+    config.validate();
+    return config;
+}
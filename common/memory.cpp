@@ -1,23 +1,35 @@
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <optional>
+#include <sstream>
+#include <stdexcept>
 
+#include "checkpoint.h"
 #include "defines.h"
 #include "logger.h"
 #include "mem.h"
+#include "trace.h"
 
-Memory::Memory(unsigned latency, int seed)
-    : latency(latency), engine(seed), generator(-1, 1) {
-    data = new unsigned int[DATA_MEM_SIZE >> 2u];
-    memset(data, 0, DATA_MEM_SIZE);
+namespace {
+
+// 所有未分配的页共享的全零页
+const unsigned zeroPage[MEMORY_PAGE_WORDS] = {};
+
+}  // namespace
 
+Memory::Memory(unsigned latency, int seed)
+    : pages(DATA_MEM_SIZE / MEMORY_PAGE_SIZE, zeroPage),
+      storage(DATA_MEM_SIZE / MEMORY_PAGE_SIZE),
+      latency(latency),
+      engine(seed),
+      generator(-1, 1) {
     saveAddress = 0xFFFFFFFFu;
     saveWriteFlag = false;
     remainingTime = 0;
+    activity = 0;
 }
 
-Memory::~Memory() { delete[] data; }
-
 /**
  * @brief 主存功能性写入，仅用于初始化和验证用
  * @warning 实际验收时，这个函数会进行加密（异或一个 magic number 等）
@@ -29,7 +41,7 @@ void Memory::functionalWrite(unsigned int address,
                              std::vector<unsigned int> data) {
     for (unsigned i = 0; i < data.size() && address + i < (DATA_MEM_SIZE >> 2u);
          i++)
-        this->data[address + i] = data[i];
+        store(address + i, data[i]);
 }
 
 /**
@@ -45,7 +57,7 @@ std::vector<unsigned> Memory::functionalRead(unsigned int address,
     std::vector<unsigned> ret;
     for (unsigned i = 0; i < length; i++) {
         if (address + i < (DATA_MEM_SIZE >> 2u)) {
-            ret.push_back(data[address + i]);
+            ret.push_back(load(address + i));
         } else {
             ret.push_back(0u);
         }
@@ -68,7 +80,7 @@ std::optional<unsigned> Memory::read(unsigned address) {
 
     if (remainingTime != 0) {
         if (saveAddress != address || saveWriteFlag) {
-            Logger::Info(
+            Logger::Info<LogCategory::MEMORY>(
                 "Currently running another request: address = 0x%08x, "
                 "writeFlag = %d",
                 saveAddress,
@@ -78,35 +90,43 @@ std::optional<unsigned> Memory::read(unsigned address) {
 
         remainingTime--;
 
-        Logger::Info("Read Remaining time = %d", remainingTime);
+        Logger::Info<LogCategory::MEMORY>(
+            "Read Remaining time = %d", remainingTime);
 
         if (remainingTime == 0) {
-            Logger::Info(
-                "Reading Memory 0x%08x, data = %d", address, data[address]);
+            activity++;
+            Logger::Info<LogCategory::MEMORY>(
+                "Reading Memory 0x%08x, data = %d", address, load(address));
+            Tracer::recordAccess(
+                TraceEvent::MEMORY_READ, address, load(address));
         }
 
-        return remainingTime == 0 ? std::make_optional(data[address])
+        return remainingTime == 0 ? std::make_optional(load(address))
                                   : std::nullopt;
     }
 
     if (address == saveAddress || address == saveAddress + 1) {
         saveAddress = address;
-        Logger::Info(
-            "Reading Memory 0x%08x, data = %d", address, data[address]);
+        activity++;
+        Logger::Info<LogCategory::MEMORY>(
+            "Reading Memory 0x%08x, data = %d", address, load(address));
+        Tracer::recordAccess(TraceEvent::MEMORY_READ, address, load(address));
         // continuous access or repetitive access
-        return std::make_optional(data[address]);
+        return std::make_optional(load(address));
     }
 
     saveAddress = address;
     saveWriteFlag = false;
     remainingTime = std::max(0, generator(engine) + (int) latency - 1);
+    activity++;
 
     if (remainingTime == 0) {
-        Logger::Info(
-            "Reading Memory 0x%08x, data = %d", address, data[address]);
+        Logger::Info<LogCategory::MEMORY>(
+            "Reading Memory 0x%08x, data = %d", address, load(address));
+        Tracer::recordAccess(TraceEvent::MEMORY_READ, address, load(address));
     }
 
-    return remainingTime == 0 ? std::make_optional(data[address])
+    return remainingTime == 0 ? std::make_optional(load(address))
                               : std::nullopt;
 }
 
@@ -133,19 +153,21 @@ bool Memory::write(unsigned address, unsigned data, unsigned byteEnable) {
         remainingTime--;
 
         if (remainingTime == 0) {
+            activity++;
             unsigned result = 0;
             for (unsigned i = 0; i < 4; i++) {
                 if (byteEnable & (1u << i)) {
                     result |= ((data >> (i * 8u)) & 0xffu) << (i * 8u);
                 } else {
-                    result |= (((this->data[address]) >> (i * 8u)) & 0xffu)
-                              << (i * 8u);
+                    result |= ((load(address) >> (i * 8u)) & 0xffu) << (i * 8u);
                 }
             }
-            this->data[address] = result;
+            store(address, result);
         }
         if (remainingTime == 0) {
-            Logger::Info("Writing Memory 0x%08x, data = %d", address, data);
+            Logger::Info<LogCategory::MEMORY>(
+                "Writing Memory 0x%08x, data = %d", address, data);
+            Tracer::recordAccess(TraceEvent::MEMORY_WRITE, address, data);
         }
         return remainingTime == 0;
     }
@@ -154,6 +176,7 @@ bool Memory::write(unsigned address, unsigned data, unsigned byteEnable) {
     saveWriteFlag = true;
 
     remainingTime = std::max(0, generator(engine) + (int) latency - 1);
+    activity++;
 
     if (remainingTime == 0) {
         unsigned result = 0;
@@ -161,14 +184,15 @@ bool Memory::write(unsigned address, unsigned data, unsigned byteEnable) {
             if (byteEnable & (1u << i)) {
                 result |= ((data >> (i * 8u)) & 0xffu) << (i * 8u);
             } else {
-                result |= (((this->data[address]) >> (i * 8u)) & 0xffu)
-                          << (i * 8u);
+                result |= ((load(address) >> (i * 8u)) & 0xffu) << (i * 8u);
             }
         }
-        this->data[address] = result;
+        store(address, result);
     }
     if (remainingTime == 0) {
-        Logger::Info("Writing Memory 0x%08x, data = %d", address, data);
+        Logger::Info<LogCategory::MEMORY>(
+            "Writing Memory 0x%08x, data = %d", address, data);
+        Tracer::recordAccess(TraceEvent::MEMORY_WRITE, address, data);
     }
     return remainingTime == 0;
 }
@@ -178,3 +202,167 @@ bool Memory::write(unsigned address, unsigned data, unsigned byteEnable) {
  * 
  */
 void Memory::resetState() { remainingTime = 0; }
+
+/**
+ * @brief 让页表直接指向程序映像的数据区，装载时只复制不满一页的结尾
+ * 映像之外的页指向全零页，之前分配的页全部释放
+ *
+ * @param image 程序映像
+ */
+void Memory::mapImage(const ProgramImagePtr &image) {
+    discardSnapshot();
+    this->image = image;
+    const auto &data = image->data;
+    for (unsigned page = 0; page < pages.size(); page++) {
+        unsigned long offset = (unsigned long) page * MEMORY_PAGE_WORDS;
+        storage[page].reset();
+        if (offset + MEMORY_PAGE_WORDS <= data.size()) {
+            pages[page] = data.data() + offset;
+        } else if (offset < data.size()) {
+            storage[page].reset(new unsigned[MEMORY_PAGE_WORDS]());
+            std::copy(data.begin() + offset, data.end(), storage[page].get());
+            pages[page] = storage[page].get();
+        } else {
+            pages[page] = zeroPage;
+        }
+    }
+}
+
+/**
+ * @brief 以另一主存的当前内容替换全部内容
+ * 未写入过的页引用全零页或程序映像，只共享引用；写入过的页复制到本主存，
+ * 已分配的缓冲区被重用。访存时序状态不变
+ *
+ * @param other 内容的来源，通常是功能模型的数据内存
+ */
+void Memory::copyPagesFrom(const Memory &other) {
+    discardSnapshot();
+    image = other.image;
+    for (unsigned page = 0; page < pages.size(); page++) {
+        if (!other.storage[page]) {
+            storage[page].reset();
+            pages[page] = other.pages[page];
+            continue;
+        }
+        if (!storage[page])
+            storage[page].reset(new unsigned[MEMORY_PAGE_WORDS]);
+        memcpy(storage[page].get(),
+               other.storage[page].get(),
+               MEMORY_PAGE_SIZE);
+        pages[page] = storage[page].get();
+    }
+}
+
+/**
+ * @brief 以当前内容建立快照
+ * 之后每一页第一次被写入时先保存原有内容，已有的快照被丢弃
+ *
+ */
+void Memory::takeSnapshot() {
+    discardSnapshot();
+    snapshotPages.resize(DATA_MEM_SIZE / MEMORY_PAGE_SIZE);
+    pagePreserved.assign(snapshotPages.size(), false);
+    snapshotEngine = engine;
+    snapshotSaveAddress = saveAddress;
+    snapshotSaveWriteFlag = saveWriteFlag;
+    snapshot = true;
+}
+
+/**
+ * @brief 把建立快照之后写入过的页与访存时序状态恢复为快照时的状态，
+ * 快照继续保留
+ *
+ */
+void Memory::restoreSnapshot() {
+    for (unsigned page : dirtyPages) {
+        memcpy(storage[page].get(),
+               snapshotPages[page].get(),
+               MEMORY_PAGE_SIZE);
+        pagePreserved[page] = false;
+    }
+    dirtyPages.clear();
+    engine = snapshotEngine;
+    saveAddress = snapshotSaveAddress;
+    saveWriteFlag = snapshotSaveWriteFlag;
+    remainingTime = 0;
+}
+
+void Memory::discardSnapshot() {
+    snapshotPages.clear();
+    pagePreserved.clear();
+    dirtyPages.clear();
+    snapshot = false;
+}
+
+/**
+ * @brief 为第一次被改写的页分配空间，复制原先引用的内容
+ *
+ * @param page 页号
+ */
+void Memory::allocatePage(unsigned page) {
+    storage[page].reset(new unsigned[MEMORY_PAGE_WORDS]);
+    memcpy(storage[page].get(), pages[page], MEMORY_PAGE_SIZE);
+    pages[page] = storage[page].get();
+}
+
+void Memory::preservePage(unsigned page) {
+    if (!snapshotPages[page])
+        snapshotPages[page].reset(new unsigned[MEMORY_PAGE_WORDS]);
+    pagePreserved[page] = true;
+    memcpy(snapshotPages[page].get(), storage[page].get(), MEMORY_PAGE_SIZE);
+    dirtyPages.push_back(page);
+}
+
+/**
+ * @brief 保存主存内容与当前请求的状态
+ * 全零的页省略，随机延迟发生器的状态以文本形式保存
+ *
+ * @param out 检查点
+ */
+void Memory::save(CheckpointWriter &out) const {
+    out.writeTag("MEM ");
+    out.write(latency);
+    for (unsigned page = 0; page < pages.size(); page++) {
+        auto begin = pages[page], end = begin + MEMORY_PAGE_WORDS;
+        if (std::all_of(begin, end, [](unsigned x) { return x == 0; }))
+            continue;
+        out.write(page);
+        out.writeBytes(begin, MEMORY_PAGE_SIZE);
+    }
+    out.write(-1u);
+
+    out.write(saveAddress);
+    out.write(saveWriteFlag);
+    out.write(remainingTime);
+    std::stringstream ss;
+    ss << engine;
+    out.write(ss.str());
+}
+
+void Memory::restore(CheckpointReader &in) {
+    in.expectTag("MEM ");
+    in.expect(latency, "memory latency");
+    discardSnapshot();
+    image.reset();
+    std::fill(pages.begin(), pages.end(), zeroPage);
+    for (auto &page : storage) page.reset();
+    for (;;) {
+        unsigned page;
+        in.read(page);
+        if (page == -1u) break;
+        if (page >= pages.size()) {
+            Logger::Error("Invalid memory page %u in checkpoint", page);
+            throw std::runtime_error("Invalid checkpoint");
+        }
+        allocatePage(page);
+        in.readBytes(storage[page].get(), MEMORY_PAGE_SIZE);
+    }
+
+    in.read(saveAddress);
+    in.read(saveWriteFlag);
+    in.read(remainingTime);
+    std::string state;
+    in.read(state);
+    std::stringstream ss(state);
+    ss >> engine;
+}
@@ -0,0 +1,288 @@
+#include "program_image.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "defines.h"
+#include "elf.h"
+#include "logger.h"
+
+namespace {
+
+constexpr unsigned TEXT_BASE = 0x80000000u;
+constexpr unsigned DATA_BASE = 0x80400000u;
+
+// 缓存的映像以及读取时文件的修改时间与大小
+struct CachedImage {
+    struct timespec mtime;
+    off_t size;
+    ProgramImagePtr image;
+};
+
+std::mutex cacheMutex;
+std::unordered_map<std::string, CachedImage> imageCache;
+
+// 只读映射的 elf 文件，访问前检查范围，文件损坏时报错
+class ElfFile {
+    const std::string &name;
+    const unsigned char *base = nullptr;
+    size_t length = 0;
+
+public:
+    ElfFile(const std::string &name, size_t length);
+    ~ElfFile() {
+        if (base != nullptr) munmap((void *) base, length);
+    }
+    ElfFile(const ElfFile &) = delete;
+    ElfFile &operator=(const ElfFile &) = delete;
+
+    template <typename T>
+    const T *at(unsigned long offset, unsigned long count = 1) const {
+        if (offset > length || count > (length - offset) / sizeof(T))
+            invalid("section or segment exceeds file");
+        return reinterpret_cast<const T *>(base + offset);
+    }
+
+    [[noreturn]] void invalid(const char *reason) const {
+        Logger::Error("%s: %s", name.c_str(), reason);
+        throw std::invalid_argument("Invalid elf file");
+    }
+};
+
+ElfFile::ElfFile(const std::string &name, size_t length)
+    : name(name), length(length) {
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::Error("Cannot open elf file %s", name.c_str());
+        throw std::runtime_error("Cannot open elf file");
+    }
+    void *p = length == 0
+                  ? MAP_FAILED
+                  : mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) invalid("cannot map file");
+    base = static_cast<const unsigned char *>(p);
+}
+
+/**
+ * @brief 把一个段复制到指令区或数据区，区域按需扩展
+ *
+ * @param target 指令区或数据区
+ * @param offset 段相对区域起点的字节偏移
+ * @param source 段在文件中的内容
+ * @param size 段在文件中的字节数
+ */
+void copySegment(std::vector<unsigned> &target,
+                 unsigned offset,
+                 const unsigned char *source,
+                 unsigned size) {
+    unsigned long words = ((unsigned long) offset + size + 3) >> 2u;
+    if (target.size() < words) target.resize(words, 0u);
+    memcpy(reinterpret_cast<unsigned char *>(target.data()) + offset,
+           source,
+           size);
+}
+
+void predecodeText(ProgramImage &image) {
+    image.decoded.reserve(image.text.size() + 1);
+    for (unsigned x : image.text)
+        image.decoded.push_back(Instruction::predecode(x));
+    image.decoded.push_back(Instruction::predecode(0x0000000b));
+}
+
+/**
+ * @brief 读取 .symtab，去掉节与文件名符号后按地址排序
+ *
+ * @param elf elf 文件
+ * @param ehdr 文件头
+ * @param symbols 读出的符号
+ */
+void readSymbols(const ElfFile &elf,
+                 const elf32_ehdr &ehdr,
+                 std::vector<ProgramSymbol> &symbols) {
+    if (ehdr.e_shnum == 0) return;
+    auto sections = elf.at<elf32_shdr>(ehdr.e_shoff, ehdr.e_shnum);
+    for (unsigned i = 0; i < ehdr.e_shnum; i++) {
+        if (sections[i].sh_type != SHT_SYMTAB) continue;
+        if (sections[i].sh_link >= ehdr.e_shnum)
+            elf.invalid("symbol table has no string table");
+        const auto &strtab = sections[sections[i].sh_link];
+        auto names = elf.at<char>(strtab.sh_offset, strtab.sh_size);
+        unsigned count = sections[i].sh_size / sizeof(elf32_sym);
+        auto entries = elf.at<elf32_sym>(sections[i].sh_offset, count);
+        // 0 号符号保留
+        for (unsigned j = 1; j < count; j++) {
+            const auto &x = entries[j];
+            unsigned char type = x.st_info & 0xfu;
+            if (type == STT_SECTION || type == STT_FILE) continue;
+            if (x.st_name >= strtab.sh_size) elf.invalid("bad symbol name");
+            const char *name = names + x.st_name;
+            auto length = strnlen(name, strtab.sh_size - x.st_name);
+            if (length == 0) continue;
+            symbols.push_back({std::string(name, length),
+                               x.st_value,
+                               x.st_size,
+                               type,
+                               (unsigned char) (x.st_info >> 4u)});
+        }
+    }
+    std::stable_sort(symbols.begin(),
+                     symbols.end(),
+                     [](const ProgramSymbol &a, const ProgramSymbol &b) {
+                         return a.value < b.value;
+                     });
+}
+
+/**
+ * @brief 映射 elf 并按 PT_LOAD 段构造程序映像
+ * 0x80000000 开始的段进入指令区，0x80400000 开始的段进入数据区，
+ * 数据段超出文件内容的部分（.bss）不占用空间，装载后读作 0
+ *
+ * @param name elf 路径
+ * @param length 文件大小
+ * @return ProgramImagePtr
+ */
+ProgramImagePtr loadElfImage(const std::string &name, size_t length) {
+    fprintf(stderr, "[  INFO   ] Reading ELF file %s\n", name.c_str());
+
+    ElfFile elf(name, length);
+    const auto &ehdr = *elf.at<elf32_ehdr>(0);
+    if (ehdr.e_ident[0] != ELF_MAGIC) {
+        throw std::invalid_argument(
+            "No valid elf magic found, please check input file's "
+            "type.");
+    }
+    if (ehdr.e_machine != EM_RISCV) {
+        throw std::invalid_argument(
+            "Elf is not for RISCV, please check input file and "
+            "compiler.");
+    }
+    if (ehdr.e_phnum != 0 && ehdr.e_phentsize != sizeof(elf32_phdr))
+        elf.invalid("unexpected program header size");
+
+    auto image = std::make_shared<ProgramImage>();
+    image->entry = ehdr.e_entry;
+    auto segments = elf.at<elf32_phdr>(ehdr.e_phoff, ehdr.e_phnum);
+    for (unsigned i = 0; i < ehdr.e_phnum; i++) {
+        const auto &x = segments[i];
+        if (x.p_type != PT_LOAD) continue;
+        Logger::Info("Segment [%2u]: ADDR: 0x%08x OFFSET: %u FILE: %u MEM: %u",
+                     i,
+                     x.p_vaddr,
+                     x.p_offset,
+                     x.p_filesz,
+                     x.p_memsz);
+        if (x.p_filesz > x.p_memsz) elf.invalid("segment larger than memory");
+        auto source = elf.at<unsigned char>(x.p_offset, x.p_filesz);
+
+        unsigned long end = (unsigned long) x.p_vaddr + x.p_memsz;
+        if (x.p_vaddr >= TEXT_BASE && x.p_vaddr < DATA_BASE) {
+            if (end > DATA_BASE) elf.invalid("text segment overflows");
+            copySegment(image->text, x.p_vaddr - TEXT_BASE, source, x.p_filesz);
+            // 指令区中的 .bss 与原先一样按 0 填充到段尾
+            image->text.resize(
+                std::max(image->text.size(), (end - TEXT_BASE + 3) >> 2u), 0u);
+        } else if (x.p_vaddr >= DATA_BASE &&
+                   x.p_vaddr < DATA_BASE + DATA_MEM_SIZE) {
+            if (end > DATA_BASE + DATA_MEM_SIZE)
+                elf.invalid("data segment overflows");
+            copySegment(image->data, x.p_vaddr - DATA_BASE, source, x.p_filesz);
+        }
+    }
+    Logger::Info("instruction words = %lu, data words = %lu",
+                 image->text.size(),
+                 image->data.size());
+
+    predecodeText(*image);
+    readSymbols(elf, ehdr, image->symbols);
+    return image;
+}
+
+}  // namespace
+
+/**
+ * @brief 按名称查找符号
+ *
+ * @param name 符号名
+ * @return const ProgramSymbol* 不存在时为 nullptr
+ */
+const ProgramSymbol *ProgramImage::findSymbol(const std::string &name) const {
+    for (const auto &x : symbols)
+        if (x.name == name) return &x;
+    return nullptr;
+}
+
+/**
+ * @brief 查找地址所在的符号，即地址不大于 address 的最后一个符号
+ * 大小非零的符号要求 address 落在其范围内
+ *
+ * @param address 地址
+ * @return const ProgramSymbol* 不存在时为 nullptr
+ */
+const ProgramSymbol *ProgramImage::symbolAt(unsigned address) const {
+    auto it = std::upper_bound(
+        symbols.begin(),
+        symbols.end(),
+        address,
+        [](unsigned x, const ProgramSymbol &s) { return x < s.value; });
+    if (it == symbols.begin()) return nullptr;
+    --it;
+    if (it->size != 0 && address - it->value >= it->size) return nullptr;
+    return &*it;
+}
+
+/**
+ * @brief 由指令区与数据区构造程序映像，并对指令区预译码
+ *
+ * @param text 从 0x80000000 开始的指令区
+ * @param data 从 0x80400000 开始的数据区
+ * @param entry 程序入口
+ * @return ProgramImagePtr
+ */
+ProgramImagePtr makeProgramImage(const std::vector<unsigned> &text,
+                                 const std::vector<unsigned> &data,
+                                 unsigned entry) {
+    auto image = std::make_shared<ProgramImage>();
+    image->text = text;
+    predecodeText(*image);
+    image->data.assign(
+        data.begin(),
+        data.begin() + std::min<size_t>(data.size(), DATA_MEM_SIZE >> 2u));
+    image->entry = entry;
+    return image;
+}
+
+/**
+ * @brief 读取 elf 并构造程序映像
+ * 路径、修改时间与大小都未变时复用之前的映像，不再读取文件内容
+ *
+ * @param name elf 路径
+ * @return ProgramImagePtr
+ */
+ProgramImagePtr readProgramImage(const std::string &name) {
+    struct stat status {};
+    if (stat(name.c_str(), &status) != 0) {
+        Logger::Error("Cannot open elf file %s", name.c_str());
+        throw std::runtime_error("Cannot open elf file");
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = imageCache.find(name);
+    if (it != imageCache.end() &&
+        it->second.mtime.tv_sec == status.st_mtim.tv_sec &&
+        it->second.mtime.tv_nsec == status.st_mtim.tv_nsec &&
+        it->second.size == status.st_size)
+        return it->second.image;
+
+    auto image = loadElfImage(name, status.st_size);
+    imageCache[name] = {status.st_mtim, status.st_size, image};
+    return image;
+}
@@ -2,6 +2,8 @@
 
 #include <cstring>
 
+#include "checkpoint.h"
+
 RegisterFile::RegisterFile() {
     for (unsigned int &i : reg) i = 0;
     reg[2] = 0x80800000;  // initialize sp
@@ -78,3 +80,17 @@ void RegisterFile::reset() {
     reg[3] = 0x80400000;  // initialize gp
     memset(busy, false, sizeof(busy));
 }
+
+void RegisterFile::save(CheckpointWriter &out) const {
+    out.writeTag("REGS");
+    out.writeBytes(reg, sizeof(reg));
+    out.writeBytes(busy, sizeof(busy));
+    out.writeBytes(robIndices, sizeof(robIndices));
+}
+
+void RegisterFile::restore(CheckpointReader &in) {
+    in.expectTag("REGS");
+    in.readBytes(reg, sizeof(reg));
+    in.readBytes(busy, sizeof(busy));
+    in.readBytes(robIndices, sizeof(robIndices));
+}
@@ -1,11 +1,112 @@
 #include "runner.h"
 
 #include <cstdarg>
+#include <string>
+#include <vector>
 
 #include "defines.h"
 #include "logger.h"
 #include "processor.h"
 #include "with_cache.h"
+#include "with_predict.h"
+
+namespace {
+
+/**
+ * @brief 装载 elf，同一 CPU 再次执行同一程序时直接恢复装载完成时的快照
+ * readProgramImage 检查 elf 的修改时间与大小，文件改变后返回新的映像，
+ * 不会恢复旧程序的快照。参数写在快照之后，因此每次执行都可以使用不同的参数
+ *
+ * @param p CPU
+ * @param name elf 路径
+ */
+void loadProgram(ProcessorAbstract *p, const std::string &name) {
+    auto image = readProgramImage(name);
+    if (p->restoreProgram(image)) return;
+
+    p->loadImage(image);
+    p->snapshotProgram(image);
+}
+
+/**
+ * @brief 把参数写入 0x807fff00 开始的连续地址，并在一行日志中列出
+ *
+ * @param p CPU
+ * @param name elf 路径
+ * @param args 4字节整型参数
+ */
+void writeArguments(ProcessorAbstract *p,
+                    const std::string &name,
+                    const std::vector<int> &args) {
+    std::string list;
+    for (unsigned i = 0; i < args.size(); i++) {
+        list += (i == 0 ? "" : " ") + std::to_string(args[i]);
+        p->writeMem(0x807fff00 + (i << 2u), args[i]);
+    }
+    Logger::Warn("Running %s with following arguments: %s",
+                 name.c_str(),
+                 list.c_str());
+}
+
+std::vector<int> collectArguments(int argc, va_list args) {
+    std::vector<int> result(argc);
+    for (int &x : result) x = va_arg(args, int);
+    return result;
+}
+
+}  // namespace
+
+/**
+ * @brief 所有执行方式共用的主循环，执行到程序结束或周期数达到上限
+ * 上限每 limitInterval 个周期重新读取一次，因此可以在运行过程中收紧；
+ * 跳过空闲周期时至多跳到上限，停止时的周期数不会越过上限。
+ * 周期数首次达到 checkpointCycle 时保存检查点，跳过空闲周期可能越过
+ * checkpointCycle，此时在之后最近的周期保存
+ *
+ * @param p CPU
+ * @param counter 已经执行的周期数
+ * @param finished 程序执行结束时为 true，达到上限停止时为 false
+ * @param limit 返回当前的周期上限，为空时不限制
+ * @param checkpoint 检查点路径，为空时不保存
+ * @param checkpointCycle 保存检查点的周期
+ * @return unsigned long 包含 counter 在内的总周期数
+ */
+unsigned long runUntil(ProcessorAbstract *p,
+                       unsigned long counter,
+                       bool &finished,
+                       const std::function<unsigned long()> &limit,
+                       const std::string &checkpoint,
+                       unsigned long checkpointCycle) {
+    constexpr unsigned long limitInterval = 16384;
+    unsigned long nextReport = counter - counter % 50000 + 50000;
+    unsigned long nextCheck = counter - counter % limitInterval + limitInterval;
+    unsigned long bound = limit ? limit() : -1ul;
+    bool saved = checkpoint.empty();
+
+    finished = false;
+    while (!finished && counter < bound) {
+        if (!saved && counter >= checkpointCycle) {
+            p->saveCheckpoint(checkpoint, counter);
+            saved = true;
+        }
+        finished = p->step();
+        counter++;
+        if (!finished) counter += p->skipIdleCycles(bound - counter);
+        if (counter >= nextReport) {
+            Logger::Warn("Running %lu cycles.", counter);
+            nextReport = counter - counter % 50000 + 50000;
+        }
+        if (limit && counter >= nextCheck) {
+            bound = limit();
+            nextCheck = counter - counter % limitInterval + limitInterval;
+        }
+    }
+
+    if (!saved && finished)
+        Logger::Warn("Program finished before cycle %lu, no checkpoint saved",
+                     checkpointCycle);
+    return counter;
+}
 
 /**
  * @brief 让 CPU 执行指定 elf，并传入参数，参数只能是 int 或 unsigned 类型
@@ -22,34 +123,29 @@
 unsigned execute(ProcessorAbstract *p, const std::string &name, int argc, ...) {
     va_list args;
     va_start(args, argc);
+    auto list = collectArguments(argc, args);
+    va_end(args);
+    return execute(p, name, list);
+}
 
-    std::vector<unsigned> inst, data;
-
-    unsigned entry = readElf(name, inst, data);
-
-    p->loadProgram(inst, data, entry);
+/**
+ * @brief 与 execute 相同，参数以数组给出，供批量运行等非可变参数的调用者使用
+ *
+ * @param p CPU
+ * @param name elf 路径
+ * @param args 4字节整型参数
+ * @return unsigned CPU 以该参数执行 elf 使用的时钟周期数
+ */
+unsigned execute(ProcessorAbstract *p,
+                 const std::string &name,
+                 const std::vector<int> &args) {
+    loadProgram(p, name);
     p->writeReg(11, 0x807fff00);
 
-    Logger::Warn("Running %s with following arguments: ", name.c_str());
-
-    for (int i = 0; i < argc; i++) {
-        int x = va_arg(args, int);
-        fprintf(stderr, "%d%c", x, " \n"[i == argc - 1]);
-        p->writeMem(0x807fff00 + (i << 2u), x);
-    }
-
-    unsigned counter = 0;
-
-    bool finish = false;
-    do {
-        finish = p->step();
-        counter++;
-        if (counter % 50000 == 0) {
-            Logger::Warn("Running %u cycles.", counter);
-        }
-    } while (!finish);
+    writeArguments(p, name, args);
 
-    return counter;
+    bool finished = false;
+    return runUntil(p, 0, finished);
 }
 
 unsigned executeWithCache(ProcessorWithCache *p,
@@ -60,35 +156,115 @@ unsigned executeWithCache(ProcessorWithCache *p,
                           ...) {
     va_list args;
     va_start(args, argc);
+    auto list = collectArguments(argc, args);
+    va_end(args);
+    return executeWithCache(
+        p, totalMemoryTime, totalCacheHitTime, name, list);
+}
 
-    std::vector<unsigned> inst, data;
+unsigned executeWithCache(ProcessorWithCache *p,
+                          unsigned long &totalMemoryTime,
+                          unsigned long &totalCacheHitTime,
+                          const std::string &name,
+                          const std::vector<int> &args) {
+    loadProgram(p, name);
+    p->writeReg(11, 0x807fff00);
+
+    writeArguments(p, name, args);
+
+    bool finished = false;
+    unsigned counter = runUntil(p, 0, finished);
+
+    totalMemoryTime = p->getTotalMemoryTime();
+    totalCacheHitTime = p->getTotalCacheHitTime();
 
-    unsigned entry = readElf(name, inst, data);
+    return counter;
+}
 
-    p->loadProgram(inst, data, entry);
+/**
+ * @brief 与 execute 相同，但周期数达到上限时停止，供设计空间探索提前终止
+ * 已经不可能优于其他配置的运行。上限在运行过程中定期重新读取，可以收紧
+ *
+ * @param p CPU
+ * @param name elf 路径
+ * @param args 4字节整型参数
+ * @param limit 返回当前的周期上限
+ * @param finished 程序执行结束时为 true，达到上限停止时为 false
+ * @return unsigned long 停止时已经执行的周期数
+ */
+unsigned long executeWithLimit(ProcessorAbstract *p,
+                               const std::string &name,
+                               const std::vector<int> &args,
+                               const std::function<unsigned long()> &limit,
+                               bool &finished) {
+    loadProgram(p, name);
     p->writeReg(11, 0x807fff00);
 
-    Logger::Warn("Running %s with following arguments: ", name.c_str());
+    writeArguments(p, name, args);
 
-    for (int i = 0; i < argc; i++) {
-        int x = va_arg(args, int);
-        fprintf(stderr, "%d%c", x, " \n"[i == argc - 1]);
-        p->writeMem(0x807fff00 + (i << 2u), x);
-    }
+    return runUntil(p, 0, finished, limit);
+}
+
+/**
+ * @brief 与 execute 相同，但在执行到指定周期时保存检查点
+ *
+ * @param p CPU
+ * @param checkpoint 检查点路径
+ * @param cycle 保存检查点的周期
+ * @param name elf 路径
+ * @param argc 参数数量
+ * @param ... 4字节整型参数
+ * @return unsigned CPU 以该参数执行 elf 使用的时钟周期数
+ */
+unsigned executeWithCheckpoint(ProcessorAbstract *p,
+                               const std::string &checkpoint,
+                               unsigned long cycle,
+                               const std::string &name,
+                               int argc,
+                               ...) {
+    va_list args;
+    va_start(args, argc);
+    auto list = collectArguments(argc, args);
+    va_end(args);
 
-    unsigned counter = 0;
+    loadProgram(p, name);
+    p->writeReg(11, 0x807fff00);
 
-    bool finish = false;
-    do {
-        finish = p->step();
-        counter++;
-        if (counter % 50000 == 0) {
-            Logger::Warn("Running %u cycles.", counter);
-        }
-    } while (!finish);
+    writeArguments(p, name, list);
 
-    totalMemoryTime = p->getTotalMemoryTime();
-    totalCacheHitTime = p->getTotalCacheHitTime();
+    bool finished = false;
+    return runUntil(p, 0, finished, nullptr, checkpoint, cycle);
+}
 
-    return counter;
+/**
+ * @brief 从检查点恢复 CPU 的状态并执行到程序结束
+ * 指令区与数据内存都从检查点恢复，无需再读取 elf
+ *
+ * @param p 与保存检查点时类型、配置相同的 CPU
+ * @param checkpoint 检查点路径
+ * @return unsigned 包含检查点之前部分的总周期数
+ */
+unsigned resume(ProcessorAbstract *p, const std::string &checkpoint) {
+    unsigned long counter = p->restoreCheckpoint(checkpoint);
+    bool finished = false;
+    return runUntil(p, counter, finished);
+}
+
+/**
+ * @brief 按机器描述实例化处理器，配置不能实例化时报错并抛出异常
+ *
+ * @param config
+ * @return std::unique_ptr<ProcessorAbstract>
+ */
+std::unique_ptr<ProcessorAbstract> makeProcessor(const MachineConfig &config) {
+    config.validate();
+    switch (config.type) {
+    case ProcessorType::predict:
+        return std::make_unique<ProcessorWithPredict>(config);
+    case ProcessorType::cache:
+        return std::make_unique<ProcessorWithCache>(config);
+    case ProcessorType::normal:
+        break;
+    }
+    return std::make_unique<Processor>(config);
 }
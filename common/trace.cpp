@@ -0,0 +1,68 @@
+#include "trace.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "logger.h"
+
+thread_local TraceHeader *Tracer::header = nullptr;
+thread_local TraceRecord *Tracer::records = nullptr;
+thread_local unsigned long Tracer::next = 0;
+thread_local unsigned long Tracer::cycle = 0;
+
+/**
+ * @brief 创建追踪文件并开始记录
+ *
+ * @param fileName 追踪文件名，已存在时被覆盖
+ * @param capacity 环形缓冲区可容纳的记录条数
+ */
+void Tracer::open(const char *fileName, unsigned long capacity) {
+    close();
+    if (capacity == 0) {
+        Logger::Error("Trace buffer capacity must be positive");
+        throw std::invalid_argument("Invalid trace buffer capacity");
+    }
+
+    int fd = ::open(fileName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        Logger::Error("Cannot create trace file %s", fileName);
+        throw std::runtime_error("Cannot create trace file");
+    }
+    auto size = sizeof(TraceHeader) + capacity * sizeof(TraceRecord);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        Logger::Error("Cannot resize trace file %s", fileName);
+        throw std::runtime_error("Cannot resize trace file");
+    }
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        Logger::Error("Cannot map trace file %s", fileName);
+        throw std::runtime_error("Cannot map trace file");
+    }
+
+    header = static_cast<TraceHeader *>(map);
+    memcpy(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header->version = TRACE_VERSION;
+    header->recordSize = sizeof(TraceRecord);
+    header->capacity = capacity;
+    header->written = 0;
+    records = reinterpret_cast<TraceRecord *>(header + 1);
+    next = 0;
+    cycle = 0;
+}
+
+/**
+ * @brief 停止记录并解除文件映射，缓冲区内容由内核写回文件
+ */
+void Tracer::close() {
+    if (header == nullptr) return;
+    munmap(header,
+           sizeof(TraceHeader) + header->capacity * sizeof(TraceRecord));
+    header = nullptr;
+    records = nullptr;
+}
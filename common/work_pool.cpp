@@ -0,0 +1,86 @@
+#include "work_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<unsigned long> items;
+};
+
+/**
+ * @brief 取下一个任务，先取自己队列的头部，再依次窃取其他队列的尾部
+ * 任务不会在执行中产生新任务，所有队列都为空时即可结束
+ *
+ * @param queues 各线程的队列
+ * @param self 当前线程编号
+ * @return std::optional<unsigned long> 任务编号
+ */
+std::optional<unsigned long> take(std::vector<WorkQueue> &queues,
+                                  unsigned self) {
+    {
+        auto &own = queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty()) {
+            auto item = own.items.front();
+            own.items.pop_front();
+            return item;
+        }
+    }
+    for (unsigned i = 1; i < queues.size(); i++) {
+        auto &victim = queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            auto item = victim.items.back();
+            victim.items.pop_back();
+            return item;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+void parallelFor(unsigned long count,
+                 unsigned threads,
+                 const std::function<void(unsigned long)> &body) {
+    if (count == 0) return;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned) std::min<unsigned long>(threads, count);
+
+    std::vector<WorkQueue> queues(threads);
+    for (unsigned long i = 0; i < count; i++)
+        queues[i % threads].items.push_back(i);
+
+    std::atomic<bool> failed = false;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&](unsigned self) {
+        while (!failed.load(std::memory_order_relaxed)) {
+            auto item = take(queues, self);
+            if (!item.has_value()) return;
+            try {
+                body(item.value());
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; i++) pool.emplace_back(worker, i);
+    worker(0);
+    for (auto &thread : pool) thread.join();
+    if (error) std::rethrow_exception(error);
+}
@@ -1,48 +1,27 @@
+#include <stdexcept>
+
 #include "logger.h"
 #include "processor.h"
 
-Frontend::Frontend(const std::vector<unsigned> &inst) {
-    for (unsigned long p = 0; p < inst.size(); p++) {
-        data[p] = inst[p];
-    }
-    data[inst.size()] = 0x0000000b;
-}
+Frontend::Frontend(const std::vector<unsigned> &inst)
+    : image(makeProgramImage(inst, {}, 0x80000000u)) {}
 
 /**
- * @brief 前端步进函数
+ * @brief 取指，优先使用预译码结果
+ * 指令区之外或无法识别的编码按原方式构造，保留原有的异常行为
  *
- * @return std::optional<Instruction>
- * 前端有指令需要流出时，返回指令，否则返回std::nullopt
+ * @param address 指令地址
+ * @return Instruction
  */
-std::optional<Instruction> Frontend::step() {
-    Logger::Info("Dispatch halt: %s", dispatchHalt ? "true" : "false");
-    if (DISPATCH == std::nullopt || !dispatchHalt) {
-        DISPATCH = ID;
-        ID = std::nullopt;
-    }
-    dispatchHalt = false;
-    auto instruction = DISPATCH;
-    if (ID == std::nullopt) {
-        ID = IF2;
-        IF2 = std::nullopt;
-    }
-    if (IF2 == std::nullopt) {
-        IF2 = IF1;
-        if (IF2.has_value())
-            IF2.value().predictBundle = bpuFrontendUpdate(IF2.value().pc);
-        if (IF1 != EXTRA::EXIT) {
-            IF1 = std::nullopt;
-        } else {
-            Logger::Info("Fetching EXIT, Frontend pipeline stalled!");
-        }
-    }
-    if (IF1 == std::nullopt) {
-        auto tmp = Instruction(data[(pc - 0x80000000u) >> 2u]);
-        tmp.pc = pc;
-        IF1 = std::make_optional<Instruction>(tmp);
-        pc = calculateNextPC(pc);
-    }
-    return instruction;
+Instruction Frontend::fetch(unsigned address) const {
+    unsigned index = (address - 0x80000000u) >> 2u;
+    const auto &decoded = image->decoded;
+    Instruction ret = index < decoded.size() &&
+                              decoded[index].opcode != Opcode::INVALID
+                          ? decoded[index]
+                          : Instruction(image->word(index));
+    ret.pc = address;
+    return ret;
 }
 
 /**
@@ -51,16 +30,15 @@ std::optional<Instruction> Frontend::step() {
  * @param jumpAddress 跳转地址
  */
 void Frontend::jump(unsigned int jumpAddress) {
-    Logger::Info("Jumped to %08x", jumpAddress);
+    Logger::Info<LogCategory::FRONTEND>("Jumped to %08x", jumpAddress);
     DISPATCH = std::nullopt;
     ID = std::nullopt;
     IF2 = std::nullopt;
-    IF1 = std::make_optional<Instruction>(
-        data[(jumpAddress - 0x80000000u) >> 2u]);
-    IF1.value().pc = jumpAddress;
+    IF1 = std::make_optional<Instruction>(fetch(jumpAddress));
+    activity++;
     pc = jumpAddress;
     pc = calculateNextPC(pc);
-    Logger::Info("New PC = %08x", pc);
+    Logger::Info<LogCategory::FRONTEND>("New PC = %08x", pc);
 }
 
 /**
@@ -101,15 +79,49 @@ void Frontend::bpuBackendUpdate([[maybe_unused]] const BpuUpdateData &x) {
 void Frontend::haltDispatch() { dispatchHalt = true; }
 
 /**
- * @brief 重置前端状态
- * 
- * @param inst 
+ * @brief 重置前端状态，只保留程序映像的引用
+ *
+ * @param image 程序映像
  * @param entry 
  */
-void Frontend::reset(const std::vector<unsigned> &inst, unsigned entry) {
-    for (unsigned long p = 0; p < inst.size(); p++) {
-        data[p] = inst[p];
-    }
-    data[inst.size()] = 0x0000000b;
+void Frontend::reset(const ProgramImagePtr &image, unsigned entry) {
+    this->image = image;
     jump(entry);
 }
+
+/**
+ * @brief 保存前端流水级与 PC，指令区一并保存，恢复时无需重新读取 elf
+ *
+ * @param out 检查点
+ */
+void Frontend::save(CheckpointWriter &out) const {
+    out.writeTag("FRNT");
+    out.write(pc);
+    out.write(dispatchHalt);
+    out.write(IF1);
+    out.write(IF2);
+    out.write(ID);
+    out.write(DISPATCH);
+    const auto &text = image->text;
+    out.write((unsigned) text.size());
+    out.writeBytes(text.data(), text.size() * sizeof(unsigned));
+}
+
+void Frontend::restore(CheckpointReader &in) {
+    in.expectTag("FRNT");
+    in.read(pc);
+    in.read(dispatchHalt);
+    in.read(IF1);
+    in.read(IF2);
+    in.read(ID);
+    in.read(DISPATCH);
+    unsigned length;
+    in.read(length);
+    if (length > (INST_MEM_SIZE >> 2u)) {
+        Logger::Error("Instruction memory of %u words in checkpoint", length);
+        throw std::runtime_error("Invalid checkpoint");
+    }
+    std::vector<unsigned> text(length);
+    in.readBytes(text.data(), length * sizeof(unsigned));
+    image = makeProgramImage(text, {}, image->entry);
+}
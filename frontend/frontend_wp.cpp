@@ -2,7 +2,11 @@
 #include "with_predict.h"
 
 FrontendWithPredict::FrontendWithPredict(const std::vector<unsigned> &inst)
-    : Frontend(inst) {
+    : FrontendWithPredict(inst, MachineConfig()) {}
+
+FrontendWithPredict::FrontendWithPredict(const std::vector<unsigned> &inst,
+                                         const MachineConfig &config)
+    : Frontend(inst), btb(config.btbSize) {
     for (auto &entry : btb) {
         entry.valid = false;
     }
@@ -43,11 +47,37 @@ void FrontendWithPredict::bpuBackendUpdate(const BpuUpdateData &x) {
 /**
  * @brief 重置前端状态
  * 
- * @param inst 
+ * @param image 
  * @param entry 
  */
-void FrontendWithPredict::reset(const std::vector<unsigned int> &inst,
+void FrontendWithPredict::reset(const ProgramImagePtr &image,
                                 unsigned int entry) {
-    Frontend::reset(inst, entry);
+    Frontend::reset(image, entry);
     // Optional TODO: Do your reset here
 }
+
+void FrontendWithPredict::save(CheckpointWriter &out) const {
+    Frontend::save(out);
+    out.writeTag("BTB ");
+    out.write((unsigned) btb.size());
+    for (const auto &entry : btb) {
+        out.write(entry.valid);
+        if (!entry.valid) continue;
+        out.write(entry.pc);
+        out.write(entry.target);
+        out.write(entry.counter);
+    }
+}
+
+void FrontendWithPredict::restore(CheckpointReader &in) {
+    Frontend::restore(in);
+    in.expectTag("BTB ");
+    in.expect((unsigned) btb.size(), "BTB size");
+    for (auto &entry : btb) {
+        in.read(entry.valid);
+        if (!entry.valid) continue;
+        in.read(entry.pc);
+        in.read(entry.target);
+        in.read(entry.counter);
+    }
+}
@@ -0,0 +1,791 @@
+#include "dbt.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "logger.h"
+#include "processor.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define DBT_NATIVE 1
+#include <sys/mman.h>
+#else
+#define DBT_NATIVE 0
+#endif
+
+namespace {
+
+// 块内最多翻译的指令条数
+constexpr unsigned MAX_BLOCK_LENGTH = 256u;
+// 翻译代码区大小，用尽后整体清空
+constexpr unsigned long CODE_BUFFER_SIZE = 32ul << 20u;
+// 翻译一个块前需要保证的剩余空间，足够容纳最长的块
+constexpr unsigned long BLOCK_RESERVE = 64ul << 10u;
+
+// DBTContext::lastExit 的特殊取值
+constexpr unsigned long EXIT_UNLINKED = 0;
+constexpr unsigned long EXIT_INTERPRET = 1;
+
+unsigned fetchWord(const ProgramImage &image, unsigned address) {
+    return image.word((address - 0x80000000u) >> 2u);
+}
+
+// 翻译代码只处理这些指令之外的情况
+bool translatable(Opcode opcode) {
+    switch (opcode) {
+    case Opcode::EXIT:
+    case Opcode::INVALID:
+    case Opcode::CSRRW:
+    case Opcode::CSRRS:
+    case Opcode::CSRRC:
+    case Opcode::CSRRWI:
+    case Opcode::CSRRSI:
+    case Opcode::CSRRCI:
+        return false;
+    default:
+        return true;
+    }
+}
+
+#if DBT_NATIVE
+
+// 以下函数由翻译代码直接调用，地址已经过范围检查，不得抛出异常
+unsigned dbtLoad(Memory *memory, unsigned address, unsigned kind) {
+    unsigned word = memory->functionalRead((address - 0x80400000u) >> 2u);
+    switch ((Opcode) kind) {
+    case Opcode::LB:
+    case Opcode::LBU: {
+        unsigned value = (word >> ((address & 3u) << 3u)) & 0xFFu;
+        if ((Opcode) kind == Opcode::LB && (value & 0x80u))
+            value |= 0xFFFFFF00u;
+        return value;
+    }
+    case Opcode::LH:
+    case Opcode::LHU: {
+        unsigned value = (address & 2u) ? word >> 16u : word & 0xFFFFu;
+        if ((Opcode) kind == Opcode::LH && (value & 0x8000u))
+            value |= 0xFFFF0000u;
+        return value;
+    }
+    default:
+        return word;
+    }
+}
+
+void dbtStore(Memory *memory, unsigned address, unsigned value, unsigned kind) {
+    unsigned index = (address - 0x80400000u) >> 2u;
+    unsigned shift = (address & 3u) << 3u;
+    unsigned mask = 0xFFFFFFFFu;
+    if ((Opcode) kind == Opcode::SB) {
+        mask = 0xFFu << shift;
+        value = (value & 0xFFu) << shift;
+    } else if ((Opcode) kind == Opcode::SH) {
+        shift &= 16u;
+        mask = 0xFFFFu << shift;
+        value = (value & 0xFFFFu) << shift;
+    }
+    unsigned old = memory->functionalRead(index);
+    memory->functionalWrite(index, (old & ~mask) | (value & mask));
+}
+
+// 除法按 RISC-V 规范处理除零与溢出
+unsigned dbtDiv(unsigned a, unsigned b) {
+    if (b == 0) return -1u;
+    if (a == 0x80000000u && b == -1u) return a;
+    return (unsigned) ((int) a / (int) b);
+}
+unsigned dbtDivu(unsigned a, unsigned b) { return b == 0 ? -1u : a / b; }
+unsigned dbtRem(unsigned a, unsigned b) {
+    if (b == 0) return a;
+    if (a == 0x80000000u && b == -1u) return 0;
+    return (unsigned) ((int) a % (int) b);
+}
+unsigned dbtRemu(unsigned a, unsigned b) { return b == 0 ? a : a % b; }
+
+enum X86Reg : unsigned char { EAX = 0, ECX = 1, EDX = 2, ESI = 6, EDI = 7 };
+
+enum X86Cond : unsigned char {
+    CC_B = 0x2,
+    CC_AE = 0x3,
+    CC_E = 0x4,
+    CC_NE = 0x5,
+    CC_L = 0xC,
+    CC_GE = 0xD,
+};
+
+constexpr unsigned PC_OFFSET = offsetof(DBTContext, pc);
+constexpr unsigned BUDGET_OFFSET = offsetof(DBTContext, budget);
+constexpr unsigned LAST_EXIT_OFFSET = offsetof(DBTContext, lastExit);
+constexpr unsigned MEMORY_OFFSET = offsetof(DBTContext, memory);
+static_assert(offsetof(DBTContext, reg) == 0);
+
+/**
+ * @brief 向代码区顺序写入 x86-64 指令
+ * 翻译代码中 rbx 始终指向 DBTContext，eax/ecx/edx 为临时寄存器
+ */
+class Emitter {
+    unsigned char *cur;
+
+public:
+    explicit Emitter(unsigned char *start) : cur(start) {}
+
+    [[nodiscard]] unsigned char *here() const { return cur; }
+
+    void bytes(std::initializer_list<unsigned> list) {
+        for (auto b : list) *cur++ = (unsigned char) b;
+    }
+
+    void dword(unsigned value) {
+        std::memcpy(cur, &value, 4);
+        cur += 4;
+    }
+
+    void qword(unsigned long value) {
+        std::memcpy(cur, &value, 8);
+        cur += 8;
+    }
+
+    // [rbx + disp] 形式的 ModRM
+    void context(unsigned reg, unsigned disp) {
+        if (disp < 0x80u) {
+            bytes({0x43u | reg << 3u, disp});
+        } else {
+            bytes({0x83u | reg << 3u});
+            dword(disp);
+        }
+    }
+
+    void loadGuest(unsigned x86, unsigned guest) {
+        if (guest == 0) {
+            bytes({0x31, 0xC0u | x86 << 3u | x86});
+        } else {
+            bytes({0x8B});
+            context(x86, guest << 2u);
+        }
+    }
+
+    void storeGuest(unsigned guest, unsigned x86) {
+        bytes({0x89});
+        context(x86, guest << 2u);
+    }
+
+    void storeGuestImm(unsigned guest, unsigned imm) {
+        bytes({0xC7});
+        context(0, guest << 2u);
+        dword(imm);
+    }
+
+    void storePC(unsigned imm) {
+        bytes({0xC7});
+        context(0, PC_OFFSET);
+        dword(imm);
+    }
+
+    void storePCFromEAX() {
+        bytes({0x89});
+        context(EAX, PC_OFFSET);
+    }
+
+    void setLastExit(unsigned long value) {
+        if (value <= 0x7FFFFFFFul) {
+            bytes({0x48, 0xC7});
+            context(0, LAST_EXIT_OFFSET);
+            dword((unsigned) value);
+        } else {
+            bytes({0x48, 0xB8});
+            qword(value);
+            bytes({0x48, 0x89});
+            context(EAX, LAST_EXIT_OFFSET);
+        }
+    }
+
+    void subBudget(unsigned n) {
+        bytes({0x48, 0x81});
+        context(5, BUDGET_OFFSET);
+        dword(n);
+    }
+
+    void addBudget(unsigned n) {
+        bytes({0x48, 0x81});
+        context(0, BUDGET_OFFSET);
+        dword(n);
+    }
+
+    void call(unsigned long function) {
+        bytes({0x48, 0xB8});
+        qword(function);
+        bytes({0xFF, 0xD0});
+    }
+
+    // 返回 rel32 的位置，稍后用 patch 填写目标
+    unsigned char *jcc(unsigned cond) {
+        bytes({0x0F, 0x80u | cond});
+        dword(0);
+        return cur - 4;
+    }
+
+    unsigned char *jmp() {
+        bytes({0xE9});
+        dword(0);
+        return cur - 4;
+    }
+
+    static void patch(unsigned char *site, const unsigned char *target) {
+        int rel = (int) (target - (site + 4));
+        std::memcpy(site, &rel, 4);
+    }
+};
+
+using EnterFunction = void (*)(DBTContext *context, const unsigned char *code);
+
+#endif
+
+}  // namespace
+
+DBTCore::DBTCore(RegisterFile &regFile, Memory &memory)
+    : regFile(&regFile), memory(&memory), interpreter(regFile, memory),
+      image(std::make_shared<ProgramImage>()), codeBuffer(nullptr),
+      codeSize(0), codeUsed(0), enter(nullptr), exitStub(nullptr),
+      generation(0), context(), exited(false) {
+    context.pc = 0x80000000u;
+    context.memory = &memory;
+#if DBT_NATIVE
+    void *buffer = mmap(nullptr,
+                        CODE_BUFFER_SIZE,
+                        PROT_READ | PROT_WRITE | PROT_EXEC,
+                        MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1,
+                        0);
+    if (buffer == MAP_FAILED) {
+        Logger::Warn("DBT: cannot map code buffer, falling back to interpreter");
+        return;
+    }
+    codeBuffer = (unsigned char *) buffer;
+    codeSize = CODE_BUFFER_SIZE;
+
+    // 入口：保存被调用者寄存器并保持栈 16 字节对齐，rbx 指向上下文
+    Emitter e(codeBuffer);
+    enter = e.here();
+    e.bytes({0x53, 0x55, 0x41, 0x54});
+    e.bytes({0x48, 0x89, 0xFB});
+    e.bytes({0xFF, 0xE6});
+    exitStub = e.here();
+    e.bytes({0x41, 0x5C, 0x5D, 0x5B, 0xC3});
+    codeUsed = e.here() - codeBuffer;
+#endif
+}
+
+DBTCore::~DBTCore() {
+#if DBT_NATIVE
+    if (codeBuffer != nullptr) munmap(codeBuffer, codeSize);
+#endif
+}
+
+/**
+ * @brief 装载程序映像，清空全部翻译结果
+ *
+ * @param image 程序映像，只使用其指令区
+ * @param entry 程序入口
+ */
+void DBTCore::reset(const ProgramImagePtr &image, unsigned entry) {
+    this->image = image;
+    interpreter.reset(image, entry);
+    flushCache();
+    jump(entry);
+}
+
+/**
+ * @brief 装载程序，清空全部翻译结果
+ *
+ * @param inst 从 0x80000000 开始的指令区
+ * @param entry 程序入口
+ */
+void DBTCore::reset(const std::vector<unsigned> &inst, unsigned entry) {
+    reset(makeProgramImage(inst, {}, entry), entry);
+}
+
+/**
+ * @brief 修改下一条执行的指令地址
+ *
+ * @param address
+ */
+void DBTCore::jump(unsigned address) {
+    context.pc = address;
+    exited = false;
+}
+
+/**
+ * @brief 执行指令，直到提交 EXIT 或执行了指定条数
+ *
+ * @param maxInstructions 最多执行的指令条数
+ * @return unsigned long 实际执行的指令条数（包括 EXIT）
+ */
+unsigned long DBTCore::run(unsigned long maxInstructions) {
+    for (unsigned i = 0; i < 32; i++) context.reg[i] = regFile->read(i);
+    context.reg[0] = 0;
+
+    long limit = maxInstructions > (unsigned long) LONG_MAX
+                     ? LONG_MAX
+                     : (long) maxInstructions;
+    context.budget = limit;
+    context.lastExit = EXIT_UNLINKED;
+
+    auto writeBack = [this]() {
+        for (unsigned i = 1; i < 32; i++) {
+            regFile->functionalWrite(i, context.reg[i]);
+        }
+    };
+
+    try {
+        while (!exited && context.budget > 0) {
+            if (!isNative()) {
+                context.budget -= (long) interpret(context.budget);
+                continue;
+            }
+            DBTBlock *block = lookup(context.pc);
+            if (block->code == nullptr) {
+                context.budget -= (long) interpret(1);
+                continue;
+            }
+            if (block->length > (unsigned long) context.budget) {
+                // 剩余条数不足一个块，交给解释器停在块中间
+                context.budget -= (long) interpret(context.budget);
+                continue;
+            }
+#if DBT_NATIVE
+            ((EnterFunction) enter)(&context, block->code);
+#endif
+            if (context.lastExit == EXIT_INTERPRET) {
+                context.budget -= (long) interpret(1);
+            } else if (context.lastExit != EXIT_UNLINKED) {
+                auto *from = (DBTExit *) context.lastExit;
+                unsigned long currentGeneration = generation;
+                DBTBlock *next = lookup(context.pc);
+                if (currentGeneration == generation && next->code != nullptr) {
+                    link(from, next);
+                }
+            }
+        }
+    } catch (...) {
+        writeBack();
+        throw;
+    }
+    writeBack();
+    return limit - context.budget;
+}
+
+/**
+ * @brief 修改指令区中的一个字，并使覆盖到该地址的翻译失效
+ *
+ * @param address 字节地址
+ * @param value
+ */
+void DBTCore::writeInstruction(unsigned address, unsigned value) {
+    if (address < 0x80000000u || address >= 0x80000000u + INST_MEM_SIZE) {
+        Logger::Error("DBT: instruction write to 0x%08x out of range", address);
+        throw std::runtime_error("Instruction Address is out of range");
+    }
+    unsigned index = (address - 0x80000000u) >> 2u;
+    // 映像可能被其他模型共享，修改副本后替换
+    auto text = image->text;
+    if (index >= text.size()) {
+        // EXIT 哨兵的位置随之改变，直接清空全部翻译
+        text.resize(index + 1, 0u);
+        text[index] = value;
+        flushCache();
+    } else {
+        text[index] = value;
+        std::vector<DBTBlock *> stale;
+        for (auto &[pc, block] : blocks) {
+            unsigned length = block->length == 0 ? 1u : block->length;
+            if (address >= pc && address - pc < length << 2u) {
+                stale.push_back(block.get());
+            }
+        }
+        for (auto *block : stale) invalidate(block);
+    }
+    image = makeProgramImage(text, image->data, image->entry);
+    interpreter.reset(image, context.pc);
+}
+
+/**
+ * @brief 在切换点把体系结构状态交给周期级模型继续执行
+ *
+ * @param processor
+ */
+void DBTCore::transfer(ProcessorAbstract &processor) const {
+    processor.loadProgram(image->text,
+                          memory->functionalRead(0, DATA_MEM_SIZE >> 2u),
+                          context.pc);
+    for (unsigned i = 1; i < 32; i++) {
+        processor.writeReg(i, regFile->read(i));
+    }
+}
+
+/**
+ * @brief 用解释器执行若干条指令，前后同步寄存器
+ *
+ * @param maxInstructions
+ * @return unsigned long 实际执行的指令条数
+ */
+unsigned long DBTCore::interpret(unsigned long maxInstructions) {
+    for (unsigned i = 1; i < 32; i++) {
+        regFile->functionalWrite(i, context.reg[i]);
+    }
+    unsigned long count = 0;
+    interpreter.jump(context.pc);
+    try {
+        count = interpreter.run(maxInstructions);
+    } catch (...) {
+        for (unsigned i = 1; i < 32; i++) context.reg[i] = regFile->read(i);
+        context.pc = interpreter.getPC();
+        throw;
+    }
+    for (unsigned i = 1; i < 32; i++) context.reg[i] = regFile->read(i);
+    context.pc = interpreter.getPC();
+    exited = interpreter.hasExited();
+    return count;
+}
+
+DBTBlock *DBTCore::lookup(unsigned address) {
+    auto it = blocks.find(address);
+    if (it != blocks.end()) return it->second.get();
+    return translate(address);
+}
+
+/**
+ * @brief 将从 address 开始的基本块翻译为 x86-64 代码
+ * 块首即无法翻译的指令时，生成 code 为 nullptr 的块交给解释器
+ *
+ * @param address
+ * @return DBTBlock*
+ */
+DBTBlock *DBTCore::translate(unsigned address) {
+    if (codeSize - codeUsed < BLOCK_RESERVE) flushCache();
+
+    auto block = std::make_unique<DBTBlock>();
+    block->pc = address;
+    block->length = 0;
+    block->code = nullptr;
+    block->exitCount = 0;
+
+    std::vector<Instruction> insts;
+    bool terminated = false;
+    for (unsigned p = address; insts.size() < MAX_BLOCK_LENGTH; p += 4) {
+        Instruction inst = Instruction::predecode(fetchWord(*image, p));
+        if (!translatable(inst.opcode)) break;
+        insts.push_back(inst);
+        if (inst.fuType == FUType::BRU) {
+            terminated = true;
+            break;
+        }
+    }
+
+#if DBT_NATIVE
+    if (!insts.empty()) {
+        block->length = insts.size();
+        Emitter e(codeBuffer + codeUsed);
+        block->code = e.here();
+
+        auto emitExit = [&](unsigned target) {
+            DBTExit &exit = block->exits[block->exitCount++];
+            exit.jump = e.jmp();
+            exit.target = target;
+            exit.owner = block.get();
+            exit.linked = nullptr;
+            e.storePC(target);
+            e.setLastExit((unsigned long) &exit);
+            Emitter::patch(e.jmp(), exitStub);
+        };
+
+        struct SideExit {
+            unsigned char *site;
+            unsigned index;
+        };
+        std::vector<SideExit> sideExits;
+
+        e.subBudget(block->length);
+        unsigned char *bail = e.jcc(CC_L);
+
+        for (unsigned i = 0; i < insts.size(); i++) {
+            const Instruction &inst = insts[i];
+            unsigned pc = address + (i << 2u);
+            unsigned rd = inst.getRd(), rs1 = inst.getRs1(),
+                     rs2 = inst.getRs2(), imm = inst.getImmediate();
+
+            bool memoryAccess =
+                inst.fuType == FUType::LSU && inst.opcode != Opcode::FENCE;
+            if (memoryAccess) {
+                // 计算地址并检查是否在数据区，否则回到解释器报告错误
+                e.loadGuest(EAX, rs1);
+                e.bytes({0x05});
+                e.dword(imm);
+                e.bytes({0x89, 0xC1, 0x81, 0xE9});
+                e.dword(0x80400000u);
+                e.bytes({0x81, 0xF9});
+                e.dword(DATA_MEM_SIZE);
+                sideExits.push_back({e.jcc(CC_AE), i});
+
+                e.bytes({0x48, 0x8B});
+                e.context(EDI, MEMORY_OFFSET);
+                e.bytes({0x89, 0xC6});
+                if (inst.type == InstructionType::S) {
+                    e.loadGuest(EDX, rs2);
+                    e.bytes({0xB9});
+                    e.dword((unsigned) inst.opcode);
+                    e.call((unsigned long) &dbtStore);
+                } else {
+                    e.bytes({0xBA});
+                    e.dword((unsigned) inst.opcode);
+                    e.call((unsigned long) &dbtLoad);
+                    if (rd != 0) e.storeGuest(rd, EAX);
+                }
+                continue;
+            }
+
+            switch (inst.opcode) {
+            case Opcode::JAL:
+                if (rd != 0) e.storeGuestImm(rd, pc + 4);
+                emitExit(pc + imm);
+                continue;
+            case Opcode::JALR:
+                e.loadGuest(EAX, rs1);
+                e.bytes({0x05});
+                e.dword(imm);
+                if (rd != 0) e.storeGuestImm(rd, pc + 4);
+                e.storePCFromEAX();
+                e.setLastExit(EXIT_UNLINKED);
+                Emitter::patch(e.jmp(), exitStub);
+                continue;
+            case Opcode::BEQ:
+            case Opcode::BNE:
+            case Opcode::BLT:
+            case Opcode::BGE:
+            case Opcode::BLTU:
+            case Opcode::BGEU: {
+                X86Cond cond = inst.opcode == Opcode::BEQ    ? CC_E
+                               : inst.opcode == Opcode::BNE  ? CC_NE
+                               : inst.opcode == Opcode::BLT  ? CC_L
+                               : inst.opcode == Opcode::BGE  ? CC_GE
+                               : inst.opcode == Opcode::BLTU ? CC_B
+                                                             : CC_AE;
+                e.loadGuest(EAX, rs1);
+                e.loadGuest(ECX, rs2);
+                e.bytes({0x39, 0xC8});
+                unsigned char *taken = e.jcc(cond);
+                emitExit(pc + 4);
+                Emitter::patch(taken, e.here());
+                emitExit(pc + imm);
+                continue;
+            }
+            default:
+                break;
+            }
+
+            // 以下指令只写 rd，写 0 号寄存器时没有效果
+            if (rd == 0) continue;
+            switch (inst.opcode) {
+            case Opcode::LUI:
+                e.storeGuestImm(rd, imm);
+                continue;
+            case Opcode::AUIPC:
+                e.storeGuestImm(rd, pc + imm);
+                continue;
+            case Opcode::ADDI:
+            case Opcode::XORI:
+            case Opcode::ORI:
+            case Opcode::ANDI:
+            case Opcode::SLTI:
+            case Opcode::SLTIU:
+                e.loadGuest(EAX, rs1);
+                switch (inst.opcode) {
+                case Opcode::ADDI:
+                    e.bytes({0x05});
+                    break;
+                case Opcode::XORI:
+                    e.bytes({0x35});
+                    break;
+                case Opcode::ORI:
+                    e.bytes({0x0D});
+                    break;
+                case Opcode::ANDI:
+                    e.bytes({0x25});
+                    break;
+                default:
+                    e.bytes({0x3D});
+                    break;
+                }
+                e.dword(imm);
+                if (inst.opcode == Opcode::SLTI) {
+                    e.bytes({0x0F, 0x9C, 0xC0, 0x0F, 0xB6, 0xC0});
+                } else if (inst.opcode == Opcode::SLTIU) {
+                    e.bytes({0x0F, 0x92, 0xC0, 0x0F, 0xB6, 0xC0});
+                }
+                e.storeGuest(rd, EAX);
+                continue;
+            case Opcode::SLLI:
+            case Opcode::SRLI:
+            case Opcode::SRAI:
+                e.loadGuest(EAX, rs1);
+                e.bytes({0xC1,
+                         inst.opcode == Opcode::SLLI   ? 0xE0u
+                         : inst.opcode == Opcode::SRLI ? 0xE8u
+                                                       : 0xF8u,
+                         imm & 31u});
+                e.storeGuest(rd, EAX);
+                continue;
+            case Opcode::FENCE:
+                continue;
+            default:
+                break;
+            }
+
+            // 寄存器-寄存器运算，eax = rs1，ecx = rs2
+            e.loadGuest(EAX, rs1);
+            e.loadGuest(ECX, rs2);
+            switch (inst.opcode) {
+            case Opcode::ADD:
+                e.bytes({0x01, 0xC8});
+                break;
+            case Opcode::SUB:
+                e.bytes({0x29, 0xC8});
+                break;
+            case Opcode::AND:
+                e.bytes({0x21, 0xC8});
+                break;
+            case Opcode::OR:
+                e.bytes({0x09, 0xC8});
+                break;
+            case Opcode::XOR:
+                e.bytes({0x31, 0xC8});
+                break;
+            case Opcode::SLT:
+                e.bytes({0x39, 0xC8, 0x0F, 0x9C, 0xC0, 0x0F, 0xB6, 0xC0});
+                break;
+            case Opcode::SLTU:
+                e.bytes({0x39, 0xC8, 0x0F, 0x92, 0xC0, 0x0F, 0xB6, 0xC0});
+                break;
+            case Opcode::SLL:
+                e.bytes({0xD3, 0xE0});
+                break;
+            case Opcode::SRL:
+                e.bytes({0xD3, 0xE8});
+                break;
+            case Opcode::SRA:
+                e.bytes({0xD3, 0xF8});
+                break;
+            case Opcode::MUL:
+                e.bytes({0x0F, 0xAF, 0xC1});
+                break;
+            case Opcode::MULH:
+                e.bytes({0x48, 0x63, 0xC0, 0x48, 0x63, 0xC9});
+                e.bytes({0x48, 0x0F, 0xAF, 0xC1, 0x48, 0xC1, 0xE8, 0x20});
+                break;
+            case Opcode::MULHSU:
+                e.bytes({0x48, 0x63, 0xC0});
+                e.bytes({0x48, 0x0F, 0xAF, 0xC1, 0x48, 0xC1, 0xE8, 0x20});
+                break;
+            case Opcode::MULHU:
+                e.bytes({0x48, 0x0F, 0xAF, 0xC1, 0x48, 0xC1, 0xE8, 0x20});
+                break;
+            case Opcode::DIV:
+            case Opcode::DIVU:
+            case Opcode::REM:
+            case Opcode::REMU:
+                e.bytes({0x89, 0xC7, 0x89, 0xCE});
+                e.call(inst.opcode == Opcode::DIV    ? (unsigned long) &dbtDiv
+                       : inst.opcode == Opcode::DIVU ? (unsigned long) &dbtDivu
+                       : inst.opcode == Opcode::REM  ? (unsigned long) &dbtRem
+                                                     : (unsigned long) &dbtRemu);
+                break;
+            default:
+                Logger::Error("DBT: cannot translate %s",
+                              getOpcodeName(inst.opcode));
+                throw std::runtime_error("Unknown instruction in translation");
+            }
+            e.storeGuest(rd, EAX);
+        }
+
+        if (!terminated) emitExit(address + (block->length << 2u));
+
+        // 访存越界：退回未执行的指令条数，由解释器重新执行该指令并报错
+        for (const auto &side : sideExits) {
+            Emitter::patch(side.site, e.here());
+            e.addBudget(block->length - side.index);
+            e.storePC(address + (side.index << 2u));
+            e.setLastExit(EXIT_INTERPRET);
+            Emitter::patch(e.jmp(), exitStub);
+        }
+
+        // 剩余条数不足以执行整个块
+        Emitter::patch(bail, e.here());
+        e.addBudget(block->length);
+        e.storePC(address);
+        e.setLastExit(EXIT_UNLINKED);
+        Emitter::patch(e.jmp(), exitStub);
+
+        codeUsed = e.here() - codeBuffer;
+    }
+#else
+    (void) terminated;
+#endif
+
+    auto *ret = block.get();
+    blocks[address] = std::move(block);
+    return ret;
+}
+
+/**
+ * @brief 将出口直接跳转到后继块
+ *
+ * @param exit 前驱块的出口
+ * @param block 后继块
+ */
+void DBTCore::link(DBTExit *exit, DBTBlock *block) {
+#if DBT_NATIVE
+    Emitter::patch(exit->jump, block->code);
+    exit->linked = block;
+    block->incoming.push_back(exit);
+#else
+    (void) exit;
+    (void) block;
+#endif
+}
+
+/**
+ * @brief 使一个块失效：恢复所有链接到它的出口，并从后继的记录中移除自身
+ *
+ * @param block
+ */
+void DBTCore::invalidate(DBTBlock *block) {
+#if DBT_NATIVE
+    for (auto *exit : block->incoming) {
+        Emitter::patch(exit->jump, exit->jump + 4);
+        exit->linked = nullptr;
+    }
+    for (unsigned i = 0; i < block->exitCount; i++) {
+        DBTExit *exit = &block->exits[i];
+        if (exit->linked == nullptr) continue;
+        auto &incoming = exit->linked->incoming;
+        for (auto it = incoming.begin(); it != incoming.end(); ++it) {
+            if (*it == exit) {
+                incoming.erase(it);
+                break;
+            }
+        }
+    }
+#endif
+    blocks.erase(block->pc);
+}
+
+/**
+ * @brief 丢弃全部翻译结果，回收代码区
+ */
+void DBTCore::flushCache() {
+    blocks.clear();
+    if (exitStub != nullptr) codeUsed = exitStub + 5 - codeBuffer;
+    generation++;
+}
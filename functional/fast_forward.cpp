@@ -0,0 +1,308 @@
+#include "fast_forward.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dbt.h"
+#include "logger.h"
+#include "with_cache.h"
+
+/**
+ * @brief 读取 elf 并初始化功能模型的体系结构状态，参数约定与 execute 相同
+ *
+ * @param name elf 路径
+ * @param regFile 功能模型的寄存器堆
+ * @param memory 功能模型的数据内存
+ * @param argc 参数数量
+ * @param args 4字节整型参数
+ * @return ProgramImagePtr 程序映像
+ */
+ProgramImagePtr loadGuest(const std::string &name,
+                          RegisterFile &regFile,
+                          Memory &memory,
+                          int argc,
+                          va_list args) {
+    std::vector<int> list(argc);
+    for (int &x : list) x = va_arg(args, int);
+    return loadGuest(name, regFile, memory, list);
+}
+
+/**
+ * @brief 与上面相同，参数以数组给出
+ *
+ * @param name elf 路径
+ * @param regFile 功能模型的寄存器堆
+ * @param memory 功能模型的数据内存
+ * @param args 4字节整型参数
+ * @return ProgramImagePtr 程序映像
+ */
+ProgramImagePtr loadGuest(const std::string &name,
+                          RegisterFile &regFile,
+                          Memory &memory,
+                          const std::vector<int> &args) {
+    auto image = readProgramImage(name);
+
+    memory.mapImage(image);
+    regFile.functionalWrite(11, 0x807fff00);
+
+    std::string list;
+    for (unsigned i = 0; i < args.size(); i++) {
+        list += (i == 0 ? "" : " ") + std::to_string(args[i]);
+        memory.functionalWrite(((0x807fff00 - 0x80400000u) >> 2u) + i,
+                               args[i]);
+    }
+    Logger::Warn("Running %s with following arguments: %s",
+                 name.c_str(),
+                 list.c_str());
+    return image;
+}
+
+/**
+ * @brief 把功能模型的体系结构状态装载进处理器，之前的微结构状态全部清空
+ * 不复制程序映像，数据内存只复制功能模型写入过的页
+ *
+ * @param p CPU
+ * @param image 程序映像，沿用其指令区与预译码结果
+ * @param regFile 功能模型的寄存器堆
+ * @param memory 功能模型的数据内存
+ * @param pc 下一条执行的指令地址
+ */
+void transferState(ProcessorAbstract *p,
+                   const ProgramImagePtr &image,
+                   const RegisterFile &regFile,
+                   const Memory &memory,
+                   unsigned pc) {
+    p->loadState(image, memory, pc);
+    for (unsigned i = 1; i < 32; i++) p->writeReg(i, regFile.read(i));
+}
+
+/**
+ * @brief 用周期级模型执行，直到自装载以来提交了指定条数的指令或提交了 EXIT
+ *
+ * @param p CPU
+ * @param instructions 提交指令条数的目标，-1ul 表示执行到程序结束
+ * @param cycles 累加使用的周期数
+ * @return true 提交了 EXIT
+ * @return false 达到了指令条数
+ */
+bool runDetailed(ProcessorAbstract *p,
+                 unsigned long instructions,
+                 unsigned long &cycles) {
+    bool finished = false;
+    unsigned long nextReport = cycles - cycles % 50000 + 50000;
+    while (!finished && p->getCommittedInstructions() < instructions) {
+        finished = p->step();
+        cycles++;
+        if (!finished) cycles += p->skipIdleCycles();
+        if (cycles >= nextReport) {
+            Logger::Warn("Running %lu cycles.", cycles);
+            nextReport = cycles - cycles % 50000 + 50000;
+        }
+    }
+    return finished;
+}
+
+/**
+ * @brief 先用功能模型快进并预热，再把体系结构状态交给周期级模型执行
+ * 参数约定与 execute 相同，放置在 0x807fff00 开始的连续地址中
+ *
+ * @param p CPU
+ * @param name elf 路径
+ * @param config 各阶段的指令条数
+ * @param argc 参数数量
+ * @param ... 4字节整型参数
+ * @return FastForwardResult 各阶段实际执行的指令条数与周期级模型的周期数
+ */
+FastForwardResult executeFastForward(ProcessorAbstract *p,
+                                     const std::string &name,
+                                     const FastForwardConfig &config,
+                                     int argc,
+                                     ...) {
+    va_list args;
+    va_start(args, argc);
+    RegisterFile regFile;
+    Memory memory(0);
+    auto image = loadGuest(name, regFile, memory, argc, args);
+    va_end(args);
+
+    FastForwardResult result;
+    FunctionalCore core(regFile, memory);
+    core.reset(image, image->entry);
+
+    if (config.fastForward != 0) {
+        if (config.native) {
+            DBTCore dbt(regFile, memory);
+            dbt.reset(image, image->entry);
+            result.fastForwarded = dbt.run(config.fastForward);
+            core.jump(dbt.getPC());
+            result.finished = dbt.hasExited();
+        } else {
+            result.fastForwarded = core.run(config.fastForward);
+            result.finished = core.hasExited();
+        }
+        Logger::Warn("Fast-forwarded %lu instructions, pc = 0x%08x",
+                     result.fastForwarded,
+                     core.getPC());
+    }
+
+    WarmupRecorder recorder;
+    if (!result.finished && config.warmup != 0) {
+        core.setObserver(&recorder);
+        result.warmed = core.run(config.warmup);
+        core.setObserver(nullptr);
+        result.finished = core.hasExited();
+        Logger::Warn("Warmed up with %lu instructions, pc = 0x%08x",
+                     result.warmed,
+                     core.getPC());
+    }
+
+    if (result.finished) {
+        Logger::Warn("Program exited before the detailed window");
+        return result;
+    }
+
+    transferState(p, image, regFile, memory, core.getPC());
+    recorder.replay(p);
+
+    result.finished = runDetailed(
+        p, config.detail == 0 ? -1ul : config.detail, result.cycles);
+    result.committed = p->getCommittedInstructions();
+
+    return result;
+}
+
+/**
+ * @brief 置信区间的半宽，样本数不足两个时返回无穷大
+ *
+ * @param z 置信水平对应的标准正态分位数
+ * @return double
+ */
+double SampleStatistics::halfWidth(double z) const {
+    if (count < 2) return INFINITY;
+    double m = mean();
+    double variance = (sumSquares - count * m * m) / (count - 1);
+    return z * std::sqrt(std::max(variance, 0.0) / count);
+}
+
+namespace {
+
+/**
+ * @brief 双侧置信区间的正态分布分位数
+ * 二分求解 erfc(z / sqrt(2)) = 1 - confidence，左侧单调递减
+ *
+ * @param confidence 置信水平，位于 (0, 1)
+ * @return double 区间半宽对应的标准差倍数
+ */
+double normalQuantile(double confidence) {
+    if (!(confidence > 0 && confidence < 1)) {
+        Logger::Error("Confidence level %f is not in (0, 1)", confidence);
+        throw std::invalid_argument("Unsupported confidence level");
+    }
+    double low = 0, high = 40;
+    for (int i = 0; i < 100; i++) {
+        double mid = (low + high) / 2;
+        if (std::erfc(mid / std::sqrt(2.0)) > 1 - confidence) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (low + high) / 2;
+}
+
+}  // namespace
+
+/**
+ * @brief SMARTS 式的周期采样运行
+ * 功能模型始终执行完整的程序并保存体系结构状态；每个周期的末尾，
+ * 把状态复制进周期级模型，经过功能预热与周期级预热后测量一个单元的
+ * CPI 与 Cache 命中率，再丢弃周期级模型的状态继续功能执行。
+ * CPI 的相对误差达到要求后提前结束
+ *
+ * @param p 带 Cache 的 CPU
+ * @param name elf 路径
+ * @param config 采样参数
+ * @param argc 参数数量
+ * @param ... 4字节整型参数
+ * @return SamplingResult 每个单元的样本统计
+ */
+SamplingResult executeSampling(ProcessorWithCache *p,
+                               const std::string &name,
+                               const SamplingConfig &config,
+                               int argc,
+                               ...) {
+    unsigned long measured =
+        config.warmup + config.detailedWarmup + config.unit;
+    if (config.unit == 0 || config.period < measured) {
+        Logger::Error("Sampling period %lu is shorter than warm-up and unit",
+                      config.period);
+        throw std::invalid_argument("Invalid sampling period");
+    }
+
+    SamplingResult result;
+    result.z = normalQuantile(config.confidence);
+
+    va_list args;
+    va_start(args, argc);
+    RegisterFile regFile;
+    Memory memory(0);
+    auto image = loadGuest(name, regFile, memory, argc, args);
+    va_end(args);
+
+    FunctionalCore core(regFile, memory);
+    core.reset(image, image->entry);
+    WarmupRecorder recorder;
+
+    while (!core.hasExited()) {
+        result.instructions += core.run(config.period - measured);
+        if (core.hasExited()) break;
+
+        recorder.clear();
+        core.setObserver(&recorder);
+        result.instructions += core.run(config.warmup);
+        core.setObserver(nullptr);
+        if (core.hasExited()) break;
+
+        transferState(p, image, regFile, memory, core.getPC());
+        recorder.replay(p);
+
+        bool exited = runDetailed(
+            p, config.detailedWarmup, result.detailedCycles);
+        unsigned long cycles = result.detailedCycles;
+        unsigned long committed = p->getCommittedInstructions();
+        unsigned long memoryTime = p->getTotalMemoryTime();
+        unsigned long cacheHitTime = p->getTotalCacheHitTime();
+        if (!exited)
+            exited = runDetailed(p,
+                                 config.detailedWarmup + config.unit,
+                                 result.detailedCycles);
+
+        // 程序在单元中间结束时，不完整的单元不计入样本
+        if (!exited) {
+            result.cpi.add(
+                (double) (result.detailedCycles - cycles) /
+                (double) (p->getCommittedInstructions() - committed));
+            if (p->getTotalMemoryTime() != memoryTime)
+                result.hitRate.add(
+                    (double) (p->getTotalCacheHitTime() - cacheHitTime) /
+                    (double) (p->getTotalMemoryTime() - memoryTime));
+        }
+
+        result.instructions += core.run(config.detailedWarmup + config.unit);
+
+        if (result.cpi.count >= config.minUnits &&
+            result.cpi.halfWidth(result.z) <=
+                config.errorBound * result.cpi.mean()) {
+            Logger::Warn("Error bound reached after %lu units",
+                         result.cpi.count);
+            break;
+        }
+    }
+
+    result.finished = core.hasExited();
+    return result;
+}
@@ -0,0 +1,525 @@
+#include <sstream>
+#include <stdexcept>
+
+#include "functional.h"
+#include "logger.h"
+
+namespace {
+
+// 单个基本块最多翻译的指令条数
+constexpr unsigned MAX_BLOCK_LENGTH = 256u;
+
+// 寄存器 0 的写入被重定向到该寄存器
+constexpr unsigned char DISCARD_REG = 32u;
+
+unsigned add(unsigned a, unsigned b) { return a + b; }
+unsigned sub(unsigned a, unsigned b) { return a - b; }
+unsigned slt(unsigned a, unsigned b) { return (int) a < (int) b ? 1 : 0; }
+unsigned sltu(unsigned a, unsigned b) { return a < b ? 1 : 0; }
+unsigned sll(unsigned a, unsigned b) { return a << (b & 31u); }
+unsigned srl(unsigned a, unsigned b) { return a >> (b & 31u); }
+unsigned sra(unsigned a, unsigned b) { return (int) a >> (b & 31u); }
+unsigned bitAnd(unsigned a, unsigned b) { return a & b; }
+unsigned bitOr(unsigned a, unsigned b) { return a | b; }
+unsigned bitXor(unsigned a, unsigned b) { return a ^ b; }
+
+unsigned mul(unsigned a, unsigned b) { return a * b; }
+unsigned mulh(unsigned a, unsigned b) {
+    return (unsigned) ((1LL * (int) a * (int) b) >> 32u);
+}
+unsigned mulhsu(unsigned a, unsigned b) {
+    return (unsigned) ((1LL * (int) a * b) >> 32u);
+}
+unsigned mulhu(unsigned a, unsigned b) {
+    return (unsigned) ((1LLU * a * b) >> 32u);
+}
+
+// 除法按 RISC-V 规范处理除零与溢出
+unsigned div(unsigned a, unsigned b) {
+    if (b == 0) return -1u;
+    if (a == 0x80000000u && b == -1u) return a;
+    return (unsigned) ((int) a / (int) b);
+}
+unsigned divu(unsigned a, unsigned b) { return b == 0 ? -1u : a / b; }
+unsigned rem(unsigned a, unsigned b) {
+    if (b == 0) return a;
+    if (a == 0x80000000u && b == -1u) return 0;
+    return (unsigned) ((int) a % (int) b);
+}
+unsigned remu(unsigned a, unsigned b) { return b == 0 ? a : a % b; }
+
+bool beq(unsigned a, unsigned b) { return a == b; }
+bool bne(unsigned a, unsigned b) { return a != b; }
+bool blt(unsigned a, unsigned b) { return (int) a < (int) b; }
+bool bge(unsigned a, unsigned b) { return (int) a >= (int) b; }
+bool bltu(unsigned a, unsigned b) { return a < b; }
+bool bgeu(unsigned a, unsigned b) { return a >= b; }
+
+}  // namespace
+
+struct FunctionalHandlers {
+    using Op = FunctionalOp;
+
+    template <unsigned (*f)(unsigned, unsigned)>
+    static const Op *reg(FunctionalCore &core, const Op *op) {
+        core.reg[op->rd] = f(core.reg[op->rs1], core.reg[op->rs2]);
+        return op + 1;
+    }
+
+    template <unsigned (*f)(unsigned, unsigned)>
+    static const Op *imm(FunctionalCore &core, const Op *op) {
+        core.reg[op->rd] = f(core.reg[op->rs1], op->imm);
+        return op + 1;
+    }
+
+    template <bool (*f)(unsigned, unsigned)>
+    static const Op *branch(FunctionalCore &core, const Op *op) {
+        bool taken = f(core.reg[op->rs1], core.reg[op->rs2]);
+        core.pc = taken ? op->pc + op->imm : op->pc + 4;
+        if (core.observer != nullptr) core.controlTransfer(op, true, taken);
+        return nullptr;
+    }
+
+    static const Op *lui(FunctionalCore &core, const Op *op) {
+        core.reg[op->rd] = op->imm;
+        return op + 1;
+    }
+
+    static const Op *auipc(FunctionalCore &core, const Op *op) {
+        core.reg[op->rd] = op->pc + op->imm;
+        return op + 1;
+    }
+
+    static const Op *jal(FunctionalCore &core, const Op *op) {
+        core.reg[op->rd] = op->pc + 4;
+        core.pc = op->pc + op->imm;
+        if (core.observer != nullptr) core.controlTransfer(op, false, true);
+        return nullptr;
+    }
+
+    static const Op *jalr(FunctionalCore &core, const Op *op) {
+        unsigned target = core.reg[op->rs1] + op->imm;
+        core.reg[op->rd] = op->pc + 4;
+        core.pc = target;
+        if (core.observer != nullptr) core.controlTransfer(op, false, true);
+        return nullptr;
+    }
+
+    static const Op *lw(FunctionalCore &core, const Op *op) {
+        core.reg[op->rd] = core.loadWord(core.reg[op->rs1] + op->imm);
+        return op + 1;
+    }
+
+    template <bool sign>
+    static const Op *lh(FunctionalCore &core, const Op *op) {
+        unsigned address = core.reg[op->rs1] + op->imm;
+        unsigned value = core.loadWord(address);
+        value = (address & 2u) ? value >> 16u : value & 0xFFFFu;
+        if (sign && (value & 0x8000u)) value |= 0xFFFF0000u;
+        core.reg[op->rd] = value;
+        return op + 1;
+    }
+
+    template <bool sign>
+    static const Op *lb(FunctionalCore &core, const Op *op) {
+        unsigned address = core.reg[op->rs1] + op->imm;
+        unsigned value = (core.loadWord(address) >> ((address & 3u) << 3u)) &
+                         0xFFu;
+        if (sign && (value & 0x80u)) value |= 0xFFFFFF00u;
+        core.reg[op->rd] = value;
+        return op + 1;
+    }
+
+    static const Op *sw(FunctionalCore &core, const Op *op) {
+        core.storeWord(
+            core.reg[op->rs1] + op->imm, core.reg[op->rs2], 0xFFFFFFFFu);
+        return op + 1;
+    }
+
+    static const Op *sh(FunctionalCore &core, const Op *op) {
+        unsigned address = core.reg[op->rs1] + op->imm;
+        unsigned shift = (address & 2u) << 3u;
+        core.storeWord(address,
+                       (core.reg[op->rs2] & 0xFFFFu) << shift,
+                       0xFFFFu << shift);
+        return op + 1;
+    }
+
+    static const Op *sb(FunctionalCore &core, const Op *op) {
+        unsigned address = core.reg[op->rs1] + op->imm;
+        unsigned shift = (address & 3u) << 3u;
+        core.storeWord(
+            address, (core.reg[op->rs2] & 0xFFu) << shift, 0xFFu << shift);
+        return op + 1;
+    }
+
+    static const Op *nop([[maybe_unused]] FunctionalCore &core, const Op *op) {
+        return op + 1;
+    }
+
+    static const Op *exit(FunctionalCore &core, const Op *op) {
+        core.exited = true;
+        core.pc = op->pc;
+        return nullptr;
+    }
+
+    // 基本块超长被截断时，顺序进入下一块
+    static const Op *fallthrough(FunctionalCore &core, const Op *op) {
+        core.pc = op->pc;
+        return nullptr;
+    }
+
+    // 无法识别的编码，与周期级模型一样抛出 std::invalid_argument
+    static const Op *invalid(FunctionalCore &core, const Op *op) {
+        core.pc = op->pc;
+        std::stringstream ss;
+        ss << "Instruction 0x" << std::hex << op->imm << " not implemented.";
+        Logger::Error("Functional core: invalid instruction at 0x%08x",
+                      op->pc);
+        throw std::invalid_argument(ss.str());
+    }
+
+    static const Op *unsupported(FunctionalCore &core, const Op *op) {
+        core.pc = op->pc;
+        std::stringstream ss;
+        ss << Instruction(op->imm);
+        Logger::Error("Functional core: unsupported instruction %s at 0x%08x",
+                      ss.str().c_str(),
+                      op->pc);
+        throw std::runtime_error("Unsupported instruction executed");
+    }
+
+    static FunctionalHandler of(Opcode opcode) {
+        switch (opcode) {
+        case Opcode::LUI:
+            return lui;
+        case Opcode::AUIPC:
+            return auipc;
+        case Opcode::JAL:
+            return jal;
+        case Opcode::JALR:
+            return jalr;
+        case Opcode::BEQ:
+            return branch<beq>;
+        case Opcode::BNE:
+            return branch<bne>;
+        case Opcode::BLT:
+            return branch<blt>;
+        case Opcode::BGE:
+            return branch<bge>;
+        case Opcode::BLTU:
+            return branch<bltu>;
+        case Opcode::BGEU:
+            return branch<bgeu>;
+        case Opcode::LB:
+            return lb<true>;
+        case Opcode::LH:
+            return lh<true>;
+        case Opcode::LW:
+            return lw;
+        case Opcode::LBU:
+            return lb<false>;
+        case Opcode::LHU:
+            return lh<false>;
+        case Opcode::SB:
+            return sb;
+        case Opcode::SH:
+            return sh;
+        case Opcode::SW:
+            return sw;
+        case Opcode::ADDI:
+            return imm<add>;
+        case Opcode::SLTI:
+            return imm<slt>;
+        case Opcode::SLTIU:
+            return imm<sltu>;
+        case Opcode::XORI:
+            return imm<bitXor>;
+        case Opcode::ORI:
+            return imm<bitOr>;
+        case Opcode::ANDI:
+            return imm<bitAnd>;
+        case Opcode::SLLI:
+            return imm<sll>;
+        case Opcode::SRLI:
+            return imm<srl>;
+        case Opcode::SRAI:
+            return imm<sra>;
+        case Opcode::ADD:
+            return reg<add>;
+        case Opcode::SUB:
+            return reg<sub>;
+        case Opcode::SLL:
+            return reg<sll>;
+        case Opcode::SLT:
+            return reg<slt>;
+        case Opcode::SLTU:
+            return reg<sltu>;
+        case Opcode::XOR:
+            return reg<bitXor>;
+        case Opcode::SRL:
+            return reg<srl>;
+        case Opcode::SRA:
+            return reg<sra>;
+        case Opcode::OR:
+            return reg<bitOr>;
+        case Opcode::AND:
+            return reg<bitAnd>;
+        case Opcode::MUL:
+            return reg<mul>;
+        case Opcode::MULH:
+            return reg<mulh>;
+        case Opcode::MULHSU:
+            return reg<mulhsu>;
+        case Opcode::MULHU:
+            return reg<mulhu>;
+        case Opcode::DIV:
+            return reg<div>;
+        case Opcode::DIVU:
+            return reg<divu>;
+        case Opcode::REM:
+            return reg<rem>;
+        case Opcode::REMU:
+            return reg<remu>;
+        case Opcode::FENCE:
+            return nop;
+        case Opcode::EXIT:
+            return exit;
+        case Opcode::INVALID:
+            return invalid;
+        default:
+            return unsupported;
+        }
+    }
+};
+
+FunctionalCore::FunctionalCore(RegisterFile &regFile, Memory &memory)
+    : regFile(&regFile), memory(&memory),
+      image(std::make_shared<ProgramImage>()), reg(), pc(0x80000000u),
+      exited(false), observer(nullptr) {}
+
+/**
+ * @brief 装载程序映像，清空已翻译的基本块
+ *
+ * @param image 程序映像，只使用其指令区
+ * @param entry 程序入口
+ */
+void FunctionalCore::reset(const ProgramImagePtr &image, unsigned entry) {
+    this->image = image;
+    blocks.clear();
+    jump(entry);
+}
+
+/**
+ * @brief 装载程序，清空已翻译的基本块
+ *
+ * @param inst 从 0x80000000 开始的指令区
+ * @param entry 程序入口
+ */
+void FunctionalCore::reset(const std::vector<unsigned> &inst, unsigned entry) {
+    reset(makeProgramImage(inst, {}, entry), entry);
+}
+
+/**
+ * @brief 修改下一条执行的指令地址
+ *
+ * @param address
+ */
+void FunctionalCore::jump(unsigned address) {
+    pc = address;
+    exited = false;
+}
+
+/**
+ * @brief 执行指令，直到提交 EXIT 或执行了指定条数
+ *
+ * @param maxInstructions 最多执行的指令条数
+ * @return unsigned long 实际执行的指令条数（包括 EXIT）
+ */
+unsigned long FunctionalCore::run(unsigned long maxInstructions) {
+    for (unsigned i = 0; i < 32; i++) reg[i] = regFile->read(i);
+    reg[0] = 0;
+
+    auto writeBack = [this]() {
+        for (unsigned i = 1; i < 32; i++) regFile->functionalWrite(i, reg[i]);
+    };
+
+    unsigned long executed = 0;
+    FunctionalBlock *block = nullptr;
+    try {
+        while (!exited && executed < maxInstructions) {
+            block = block == nullptr ? lookup(pc) : chain(block);
+            const FunctionalOp *op = block->ops.data();
+            unsigned long remaining = maxInstructions - executed;
+            if (block->length <= remaining) {
+                if (observer != nullptr)
+                    observer->onBlock(block->pc, block->length);
+                do {
+                    op = op->handler(*this, op);
+                } while (op != nullptr);
+                executed += block->length;
+            } else {
+                // 剩余条数不足一个基本块，逐条执行后停在块中间
+                if (observer != nullptr)
+                    observer->onBlock(block->pc, (unsigned) remaining);
+                for (unsigned long i = 0; i < remaining; i++) {
+                    op = op->handler(*this, op);
+                }
+                pc = op->pc;
+                executed += remaining;
+            }
+        }
+    } catch (...) {
+        writeBack();
+        throw;
+    }
+    writeBack();
+    return executed;
+}
+
+/**
+ * @brief 查找以 address 开始的基本块，未翻译时进行翻译
+ *
+ * @param address
+ * @return FunctionalBlock*
+ */
+FunctionalBlock *FunctionalCore::lookup(unsigned address) {
+    auto it = blocks.find(address);
+    if (it != blocks.end()) return it->second.get();
+    return translate(address);
+}
+
+/**
+ * @brief 查找当前 pc 对应的后继块，并记录到前驱块的链接项中
+ *
+ * @param block 刚执行完的基本块
+ * @return FunctionalBlock*
+ */
+FunctionalBlock *FunctionalCore::chain(FunctionalBlock *block) {
+    for (unsigned i = 0; i < 2; i++) {
+        if (block->successor[i] != nullptr && block->successorPC[i] == pc) {
+            return block->successor[i];
+        }
+    }
+    FunctionalBlock *next = lookup(pc);
+    unsigned slot = block->replaceSlot;
+    block->replaceSlot ^= 1u;
+    block->successor[slot] = next;
+    block->successorPC[slot] = pc;
+    return next;
+}
+
+/**
+ * @brief 将从 address 开始的基本块翻译为处理函数数组
+ * 遇到跳转、EXIT 或无法执行的指令时结束
+ *
+ * @param address
+ * @return FunctionalBlock*
+ */
+FunctionalBlock *FunctionalCore::translate(unsigned address) {
+    auto block = std::make_unique<FunctionalBlock>();
+    block->pc = address;
+    block->length = 0;
+    block->successor[0] = block->successor[1] = nullptr;
+    block->successorPC[0] = block->successorPC[1] = 0;
+    block->replaceSlot = 0;
+
+    unsigned p = address;
+    while (true) {
+        unsigned index = (p - 0x80000000u) >> 2u;
+        unsigned word = image->word(index);
+        Instruction inst = Instruction::predecode(word);
+
+        FunctionalOp op{};
+        op.handler = FunctionalHandlers::of(inst.opcode);
+        op.imm = inst.getImmediate();
+        op.pc = p;
+        op.rd = inst.getRd() == 0 ? DISCARD_REG : inst.getRd();
+        op.rs1 = inst.getRs1();
+        op.rs2 = inst.getRs2();
+
+        bool terminate = inst.fuType == FUType::BRU ||
+                         inst.opcode == Opcode::EXIT ||
+                         inst.opcode == Opcode::INVALID;
+        if (op.handler == FunctionalHandlers::unsupported ||
+            inst.opcode == Opcode::INVALID) {
+            op.imm = word;
+            terminate = true;
+        }
+        block->ops.push_back(op);
+        block->length++;
+
+        if (terminate) break;
+        p += 4;
+        if (block->length == MAX_BLOCK_LENGTH) {
+            FunctionalOp next{};
+            next.handler = FunctionalHandlers::fallthrough;
+            next.pc = p;
+            block->ops.push_back(next);
+            break;
+        }
+    }
+
+    auto *ret = block.get();
+    blocks[address] = std::move(block);
+    return ret;
+}
+
+/**
+ * @brief 读取数据内存中的一个字，地址须在 0x80400000 ~ 0x807FFFFF
+ *
+ * @param address 字节地址
+ * @return unsigned
+ */
+unsigned FunctionalCore::loadWord(unsigned address) const {
+    if (address < 0x80400000u || address >= 0x80800000u) {
+        Logger::Error("Functional core: load from 0x%08x out of data memory",
+                      address);
+        throw std::runtime_error("Data Memory Access Address is out of range");
+    }
+    if (observer != nullptr) observer->onDataAccess(address, false);
+    return memory->functionalRead((address - 0x80400000u) >> 2u);
+}
+
+/**
+ * @brief 按位掩码写入数据内存中的一个字
+ *
+ * @param address 字节地址
+ * @param value 已移位到对应字节的数据
+ * @param byteMask 需要写入的位
+ */
+void FunctionalCore::storeWord(unsigned address,
+                               unsigned value,
+                               unsigned byteMask) {
+    if (address < 0x80400000u || address >= 0x80800000u) {
+        Logger::Error("Functional core: store to 0x%08x out of data memory",
+                      address);
+        throw std::runtime_error("Data Memory Access Address is out of range");
+    }
+    if (observer != nullptr) observer->onDataAccess(address, true);
+    unsigned index = (address - 0x80400000u) >> 2u;
+    unsigned old = memory->functionalRead(index);
+    memory->functionalWrite(index, (old & ~byteMask) | (value & byteMask));
+}
+
+/**
+ * @brief 向观察者报告一条已执行的跳转或分支指令，此时 pc 已更新为跳转结果
+ *
+ * @param op 跳转或分支指令
+ * @param isBranch 是否为条件分支
+ * @param taken 是否跳转
+ */
+void FunctionalCore::controlTransfer(const FunctionalOp *op,
+                                     bool isBranch,
+                                     bool taken) {
+    BpuUpdateData x{};
+    x.pc = op->pc;
+    x.isBranch = isBranch;
+    x.isCall = !isBranch && op->handler == FunctionalHandlers::jal &&
+               op->rd == 1;
+    x.isReturn = !isBranch && op->handler == FunctionalHandlers::jalr &&
+                 op->rs1 == 1;
+    x.branchTaken = taken;
+    x.jumpTarget = taken ? pc : op->pc + op->imm;
+    observer->onControlTransfer(x);
+}
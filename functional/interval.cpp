@@ -0,0 +1,230 @@
+#include "interval.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "fast_forward.h"
+#include "logger.h"
+#include "with_predict.h"
+
+namespace {
+
+// 估计的周期数中与暴露系数无关的部分，以及各系数所乘的量
+struct IntervalTerms {
+    double base = 0;
+    double branch = 0;
+    double memory = 0;
+    double resolve = 0;
+    double longLatency = 0;
+    double hit = 0;
+    double miss = 0;
+};
+
+/**
+ * @brief 把事件数换算为估计周期数的各项
+ * 主存只有一个端口且不流水，没有 Cache 时每次访存的延迟都完全暴露；
+ * 有 Cache 时命中只多占用 LSU，缺失需要逐字读入整块
+ *
+ * @param config 区间模型的参数
+ * @param x 事件数
+ * @return IntervalTerms
+ */
+IntervalTerms getTerms(const IntervalConfig &config, const IntervalResult &x) {
+    const auto &machine = config.machine;
+    auto latency = [&machine](FUType type) {
+        return machine.fuLatency[static_cast<int>(type)];
+    };
+    IntervalTerms terms;
+    terms.base = (double) x.instructions / config.dispatchWidth;
+    terms.branch = (double) x.mispredicts * config.frontendDepth;
+    terms.resolve = (double) x.mispredicts;
+    terms.longLatency = (double) x.multiplies * (latency(FUType::MUL) - 1) +
+                        (double) x.divides * (latency(FUType::DIV) - 1);
+    if (machine.type != ProcessorType::cache) {
+        terms.memory = (double) x.memoryAccesses * machine.latency;
+    } else {
+        double fill = machine.latency + machine.blockSize / 4 - 1;
+        terms.hit = (double) x.cacheHits * (latency(FUType::LSU) - 1);
+        terms.miss = (double) (x.cacheMisses + x.writebacks) * fill;
+    }
+    return terms;
+}
+
+}  // namespace
+
+IntervalModel::IntervalModel(const IntervalConfig &config,
+                             const ProgramImagePtr &image,
+                             const Memory &memory)
+    : config(config), image(image), memory(&memory) {
+    const auto &machine = config.machine;
+    machine.validate();
+    if (machine.type == ProcessorType::predict)
+        predictor = std::make_unique<FrontendWithPredict>(
+            std::vector<unsigned>(), machine);
+    else
+        predictor = std::make_unique<Frontend>(std::vector<unsigned>());
+    if (machine.type == ProcessorType::cache)
+        dcache = std::make_unique<Cache>(machine.cacheSize,
+                                         machine.blockSize,
+                                         machine.associativity,
+                                         machine.writeThrough,
+                                         machine.replaceType,
+                                         machine.seed);
+}
+
+void IntervalModel::onDataAccess(unsigned address, bool write) {
+    result.memoryAccesses++;
+    if (dcache == nullptr) return;
+    switch (dcache->warm(address & ~0x3u, write, *memory)) {
+    case CacheAccess::HIT:
+        result.cacheHits++;
+        break;
+    case CacheAccess::WRITEBACK:
+        result.writebacks++;
+        [[fallthrough]];
+    case CacheAccess::MISS:
+        result.cacheMisses++;
+        break;
+    }
+}
+
+/**
+ * @brief 用前端计算的下一条 pc 判断是否预测错误，再按提交时的方式更新预测器
+ *
+ * @param x 跳转或分支的执行结果
+ */
+void IntervalModel::onControlTransfer(const BpuUpdateData &x) {
+    unsigned target = x.branchTaken ? x.jumpTarget : x.pc + 4;
+    if (predictor->calculateNextPC(x.pc) != target) result.mispredicts++;
+    predictor->bpuBackendUpdate(x);
+}
+
+void IntervalModel::onBlock(unsigned pc, unsigned length) {
+    result.instructions += length;
+    unsigned index = (pc - 0x80000000u) >> 2u;
+    for (unsigned i = 0; i < length && index + i < image->decoded.size();
+         i++) {
+        auto type = getFUType(image->decoded[index + i]);
+        if (type == FUType::MUL) result.multiplies++;
+        if (type == FUType::DIV) result.divides++;
+    }
+}
+
+/**
+ * @brief 由事件数估计周期数
+ *
+ * @return IntervalResult
+ */
+IntervalResult IntervalModel::estimate() const {
+    IntervalResult x = result;
+    auto terms = getTerms(config, x);
+    x.baseCycles = terms.base;
+    x.branchCycles = terms.branch + terms.resolve * config.resolveCycles;
+    x.longLatencyCycles = terms.longLatency * config.longLatencyExposure;
+    x.memoryCycles = terms.memory + terms.hit * config.hitExposure +
+                     terms.miss * config.missExposure;
+    x.cycles = std::lround(x.baseCycles + x.branchCycles +
+                           x.longLatencyCycles + x.memoryCycles);
+    return x;
+}
+
+/**
+ * @brief 用功能模型执行 elf 并由区间模型估计周期数，参数约定与 execute 相同
+ * 执行结束后体系结构状态留在 regFile 与 memory 中，可以直接核对结果
+ *
+ * @param name elf 路径
+ * @param config 区间模型的参数
+ * @param regFile 功能模型的寄存器堆
+ * @param memory 功能模型的数据内存
+ * @param args 4字节整型参数
+ * @return IntervalResult
+ */
+IntervalResult executeInterval(const std::string &name,
+                               const IntervalConfig &config,
+                               RegisterFile &regFile,
+                               Memory &memory,
+                               const std::vector<int> &args) {
+    auto image = loadGuest(name, regFile, memory, args);
+    FunctionalCore core(regFile, memory);
+    core.reset(image, image->entry);
+    IntervalModel model(config, image, memory);
+    core.setObserver(&model);
+    core.run();
+    return model.estimate();
+}
+
+/**
+ * @brief 由周期级模型的结果拟合暴露系数
+ * 估计的周期数对四个系数是线性的，每个样本按其周期数归一化后求解
+ * 最小二乘的正规方程。所有样本中都没有出现的事件不参与拟合，
+ * 对应的系数保持 base 中的值
+ *
+ * @param base 初始参数，样本中的机器描述替换其中的 machine
+ * @param samples 标定样本
+ * @return IntervalConfig 拟合后的参数
+ */
+IntervalConfig calibrateInterval(const IntervalConfig &base,
+                                 const std::vector<IntervalSample> &samples) {
+    constexpr unsigned N = 4;
+    double normal[N][N + 1] = {};
+    for (const auto &x : samples) {
+        if (x.cycles == 0) continue;
+        IntervalConfig config = base;
+        config.machine = x.machine;
+        auto terms = getTerms(config, x.events);
+        double row[N + 1] = {
+            terms.resolve,
+            terms.longLatency,
+            terms.hit,
+            terms.miss,
+            (double) x.cycles - terms.base - terms.branch - terms.memory};
+        for (double &value : row) value /= (double) x.cycles;
+        for (unsigned i = 0; i < N; i++)
+            for (unsigned j = 0; j <= N; j++) normal[i][j] += row[i] * row[j];
+    }
+
+    double coefficient[N] = {base.resolveCycles,
+                             base.longLatencyExposure,
+                             base.hitExposure,
+                             base.missExposure};
+    std::vector<unsigned> active;
+    for (unsigned i = 0; i < N; i++)
+        if (normal[i][i] > 0) active.push_back(i);
+
+    // 在出现过的事件上做带列主元的高斯消元
+    auto n = (unsigned) active.size();
+    std::vector<std::vector<double>> m(n, std::vector<double>(n + 1));
+    for (unsigned i = 0; i < n; i++) {
+        for (unsigned j = 0; j < n; j++) m[i][j] = normal[active[i]][active[j]];
+        m[i][n] = normal[active[i]][N];
+    }
+    for (unsigned k = 0; k < n; k++) {
+        unsigned pivot = k;
+        for (unsigned i = k + 1; i < n; i++)
+            if (std::fabs(m[i][k]) > std::fabs(m[pivot][k])) pivot = i;
+        std::swap(m[k], m[pivot]);
+        if (std::fabs(m[k][k]) <= 1e-12 * normal[active[k]][active[k]]) {
+            Logger::Error("Interval calibration: samples cannot separate the "
+                          "exposure coefficients");
+            throw std::invalid_argument("Too few calibration samples");
+        }
+        for (unsigned i = k + 1; i < n; i++) {
+            double factor = m[i][k] / m[k][k];
+            for (unsigned j = k; j <= n; j++) m[i][j] -= factor * m[k][j];
+        }
+    }
+    for (unsigned k = n; k-- > 0;) {
+        double value = m[k][n];
+        for (unsigned j = k + 1; j < n; j++)
+            value -= m[k][j] * coefficient[active[j]];
+        coefficient[active[k]] = value / m[k][k];
+    }
+
+    IntervalConfig config = base;
+    config.resolveCycles = coefficient[0];
+    config.longLatencyExposure = coefficient[1];
+    config.hitExposure = coefficient[2];
+    config.missExposure = coefficient[3];
+    return config;
+}
@@ -0,0 +1,459 @@
+#include "simpoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "fast_forward.h"
+#include "functional.h"
+#include "logger.h"
+
+namespace {
+
+// 随机投影后的维数，与 SimPoint 工具的默认值相同
+constexpr unsigned PROJECTED_DIMENSIONS = 15u;
+// 每个 k 重复聚类的次数，取失真最小的一次
+constexpr unsigned KMEANS_TRIES = 5u;
+constexpr unsigned KMEANS_ITERATIONS = 100u;
+// 选择 BIC 达到最大与最小值之间该比例的最小 k
+constexpr double BIC_THRESHOLD = 0.9;
+constexpr double PI = 3.14159265358979323846;
+
+using Point = std::vector<double>;
+
+/**
+ * @brief 按区间统计每个基本块执行的指令条数
+ */
+class BasicBlockCounter final : public FunctionalObserver {
+    std::unordered_map<unsigned, unsigned> ids;
+    std::vector<unsigned long> counts;
+    std::vector<unsigned> touched;
+
+public:
+    void onDataAccess([[maybe_unused]] unsigned address,
+                      [[maybe_unused]] bool write) override {}
+    void onControlTransfer(
+        [[maybe_unused]] const BpuUpdateData &x) override {}
+
+    void onBlock(unsigned pc, unsigned length) override {
+        auto it = ids.find(pc);
+        unsigned id;
+        if (it == ids.end()) {
+            id = (unsigned) ids.size() + 1;
+            ids.emplace(pc, id);
+            counts.push_back(0);
+        } else {
+            id = it->second;
+        }
+        if (counts[id - 1] == 0) touched.push_back(id);
+        counts[id - 1] += length;
+    }
+
+    // 取出当前区间的基本块向量并清零
+    BasicBlockVector take() {
+        std::sort(touched.begin(), touched.end());
+        BasicBlockVector ret;
+        ret.reserve(touched.size());
+        for (auto id : touched) {
+            ret.emplace_back(id, counts[id - 1]);
+            counts[id - 1] = 0;
+        }
+        touched.clear();
+        return ret;
+    }
+
+    [[nodiscard]] unsigned getBlockCount() const {
+        return (unsigned) ids.size();
+    }
+};
+
+double distance(const Point &a, const Point &b) {
+    double sum = 0;
+    for (unsigned i = 0; i < a.size(); i++)
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return sum;
+}
+
+struct Clustering {
+    std::vector<Point> centers;
+    std::vector<unsigned> assignment;
+    double distortion;
+};
+
+/**
+ * @brief k-means 聚类，使用 k-means++ 选择初始中心
+ *
+ * @param points
+ * @param k
+ * @param engine
+ * @return Clustering
+ */
+Clustering kmeans(const std::vector<Point> &points,
+                  unsigned k,
+                  std::mt19937 &engine) {
+    Clustering ret;
+    std::uniform_int_distribution<unsigned> first(0, points.size() - 1);
+    ret.centers.push_back(points[first(engine)]);
+    std::vector<double> nearest(points.size());
+    while (ret.centers.size() < k) {
+        double total = 0;
+        for (unsigned i = 0; i < points.size(); i++) {
+            nearest[i] = std::numeric_limits<double>::max();
+            for (const auto &c : ret.centers)
+                nearest[i] = std::min(nearest[i], distance(points[i], c));
+            total += nearest[i];
+        }
+        if (total == 0) break;
+        std::uniform_real_distribution<double> pick(0, total);
+        double target = pick(engine);
+        unsigned chosen = 0;
+        while (chosen + 1 < points.size() && target > nearest[chosen]) {
+            target -= nearest[chosen];
+            chosen++;
+        }
+        ret.centers.push_back(points[chosen]);
+    }
+
+    ret.assignment.assign(points.size(), 0);
+    for (unsigned iteration = 0; iteration < KMEANS_ITERATIONS; iteration++) {
+        bool changed = iteration == 0;
+        for (unsigned i = 0; i < points.size(); i++) {
+            unsigned best = 0;
+            for (unsigned c = 1; c < ret.centers.size(); c++) {
+                if (distance(points[i], ret.centers[c]) <
+                    distance(points[i], ret.centers[best]))
+                    best = c;
+            }
+            if (best != ret.assignment[i]) changed = true;
+            ret.assignment[i] = best;
+        }
+        if (!changed) break;
+
+        std::vector<unsigned> size(ret.centers.size(), 0);
+        for (auto &c : ret.centers) std::fill(c.begin(), c.end(), 0);
+        for (unsigned i = 0; i < points.size(); i++) {
+            auto &c = ret.centers[ret.assignment[i]];
+            for (unsigned d = 0; d < c.size(); d++) c[d] += points[i][d];
+            size[ret.assignment[i]]++;
+        }
+        for (unsigned c = 0; c < ret.centers.size(); c++) {
+            if (size[c] == 0) continue;
+            for (auto &x : ret.centers[c]) x /= size[c];
+        }
+    }
+
+    ret.distortion = 0;
+    for (unsigned i = 0; i < points.size(); i++)
+        ret.distortion += distance(points[i], ret.centers[ret.assignment[i]]);
+    return ret;
+}
+
+/**
+ * @brief 按球形高斯模型计算聚类结果的 BIC，越大越好
+ *
+ * @param points
+ * @param clustering
+ * @return double
+ */
+double bic(const std::vector<Point> &points, const Clustering &clustering) {
+    double r = points.size();
+    double m = points[0].size();
+    double k = clustering.centers.size();
+    if (r <= k) return -std::numeric_limits<double>::max();
+
+    double variance = clustering.distortion / (r - k);
+    if (variance <= 0) variance = std::numeric_limits<double>::min();
+
+    std::vector<double> size(clustering.centers.size(), 0);
+    for (auto c : clustering.assignment) size[c]++;
+
+    double likelihood = 0;
+    for (auto rn : size) {
+        if (rn == 0) continue;
+        likelihood += -rn / 2 * std::log(2 * PI) -
+                      rn * m / 2 * std::log(variance) - (rn - k) / 2 +
+                      rn * std::log(rn) - rn * std::log(r);
+    }
+    double parameters = (k - 1) + m * k + 1;
+    return likelihood - parameters / 2 * std::log(r);
+}
+
+}  // namespace
+
+/**
+ * @brief 用功能模型执行程序，按固定长度的区间统计基本块向量
+ * 参数约定与 execute 相同
+ *
+ * @param name elf 路径
+ * @param intervalSize 每个区间的指令条数
+ * @param argc 参数数量
+ * @param ... 4字节整型参数
+ * @return BasicBlockProfile
+ */
+BasicBlockProfile profileBasicBlocks(const std::string &name,
+                                     unsigned long intervalSize,
+                                     int argc,
+                                     ...) {
+    if (intervalSize == 0) {
+        Logger::Error("Basic block vector interval must be positive");
+        throw std::invalid_argument("Invalid interval size");
+    }
+
+    va_list args;
+    va_start(args, argc);
+    RegisterFile regFile;
+    Memory memory(0);
+    auto image = loadGuest(name, regFile, memory, argc, args);
+    va_end(args);
+
+    FunctionalCore core(regFile, memory);
+    core.reset(image, image->entry);
+    BasicBlockCounter counter;
+    core.setObserver(&counter);
+
+    BasicBlockProfile profile;
+    profile.intervalSize = intervalSize;
+    while (!core.hasExited()) {
+        unsigned long length = core.run(intervalSize);
+        if (length == 0) break;
+        profile.intervals.push_back(counter.take());
+        profile.lengths.push_back(length);
+        profile.instructions += length;
+    }
+    profile.blockCount = counter.getBlockCount();
+    return profile;
+}
+
+/**
+ * @brief 以 SimPoint 的 .bb 格式输出基本块向量，每个区间一行
+ *
+ * @param profile
+ * @param out
+ */
+void writeBasicBlockVectors(const BasicBlockProfile &profile,
+                            std::ostream &out) {
+    for (const auto &bbv : profile.intervals) {
+        out << "T";
+        for (const auto &x : bbv)
+            out << ":" << x.first << ":" << x.second << " ";
+        out << "\n";
+    }
+}
+
+/**
+ * @brief 对基本块向量聚类，每类选出离中心最近的区间作为代表
+ * 向量先按区间长度归一化，再随机投影到低维空间；k 从 1 到 maxK 中
+ * 选取 BIC 足够好的最小值
+ *
+ * @param profile
+ * @param maxK 最多的聚类数
+ * @param seed 随机投影与初始中心的种子
+ * @return std::vector<SimPoint> 按区间编号排序
+ */
+std::vector<SimPoint> chooseSimPoints(const BasicBlockProfile &profile,
+                                      unsigned maxK,
+                                      unsigned seed) {
+    unsigned n = profile.intervals.size();
+    if (n == 0) return {};
+
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    std::vector<Point> projection(profile.blockCount + 1,
+                                  Point(PROJECTED_DIMENSIONS));
+    for (auto &row : projection)
+        for (auto &x : row) x = uniform(engine);
+
+    std::vector<Point> points(n, Point(PROJECTED_DIMENSIONS, 0));
+    for (unsigned i = 0; i < n; i++) {
+        for (const auto &x : profile.intervals[i]) {
+            double w = (double) x.second / (double) profile.lengths[i];
+            for (unsigned d = 0; d < PROJECTED_DIMENSIONS; d++)
+                points[i][d] += w * projection[x.first][d];
+        }
+    }
+
+    std::vector<Clustering> results;
+    std::vector<double> scores;
+    for (unsigned k = 1; k <= std::min(maxK, n); k++) {
+        Clustering best;
+        best.distortion = std::numeric_limits<double>::max();
+        for (unsigned t = 0; t < KMEANS_TRIES; t++) {
+            auto c = kmeans(points, k, engine);
+            if (c.distortion < best.distortion) best = std::move(c);
+        }
+        scores.push_back(bic(points, best));
+        results.push_back(std::move(best));
+    }
+
+    double low = *std::min_element(scores.begin(), scores.end());
+    double high = *std::max_element(scores.begin(), scores.end());
+    unsigned chosen = 0;
+    while (scores[chosen] < low + BIC_THRESHOLD * (high - low)) chosen++;
+    const auto &clustering = results[chosen];
+    Logger::Warn("Chose %u clusters for %u intervals",
+                 (unsigned) clustering.centers.size(),
+                 n);
+
+    std::vector<SimPoint> ret;
+    for (unsigned c = 0; c < clustering.centers.size(); c++) {
+        unsigned long instructions = 0;
+        unsigned representative = n;
+        for (unsigned i = 0; i < n; i++) {
+            if (clustering.assignment[i] != c) continue;
+            instructions += profile.lengths[i];
+            if (representative == n ||
+                distance(points[i], clustering.centers[c]) <
+                    distance(points[representative], clustering.centers[c]))
+                representative = i;
+        }
+        if (representative == n) continue;
+        ret.push_back({representative,
+                       (unsigned) ret.size(),
+                       (double) instructions / (double) profile.instructions});
+    }
+    std::sort(ret.begin(), ret.end(), [](const SimPoint &a, const SimPoint &b) {
+        return a.interval < b.interval;
+    });
+    return ret;
+}
+
+/**
+ * @brief 以 SimPoint 的格式输出代表区间与权重，每行为“数值 聚类编号”
+ *
+ * @param points
+ * @param simpoints
+ * @param weights
+ */
+void writeSimPoints(const std::vector<SimPoint> &points,
+                    std::ostream &simpoints,
+                    std::ostream &weights) {
+    for (const auto &x : points) {
+        simpoints << x.interval << " " << x.cluster << "\n";
+        weights << x.weight << " " << x.cluster << "\n";
+    }
+}
+
+/**
+ * @brief 读取 writeSimPoints 或 SimPoint 工具输出的代表区间与权重
+ *
+ * @param simpoints
+ * @param weights
+ * @return std::vector<SimPoint> 按区间编号排序
+ */
+std::vector<SimPoint> readSimPoints(std::istream &simpoints,
+                                    std::istream &weights) {
+    std::map<unsigned, SimPoint> clusters;
+    unsigned long interval;
+    double weight;
+    unsigned cluster;
+    while (simpoints >> interval >> cluster)
+        clusters[cluster] = {interval, cluster, 0};
+    while (weights >> weight >> cluster) {
+        auto it = clusters.find(cluster);
+        if (it == clusters.end()) {
+            Logger::Error("Weight given for unknown cluster %u", cluster);
+            throw std::runtime_error("Invalid simpoint weights");
+        }
+        it->second.weight = weight;
+    }
+
+    std::vector<SimPoint> ret;
+    for (const auto &x : clusters) ret.push_back(x.second);
+    std::sort(ret.begin(), ret.end(), [](const SimPoint &a, const SimPoint &b) {
+        return a.interval < b.interval;
+    });
+    return ret;
+}
+
+/**
+ * @brief 只用周期级模型执行代表区间，按权重估计整个程序的周期数
+ * 功能模型从头执行到每个区间之前，经过功能预热后把状态装载进处理器，
+ * 再经过周期级预热测量该区间的 CPI
+ *
+ * @param p CPU
+ * @param name elf 路径
+ * @param points 代表区间
+ * @param config 区间长度与预热长度，区间长度须与统计时相同
+ * @param argc 参数数量
+ * @param ... 4字节整型参数
+ * @return SimPointResult
+ */
+SimPointResult executeSimPoints(ProcessorAbstract *p,
+                                const std::string &name,
+                                const std::vector<SimPoint> &points,
+                                const SimPointConfig &config,
+                                int argc,
+                                ...) {
+    va_list args;
+    va_start(args, argc);
+    RegisterFile regFile;
+    Memory memory(0);
+    auto image = loadGuest(name, regFile, memory, argc, args);
+    va_end(args);
+
+    FunctionalCore core(regFile, memory);
+    core.reset(image, image->entry);
+    WarmupRecorder recorder;
+
+    SimPointResult result;
+    unsigned long position = 0;
+    double weights = 0;
+    for (const auto &x : points) {
+        unsigned long start = x.interval * config.intervalSize;
+        if (start < position) {
+            Logger::Error("Simulation points overlap at interval %lu",
+                          x.interval);
+            throw std::invalid_argument("Overlapping simulation points");
+        }
+        unsigned long detailStart =
+            std::max(position,
+                     start - std::min(start, config.detailedWarmup));
+        unsigned long warmStart =
+            std::max(position,
+                     detailStart - std::min(detailStart, config.warmup));
+
+        position += core.run(warmStart - position);
+        recorder.clear();
+        core.setObserver(&recorder);
+        position += core.run(detailStart - position);
+        core.setObserver(nullptr);
+        if (core.hasExited()) {
+            Logger::Warn("Program exited before interval %lu", x.interval);
+            break;
+        }
+
+        transferState(p, image, regFile, memory, core.getPC());
+        recorder.replay(p);
+        bool exited =
+            runDetailed(p, start - detailStart, result.detailedCycles);
+        unsigned long cycles = result.detailedCycles;
+        unsigned long committed = p->getCommittedInstructions();
+        if (!exited)
+            runDetailed(p,
+                        start - detailStart + config.intervalSize,
+                        result.detailedCycles);
+
+        if (p->getCommittedInstructions() == committed) continue;
+        double cpi = (double) (result.detailedCycles - cycles) /
+                     (double) (p->getCommittedInstructions() - committed);
+        Logger::Warn("Interval %lu: CPI = %.4f, weight = %.4f",
+                     x.interval,
+                     cpi,
+                     x.weight);
+        result.cpi += cpi * x.weight;
+        weights += x.weight;
+        result.measuredPoints++;
+    }
+
+    // 功能模型执行完剩余部分以得到总指令条数
+    if (!core.hasExited()) position += core.run();
+    result.instructions = position;
+    if (weights != 0) result.cpi /= weights;
+    result.estimatedCycles = result.cpi * (double) result.instructions;
+    return result;
+}
@@ -0,0 +1,66 @@
+#include "fast_forward.h"
+#include "inst_trace.h"
+#include "logger.h"
+
+InstTraceRecorder::InstTraceRecorder(const ProgramImagePtr &image,
+                                     InstTraceWriter &writer)
+    : image(image), writer(&writer) {}
+
+void InstTraceRecorder::onDataAccess(unsigned address,
+                                     [[maybe_unused]] bool write) {
+    const auto &decoded = image->decoded;
+    while (nextAccess < block.size() &&
+           decoded[block[nextAccess].index].fuType != FUType::LSU)
+        nextAccess++;
+    if (nextAccess < block.size()) block[nextAccess++].value = address;
+}
+
+void InstTraceRecorder::onControlTransfer(const BpuUpdateData &x) {
+    if (block.empty()) return;
+    block.back().value = x.branchTaken ? x.jumpTarget : x.pc + 4;
+}
+
+void InstTraceRecorder::onBlock(unsigned pc, unsigned length) {
+    flush();
+    unsigned index = (pc - 0x80000000u) >> 2u;
+    for (unsigned i = 0; i < length; i++) block.push_back({index + i, 0});
+}
+
+/**
+ * @brief 写出当前基本块的记录，功能执行结束后应再调用一次
+ */
+void InstTraceRecorder::flush() {
+    for (const auto &x : block) writer->append(x);
+    block.clear();
+    nextAccess = 0;
+}
+
+/**
+ * @brief 用功能模型执行 elf 并写出指令追踪，参数约定与 execute 相同
+ *
+ * @param name elf 路径
+ * @param traceName 追踪文件名
+ * @param regFile 功能模型的寄存器堆
+ * @param memory 功能模型的数据内存
+ * @param args 4字节整型参数
+ * @return unsigned long 记录的指令条数
+ */
+unsigned long recordInstTrace(const std::string &name,
+                              const std::string &traceName,
+                              RegisterFile &regFile,
+                              Memory &memory,
+                              const std::vector<int> &args) {
+    auto image = loadGuest(name, regFile, memory, args);
+    InstTraceWriter writer(traceName, *image);
+    InstTraceRecorder recorder(image, writer);
+    FunctionalCore core(regFile, memory);
+    core.reset(image, image->entry);
+    core.setObserver(&recorder);
+    core.run();
+    recorder.flush();
+    writer.close();
+    Logger::Warn("Recorded %lu instructions into %s",
+                 writer.getCount(),
+                 traceName.c_str());
+    return writer.getCount();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "machine_config.h"
+#include "runner.h"
+
+// 周期级模型逐周期执行，区间模型由功能执行的事件估计周期数
+enum class TimingModel { detailed, interval };
+
+// 批量运行中的一个任务，未在清单中给出的参数取读取清单时给出的机器描述
+struct BatchJob {
+    std::string elf;
+    std::vector<int> args;
+    TimingModel model = TimingModel::detailed;
+    MachineConfig machine;
+};
+
+struct BatchResult {
+    unsigned long job = 0;
+    unsigned long cycles = 0;
+    unsigned long instructions = 0;
+    // 只有带 Cache 的处理器统计
+    unsigned long memoryAccesses = 0;
+    unsigned long cacheHits = 0;
+    double seconds = 0;
+    // 任务失败时为异常信息，成功时为空
+    std::string error;
+};
+
+enum class BatchFormat { CSV, JSON };
+
+std::vector<BatchJob> readBatchManifest(std::istream &in,
+                                        const MachineConfig &base);
+BatchResult runBatchJob(const BatchJob &job);
+// 每个任务完成时回调 done，回调之间互斥；返回值按任务顺序排列
+std::vector<BatchResult> runBatch(
+    const std::vector<BatchJob> &jobs,
+    unsigned threads,
+    const std::function<void(const BatchResult &)> &done = nullptr);
+
+void writeBatchHeader(std::ostream &out, BatchFormat format);
+void writeBatchResult(std::ostream &out,
+                      BatchFormat format,
+                      const BatchJob &job,
+                      const BatchResult &result);
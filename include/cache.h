@@ -1,12 +1,18 @@
+#pragma once
+
 #include <array>
 #include <memory>
 #include <optional>
 #include <random>
 
 #include "mem.h"
+#include "trace.h"
 
 enum class ReplaceType { FIFO, LRU, RANDOM };
 
+// 不建模时序的访问结果，WRITEBACK 表示缺失且替换出了脏块
+enum class CacheAccess { HIT, MISS, WRITEBACK };
+
 struct CacheBlock {
     size_t size;
     unsigned tag;
@@ -42,6 +48,11 @@ class Cache {
     unsigned replaceID;
     unsigned saveOffset;
 
+    // RANDOM 替换使用的随机数发生器，每个 Cache 独立，与主存的延迟发生器相同；
+    // reset 时以 seed 重新播种
+    const int seed;
+    std::default_random_engine engine;
+
     // Next replace pointers
     std::vector<unsigned> fifoPointers;
     // Elements closer to the front of the array is less recently used
@@ -51,13 +62,25 @@ class Cache {
     unsigned occupyAddress;
     bool occupyWriteFlag;
 
+    // 命中、缺失与替换的累计次数，用于判断 Cache 状态是否变化
+    unsigned long activity;
+
+    void recordEvent(TraceEvent event,
+                     unsigned address,
+                     unsigned value,
+                     unsigned unit) {
+        activity++;
+        Tracer::recordAccess(event, address, value, unit);
+    }
+
 public:
     // Due to architecture limitations, cache is always write allocated.
     Cache(unsigned size,
           unsigned blockSize,
           unsigned associativity,
           bool writeThrough,
-          ReplaceType replaceType);
+          ReplaceType replaceType,
+          int seed = 0);
 
     // send in aligned physical address and byteEnable
     std::optional<unsigned> query(unsigned physAddr,
@@ -73,7 +96,13 @@ public:
                unsigned byteEnable,
                bool &cacheHit);
 
+    CacheAccess warm(unsigned physAddr, bool write, const Memory &memory);
+
     void resetState();
 
     void reset();
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
+
+    [[nodiscard]] unsigned long getActivity() const { return activity; }
 };
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "instructions.h"
+#include "issue_slot.h"
+
+constexpr char CHECKPOINT_MAGIC[8] = {'T', 'O', 'M', 'C', 'K', 'P', 'T', '0'};
+// 任何部件增删保存的字段时都需要递增
+constexpr unsigned CHECKPOINT_VERSION = 4u;
+
+// 检查点文件头，其后紧跟 payloadSize 字节的部件状态
+struct CheckpointHeader {
+    char magic[8];
+    unsigned version;
+    unsigned reserved;
+    unsigned long payloadSize;
+    // 部件状态的 FNV-1a 校验和
+    unsigned long checksum;
+};
+static_assert(sizeof(CheckpointHeader) == 32, "Checkpoint header changed");
+
+/**
+ * @brief 检查点写入端
+ * 各部件按固定顺序调用 save 依次写入自己的状态，整数按本机字节序保存。
+ * 每个部件以四字节标签开头，恢复时据此发现处理器类型或配置不一致
+ */
+class CheckpointWriter {
+    std::vector<unsigned char> buffer;
+
+public:
+    template <typename T>
+    void write(T x) {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>,
+                      "Only scalars are written directly");
+        writeBytes(&x, sizeof(T));
+    }
+    void write(const Instruction &x);
+    void write(const std::optional<Instruction> &x);
+    void write(const IssueSlot &x);
+    void write(const std::string &x);
+
+    void writeBytes(const void *source, size_t length);
+    void writeTag(const char *tag);
+
+    void saveFile(const std::string &file) const;
+};
+
+/**
+ * @brief 检查点读取端，读取顺序必须与写入顺序一致
+ * 文件损坏、版本不符或数据不足时报错并抛出异常
+ */
+class CheckpointReader {
+    std::vector<unsigned char> buffer;
+    size_t offset = 0;
+
+public:
+    explicit CheckpointReader(const std::string &file);
+
+    template <typename T>
+    void read(T &x) {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>,
+                      "Only scalars are read directly");
+        readBytes(&x, sizeof(T));
+    }
+    void read(Instruction &x);
+    void read(std::optional<Instruction> &x);
+    void read(IssueSlot &x);
+    void read(std::string &x);
+
+    void readBytes(void *target, size_t length);
+    void expectTag(const char *tag);
+    // 读取保存时的配置并与当前值比较，不一致时报错
+    template <typename T>
+    void expect(T current, const char *name) {
+        T saved;
+        read(saved);
+        if (saved != current) mismatch(name);
+    }
+
+    [[nodiscard]] bool atEnd() const { return offset == buffer.size(); }
+
+private:
+    [[noreturn]] void mismatch(const char *name) const;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "functional.h"
+#include "mem.h"
+#include "register_file.h"
+
+class ProcessorAbstract;
+struct DBTBlock;
+
+// 翻译代码可以访问的客户机状态，布局由生成的机器码直接使用
+struct DBTContext {
+    unsigned reg[32];
+    unsigned pc;
+    unsigned reserved;
+    // 剩余可执行的指令条数，每进入一个块减去其长度
+    long budget;
+    // 退出翻译代码的原因：0 无法链接，1 需要解释执行，其余为 DBTExit 指针
+    unsigned long lastExit;
+    Memory *memory;
+};
+
+struct DBTExit {
+    // 块尾 jmp 指令的 rel32 位置，链接后指向后继块
+    unsigned char *jump;
+    unsigned target;
+    DBTBlock *owner;
+    DBTBlock *linked;
+};
+
+struct DBTBlock {
+    unsigned pc;
+    unsigned length;
+    // 为 nullptr 时表示块首指令需交给解释器执行
+    unsigned char *code;
+    DBTExit exits[2];
+    unsigned exitCount;
+    // 已链接到本块的前驱出口，失效时需要恢复
+    std::vector<DBTExit *> incoming;
+};
+
+/**
+ * @brief 将 RV32IM 基本块翻译为 x86-64 机器码执行的快进引擎
+ * 翻译结果保存在可执行的 mmap 区域中，块与块之间直接跳转链接，
+ * 修改指令区时使覆盖到的翻译失效。EXIT、无法识别或出错的指令以及
+ * 不足一个块的剩余指令交给 FunctionalCore 执行；
+ * 非 x86-64 Linux 平台上全部由 FunctionalCore 解释执行
+ */
+class DBTCore {
+    RegisterFile *const regFile;
+    Memory *const memory;
+    FunctionalCore interpreter;
+
+    ProgramImagePtr image;
+    std::unordered_map<unsigned, std::unique_ptr<DBTBlock>> blocks;
+
+    unsigned char *codeBuffer;
+    unsigned long codeSize, codeUsed;
+    unsigned char *enter, *exitStub;
+    unsigned long generation;
+
+    DBTContext context;
+    bool exited;
+
+    DBTBlock *lookup(unsigned address);
+    DBTBlock *translate(unsigned address);
+    void link(DBTExit *exit, DBTBlock *block);
+    void invalidate(DBTBlock *block);
+    void flushCache();
+    unsigned long interpret(unsigned long maxInstructions);
+
+public:
+    DBTCore(RegisterFile &regFile, Memory &memory);
+    ~DBTCore();
+    DBTCore(const DBTCore &) = delete;
+    DBTCore &operator=(const DBTCore &) = delete;
+
+    void reset(const ProgramImagePtr &image, unsigned entry);
+    void reset(const std::vector<unsigned> &inst, unsigned entry);
+    void jump(unsigned address);
+    unsigned long run(unsigned long maxInstructions = -1ul);
+
+    void writeInstruction(unsigned address, unsigned value);
+    void transfer(ProcessorAbstract &processor) const;
+
+    [[nodiscard]] unsigned getPC() const { return context.pc; }
+    [[nodiscard]] bool hasExited() const { return exited; }
+    [[nodiscard]] bool isNative() const { return codeBuffer != nullptr; }
+};
@@ -18,11 +18,34 @@ unsigned readElf(const std::string &elfFileName,
 constexpr unsigned INST_MEM_SIZE = 0x400000u;
 // 4MB size
 constexpr unsigned DATA_MEM_SIZE = 0x400000u;
+// 4KB size, 快照与检查点按页管理数据内存
+constexpr unsigned MEMORY_PAGE_SIZE = 0x1000u;
+constexpr unsigned MEMORY_PAGE_WORDS = MEMORY_PAGE_SIZE >> 2u;
 
 enum class FUType { ALU, BRU, LSU, MUL, DIV, NONE };
 
+// 译码得到的指令编号，INVALID 表示无法识别的编码
+enum class Opcode {
+    // clang-format off
+    LUI, AUIPC, JAL, JALR,
+    BEQ, BNE, BLT, BGE, BLTU, BGEU,
+    LB, LH, LW, LBU, LHU,
+    SB, SH, SW,
+    ADDI, SLTI, SLTIU, XORI, ORI, ANDI, SLLI, SRLI, SRAI,
+    ADD, SUB, SLL, SLT, SLTU, XOR, SRL, SRA, OR, AND,
+    FENCE,
+    CSRRW, CSRRS, CSRRC, CSRRWI, CSRRSI, CSRRCI,
+    MUL, MULH, MULHSU, MULHU, DIV, DIVU, REM, REMU,
+    EXIT,
+    INVALID
+    // clang-format on
+};
+
 constexpr unsigned ROB_SIZE = 16u;
 
+// 每周期可写回的结果数，每个执行单元占用一个 CDB 槽
+constexpr unsigned CDB_WIDTH = 5u;
+
 constexpr unsigned MAX_CACHE_SIZE = 16384u;  // 16KB
 
 unsigned log2(unsigned int x);
\ No newline at end of file
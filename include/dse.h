@@ -0,0 +1,72 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "machine_config.h"
+
+enum class SearchStrategy { grid, random, hillClimb };
+
+// 设计空间的一维：机器配置中的一个键及其候选值，爬山法在相邻候选值之间移动
+struct DseParameter {
+    std::string key;
+    std::vector<std::string> values;
+};
+
+// 未作为维度的配置项取 base 中的值
+struct DseSpace {
+    MachineConfig base;
+    std::vector<DseParameter> parameters;
+};
+
+// 空间中的一点，为每一维候选值的下标
+using DsePoint = std::vector<unsigned>;
+
+struct DseOptions {
+    SearchStrategy strategy = SearchStrategy::random;
+    std::string elf;
+    std::vector<int> args;
+    unsigned threads = 0;
+    // 随机搜索的采样点数，爬山法评估的点数上限；网格搜索不使用
+    unsigned long samples = 64;
+    unsigned seed = 0;
+    // 片上存储超过该字节数的点不评估，0 表示不限制
+    unsigned long maxStorage = 0;
+    // 运行中的点已被 Pareto 前沿支配时提前停止
+    bool prune = true;
+    // 结果缓存文件，为空时不缓存
+    std::string cacheFile;
+};
+
+enum class DseStatus { done, pruned, failed };
+
+struct DseResult {
+    DsePoint point;
+    MachineConfig machine;
+    unsigned long long hash = 0;
+    // 片上存储的估计值，单位为字节
+    unsigned long storage = 0;
+    // 提前停止时为停止前执行的周期数，是实际周期数的下界
+    unsigned long cycles = 0;
+    unsigned long instructions = 0;
+    DseStatus status = DseStatus::failed;
+    // 结果取自缓存文件
+    bool cached = false;
+    // 属于最终的 Pareto 前沿
+    bool pareto = false;
+    std::string error;
+};
+
+DseSpace readDseSpace(const std::string &fileName, const MachineConfig &base);
+DseSpace defaultDseSpace(const MachineConfig &base);
+unsigned long estimateStorage(const MachineConfig &config);
+
+// 返回值按评估顺序排列，每个点至多评估一次
+std::vector<DseResult> exploreDesignSpace(const DseSpace &space,
+                                          const DseOptions &options);
+
+void writeDseHeader(std::ostream &out, const DseSpace &space);
+void writeDseResult(std::ostream &out,
+                    const DseSpace &space,
+                    const DseResult &result);
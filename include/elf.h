@@ -86,6 +86,10 @@ typedef struct {
     uint32_t sh_entsize;
 } elf32_shdr;
 
+/* p_type definitions */
+#define PT_NULL 0
+#define PT_LOAD 1 /* Loadable segment */
+
 typedef struct {
     uint32_t p_type;
     uint32_t p_offset; /* offset from beginning of file */
@@ -99,10 +103,10 @@ typedef struct {
 
 // table index 0 is reserved
 typedef struct {
-    uint16_t st_name;
+    uint32_t st_name; /* Index into string table */
     uint32_t st_value;
-    uint16_t st_size;
-    uint8_t st_info;
+    uint32_t st_size;
+    uint8_t st_info; /* Binding in high nibble, type in low nibble */
     uint8_t st_other;
     uint16_t st_shndx;
 } elf32_sym;
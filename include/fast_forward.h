@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdarg>
+#include <string>
+#include <vector>
+
+#include "functional.h"
+#include "processor.h"
+#include "with_cache.h"
+
+// 快进运行各阶段的指令条数
+struct FastForwardConfig {
+    // 仅做功能执行的指令条数
+    unsigned long fastForward = 0;
+    // 功能执行同时预热 Cache 与分支预测器的指令条数
+    unsigned long warmup = 0;
+    // 周期级模型执行的指令条数，0 表示执行到程序结束
+    unsigned long detail = 0;
+    // 快进阶段使用二进制翻译
+    bool native = false;
+};
+
+struct FastForwardResult {
+    unsigned long fastForwarded = 0;
+    unsigned long warmed = 0;
+    // 周期级模型提交的指令条数与使用的周期数
+    unsigned long committed = 0;
+    unsigned long cycles = 0;
+    // 程序是否已执行到 EXIT
+    bool finished = false;
+};
+
+FastForwardResult executeFastForward(ProcessorAbstract *p,
+                                     const std::string &name,
+                                     const FastForwardConfig &config,
+                                     int argc,
+                                     ...);
+
+// 周期采样运行的参数，每个周期依次为快进、功能预热、周期级预热与测量单元
+struct SamplingConfig {
+    // 相邻两个测量单元起点之间的指令条数
+    unsigned long period = 100000;
+    // 功能预热的指令条数
+    unsigned long warmup = 20000;
+    // 周期级预热的指令条数，不计入测量
+    unsigned long detailedWarmup = 2000;
+    // 每个测量单元的指令条数
+    unsigned long unit = 1000;
+    // CPI 置信区间半宽与均值之比达到该值后提前结束
+    double errorBound = 0.03;
+    // 双侧置信水平，位于 (0, 1)
+    double confidence = 0.95;
+    // 提前结束前至少需要的测量单元数
+    unsigned long minUnits = 30;
+};
+
+// 样本的均值与置信区间
+struct SampleStatistics {
+    unsigned long count = 0;
+    double sum = 0, sumSquares = 0;
+
+    void add(double x) {
+        count++;
+        sum += x;
+        sumSquares += x * x;
+    }
+    [[nodiscard]] double mean() const { return count == 0 ? 0 : sum / count; }
+    [[nodiscard]] double halfWidth(double z) const;
+};
+
+struct SamplingResult {
+    SampleStatistics cpi, hitRate;
+    // 功能模型执行的指令条数
+    unsigned long instructions = 0;
+    // 周期级模型使用的周期数，含预热
+    unsigned long detailedCycles = 0;
+    double z = 0;
+    // 程序执行到了 EXIT，否则为达到误差要求后提前结束
+    bool finished = false;
+};
+
+SamplingResult executeSampling(ProcessorWithCache *p,
+                               const std::string &name,
+                               const SamplingConfig &config,
+                               int argc,
+                               ...);
+
+/**
+ * @brief 记录预热阶段的访存与跳转
+ * 预热的结果要在体系结构状态装载进处理器之后才能写入，
+ * 否则会被 loadProgram 清空，因此先记录，装载后按原顺序重放
+ */
+class WarmupRecorder final : public FunctionalObserver {
+    struct Access {
+        unsigned address;
+        bool write;
+    };
+
+    std::vector<Access> accesses;
+    std::vector<BpuUpdateData> branches;
+
+public:
+    void onDataAccess(unsigned address, bool write) override {
+        accesses.push_back({address & ~0x3u, write});
+    }
+
+    void onControlTransfer(const BpuUpdateData &x) override {
+        branches.push_back(x);
+    }
+
+    void replay(ProcessorAbstract *p) const {
+        for (const auto &x : accesses) p->warmDataAccess(x.address, x.write);
+        for (const auto &x : branches) p->warmBranchPredictor(x);
+    }
+
+    void clear() {
+        accesses.clear();
+        branches.clear();
+    }
+};
+
+// 以下函数供快进、采样与 SimPoint 等运行方式共用
+ProgramImagePtr loadGuest(const std::string &name,
+                          RegisterFile &regFile,
+                          Memory &memory,
+                          int argc,
+                          va_list args);
+ProgramImagePtr loadGuest(const std::string &name,
+                          RegisterFile &regFile,
+                          Memory &memory,
+                          const std::vector<int> &args);
+void transferState(ProcessorAbstract *p,
+                   const ProgramImagePtr &image,
+                   const RegisterFile &regFile,
+                   const Memory &memory,
+                   unsigned pc);
+bool runDetailed(ProcessorAbstract *p,
+                 unsigned long instructions,
+                 unsigned long &cycles);
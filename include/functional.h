@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "instructions.h"
+#include "mem.h"
+#include "program_image.h"
+#include "register_file.h"
+
+class FunctionalCore;
+struct FunctionalOp;
+
+// 每条指令的处理函数，返回下一条要执行的指令，块结束时返回 nullptr
+using FunctionalHandler = const FunctionalOp *(*) (FunctionalCore &core,
+                                                  const FunctionalOp *op);
+
+struct FunctionalOp {
+    FunctionalHandler handler;
+    unsigned imm;
+    unsigned pc;
+    // rd 为 0 时被映射为 32 号“丢弃”寄存器
+    unsigned char rd, rs1, rs2;
+};
+
+/**
+ * @brief 功能执行过程的观察者，用于在快进时预热 Cache 与分支预测器
+ * 只有设置了观察者时才会回调，不影响普通功能执行的速度
+ */
+class FunctionalObserver {
+public:
+    virtual ~FunctionalObserver() = default;
+    // address 为字节地址，write 表示写访问
+    virtual void onDataAccess(unsigned address, bool write) = 0;
+    // 每条跳转或分支指令执行后回调，内容与提交时更新预测器的数据一致
+    virtual void onControlTransfer(const BpuUpdateData &x) = 0;
+    // 执行了以 pc 开始的基本块中的 length 条指令，用于基本块向量统计
+    virtual void onBlock([[maybe_unused]] unsigned pc,
+                         [[maybe_unused]] unsigned length) {}
+};
+
+struct FunctionalBlock {
+    unsigned pc;
+    // 块内客户指令条数，不含块尾补充的顺序执行项
+    unsigned length;
+    std::vector<FunctionalOp> ops;
+    // 最近的两个后继块，用于块链接，避免每次查表
+    unsigned successorPC[2];
+    FunctionalBlock *successor[2];
+    unsigned replaceSlot;
+};
+
+/**
+ * @brief 纯功能模拟的 RV32IM 执行引擎
+ * 按基本块将指令翻译为预译码的处理函数数组并缓存，使用直接线索化分派执行，
+ * 与周期级模型共享 RegisterFile 与 Memory 的体系结构状态
+ */
+class FunctionalCore {
+    friend struct FunctionalHandlers;
+
+    RegisterFile *const regFile;
+    Memory *const memory;
+
+    ProgramImagePtr image;
+    std::unordered_map<unsigned, std::unique_ptr<FunctionalBlock>> blocks;
+
+    unsigned reg[33];
+    unsigned pc;
+    bool exited;
+    FunctionalObserver *observer;
+
+    FunctionalBlock *lookup(unsigned address);
+    FunctionalBlock *translate(unsigned address);
+    FunctionalBlock *chain(FunctionalBlock *block);
+
+    [[nodiscard]] unsigned loadWord(unsigned address) const;
+    void storeWord(unsigned address, unsigned value, unsigned byteMask);
+    void controlTransfer(const FunctionalOp *op, bool isBranch, bool taken);
+
+public:
+    FunctionalCore(RegisterFile &regFile, Memory &memory);
+
+    void reset(const ProgramImagePtr &image, unsigned entry);
+    void reset(const std::vector<unsigned> &inst, unsigned entry);
+    void jump(unsigned address);
+    unsigned long run(unsigned long maxInstructions = -1ul);
+
+    // 设置为 nullptr 时停止回调
+    void setObserver(FunctionalObserver *x) { observer = x; }
+
+    [[nodiscard]] unsigned getPC() const { return pc; }
+    [[nodiscard]] bool hasExited() const { return exited; }
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "functional.h"
+#include "instructions.h"
+#include "program_image.h"
+
+constexpr char INST_TRACE_MAGIC[8] = {'T', 'O', 'M', 'I', 'N', 'S', 'T', 'R'};
+constexpr unsigned INST_TRACE_VERSION = 1u;
+
+// 指令追踪文件头，其后依次为 codeSize 个指令字与 count 条记录
+struct InstTraceHeader {
+    char magic[8];
+    unsigned version;
+    unsigned recordSize;
+    unsigned entry;
+    // 从 0x80000000 开始的指令区字数，含结尾的 EXIT
+    unsigned codeSize;
+    unsigned long count;
+};
+static_assert(sizeof(InstTraceHeader) == 32, "Trace header layout changed");
+
+/**
+ * @brief 按提交顺序记录的一条指令
+ * 译码结果由文件中的指令区得到；访存指令的 value 为有效地址，
+ * 跳转与分支指令为实际执行的下一条指令地址，其余指令为 0
+ */
+struct InstTraceRecord {
+    // (pc - 0x80000000) / 4
+    unsigned index;
+    unsigned value;
+};
+static_assert(sizeof(InstTraceRecord) == 8, "Trace record layout changed");
+
+/**
+ * @brief 顺序写入指令追踪文件，记录条数在 close 时写回文件头
+ */
+class InstTraceWriter {
+    std::ofstream out;
+    std::string fileName;
+    InstTraceHeader header{};
+    std::vector<InstTraceRecord> buffer;
+
+    void flushBuffer();
+
+public:
+    InstTraceWriter(const std::string &fileName, const ProgramImage &image);
+    ~InstTraceWriter();
+    InstTraceWriter(const InstTraceWriter &) = delete;
+    InstTraceWriter &operator=(const InstTraceWriter &) = delete;
+
+    void append(const InstTraceRecord &record);
+    void close();
+
+    [[nodiscard]] unsigned long getCount() const { return header.count; }
+};
+
+/**
+ * @brief 映射到内存的只读指令追踪
+ * 指令区在打开时译码一次，回放时不需要 elf，也不需要程序的数据区
+ */
+class InstTrace {
+    void *map = nullptr;
+    size_t mapSize = 0;
+    const InstTraceHeader *header = nullptr;
+    const InstTraceRecord *records = nullptr;
+    std::vector<Instruction> code;
+
+public:
+    explicit InstTrace(const std::string &fileName);
+    ~InstTrace();
+    InstTrace(const InstTrace &) = delete;
+    InstTrace &operator=(const InstTrace &) = delete;
+
+    [[nodiscard]] unsigned long size() const { return header->count; }
+    [[nodiscard]] unsigned getEntry() const { return header->entry; }
+    [[nodiscard]] const InstTraceRecord &operator[](unsigned long i) const {
+        return records[i];
+    }
+    // 记录对应的已译码指令，pc 已经填好
+    [[nodiscard]] const Instruction &decode(const InstTraceRecord &x) const {
+        return code[x.index];
+    }
+};
+
+/**
+ * @brief 功能执行时按提交顺序写出指令追踪
+ * 基本块开始时生成块内全部记录，之后按顺序把访存地址填入访存指令，
+ * 把跳转结果填入块尾的跳转或分支指令，下一个块开始时写出
+ */
+class InstTraceRecorder final : public FunctionalObserver {
+    ProgramImagePtr image;
+    InstTraceWriter *const writer;
+    std::vector<InstTraceRecord> block;
+    // 下一次访存对应的块内位置
+    unsigned nextAccess = 0;
+
+public:
+    InstTraceRecorder(const ProgramImagePtr &image, InstTraceWriter &writer);
+
+    void onDataAccess(unsigned address, bool write) override;
+    void onControlTransfer(const BpuUpdateData &x) override;
+    void onBlock(unsigned pc, unsigned length) override;
+    void flush();
+};
+
+unsigned long recordInstTrace(const std::string &name,
+                              const std::string &traceName,
+                              RegisterFile &regFile,
+                              Memory &memory,
+                              const std::vector<int> &args);
@@ -19,23 +19,46 @@ struct Instruction {
     unsigned pc;
     BranchPredictBundle predictBundle;
 
-    [[nodiscard]] unsigned getImmediate() const;
-    [[nodiscard]] unsigned getRd() const;
-    [[nodiscard]] unsigned getRs1() const;
-    [[nodiscard]] unsigned getRs2() const;
+    // 译码结果，构造时一次性计算完成
+    Opcode opcode;
+    FUType fuType;
+    unsigned rd, rs1, rs2, imm;
+
+    [[nodiscard]] unsigned getImmediate() const { return imm; }
+    [[nodiscard]] unsigned getRd() const { return rd; }
+    [[nodiscard]] unsigned getRs1() const { return rs1; }
+    [[nodiscard]] unsigned getRs2() const { return rs2; }
     [[nodiscard]] unsigned get(int index) const;
     [[nodiscard]] unsigned get(int index, int length) const;
 
     explicit Instruction(unsigned inst = 0x13);
-    bool operator==(const MaskedLiteral &rhs) const;
-    bool operator!=(const MaskedLiteral &rhs) const;
+    // 判断指令是否为某种类型的指令，仅需一次与运算和比较
+    bool operator==(const MaskedLiteral &rhs) const {
+        return rhs == instruction;
+    }
+    bool operator!=(const MaskedLiteral &rhs) const {
+        return rhs != instruction;
+    }
     friend std::ostream &operator<<(std::ostream &os, const Instruction &inst);
 
-    [[nodiscard]] ExecuteResultBundle execute(const std::string &name,
+    [[nodiscard]] ExecuteResultBundle execute(FUType type,
                                               unsigned operand1,
                                               unsigned operand2) const;
 
+    void decode(unsigned inst);
+
     static Instruction NOP();
+    static Instruction predecode(unsigned inst);
 };
 
-FUType getFUType(const Instruction &inst);
+const char *getOpcodeName(Opcode opcode);
+const char *getFUName(FUType type);
+unsigned getFULatency(FUType type);
+
+/**
+ * @brief 获取指令的执行单元种类
+ *
+ * @param inst
+ * @return FUType
+ */
+inline FUType getFUType(const Instruction &inst) { return inst.fuType; }
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "functional.h"
+#include "machine_config.h"
+#include "processor.h"
+#include "runner.h"
+
+/**
+ * @brief 区间模型的参数
+ * 结构参数来自与周期级模型相同的机器描述；各项暴露系数表示事件延迟中
+ * 未被乱序执行掩盖的比例。默认值不假设任何重叠：延迟全部暴露，分支解析
+ * 时间为 0，估计的误差未知；周期级模型可以运行后，用 interval-calibrate
+ * 拟合并替换这些值，修改微结构后应重新标定
+ */
+struct IntervalConfig {
+    MachineConfig machine;
+
+    // 每周期流出的指令条数
+    unsigned dispatchWidth = 1;
+    // 预测错误后需要重新填满的前端流水级数：IF1、IF2、ID、DISPATCH
+    unsigned frontendDepth = 4;
+    // 预测错误的分支从流出到在 ROB 头部提交的平均周期数
+    double resolveCycles = 0;
+    // 乘除法超出一个周期的执行时间
+    double longLatencyExposure = 1.0;
+    // Cache 命中时 LSU 超出一个周期的执行时间
+    double hitExposure = 1.0;
+    // Cache 缺失时读入（以及写回）一整块的时间
+    double missExposure = 1.0;
+};
+
+// 功能执行得到的事件数与估计的周期数，周期数按事件种类分解
+struct IntervalResult {
+    unsigned long instructions = 0;
+    unsigned long mispredicts = 0;
+    unsigned long multiplies = 0;
+    unsigned long divides = 0;
+    unsigned long memoryAccesses = 0;
+    unsigned long cacheHits = 0;
+    unsigned long cacheMisses = 0;
+    unsigned long writebacks = 0;
+
+    double baseCycles = 0;
+    double branchCycles = 0;
+    double longLatencyCycles = 0;
+    double memoryCycles = 0;
+    unsigned long cycles = 0;
+};
+
+// 一个标定样本：同一程序在同一机器上的事件数与周期级模型的周期数
+struct IntervalSample {
+    MachineConfig machine;
+    IntervalResult events;
+    unsigned long cycles = 0;
+};
+
+/**
+ * @brief 一阶区间分析的时序模型
+ * 作为功能模型的观察者统计分支预测错误、Cache 缺失与长延迟运算，
+ * 把执行时间估计为按流出宽度顺序流出的时间加上各事件造成的停顿。
+ * 分支预测使用与周期级模型相同的前端，Cache 使用相同的替换算法
+ */
+class IntervalModel final : public FunctionalObserver {
+    const IntervalConfig config;
+    ProgramImagePtr image;
+    const Memory *const memory;
+    std::unique_ptr<Frontend> predictor;
+    std::unique_ptr<Cache> dcache;
+
+    IntervalResult result;
+
+public:
+    IntervalModel(const IntervalConfig &config,
+                  const ProgramImagePtr &image,
+                  const Memory &memory);
+
+    void onDataAccess(unsigned address, bool write) override;
+    void onControlTransfer(const BpuUpdateData &x) override;
+    void onBlock(unsigned pc, unsigned length) override;
+
+    [[nodiscard]] IntervalResult estimate() const;
+};
+
+IntervalResult executeInterval(const std::string &name,
+                               const IntervalConfig &config,
+                               RegisterFile &regFile,
+                               Memory &memory,
+                               const std::vector<int> &args);
+
+// 以最小化相对误差的平方和拟合四个暴露系数，其余参数取自 base
+IntervalConfig calibrateInterval(const IntervalConfig &base,
+                                 const std::vector<IntervalSample> &samples);
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include "defines.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 struct LoadBufferSlot {
     unsigned robIdx;
     unsigned loadAddress;
@@ -12,13 +16,17 @@ struct LoadBufferSlot {
 };
 
 class LoadBuffer {
-    LoadBufferSlot buffer[ROB_SIZE];
+    // 与 ROB 等大，load buffer 以 ROB 表项编号为下标
+    std::vector<LoadBufferSlot> buffer;
 
 public:
-    LoadBuffer();
+    explicit LoadBuffer(unsigned size = ROB_SIZE);
     void push(unsigned addr, unsigned robIdx);
     LoadBufferSlot pop(unsigned robIdx);
 
     void check(unsigned addr, unsigned robIdx, unsigned robPopPtr);
     void flush();
+
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
 };
@@ -1,20 +1,93 @@
 #pragma once
 
+#include <atomic>
 #include <cstdarg>
+#include <cstdio>
 
+// 编译期日志等级，低于该等级的输出在编译时被完全移除
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// 日志所属的子系统，可在运行时分别开关
+enum class LogCategory : unsigned {
+    GENERAL,
+    FRONTEND,
+    RS,
+    EXECUTE,
+    LSU,
+    ROB,
+    COMMIT,
+    CACHE,
+    MEMORY,
+    NUM_CATEGORIES
+};
+
+/**
+ * @brief 日志输出
+ * 输出开关由所有线程共享；日志先写入各线程自己的缓冲区，
+ * 以整行为单位写出到该线程的输出目标，多个模拟器并发运行时不会交错
+ */
 class Logger {
 private:
-    static bool debugOutput;
-    static bool infoOutput;
-    static bool warnOutput;
+    static std::atomic<bool> debugOutput;
+    static std::atomic<bool> infoOutput;
+    static std::atomic<bool> warnOutput;
+    static std::atomic<unsigned> categoryMask;
+
+    static void write(const char *prefix, const char *format, ...);
 
 public:
     static void setDebugOutput(bool);
     static void setInfoOutput(bool);
     static void setWarnOutput(bool);
 
-    static void Debug(const char *format, ...);
-    static void Info(const char *format, ...);
+    static void setCategoryOutput(LogCategory category, bool flag);
+    static bool setCategoryOutput(const char *categories);
+    // 设置当前线程的输出目标，默认为 stderr
+    static void setThreadOutput(FILE *sink);
+
+    static void flush();
+
+    template <LogCategory category = LogCategory::GENERAL>
+    [[nodiscard]] static bool isDebugEnabled() {
+        if constexpr (LOG_LEVEL > LOG_LEVEL_DEBUG) return false;
+        return debugOutput.load(std::memory_order_relaxed) &&
+               (categoryMask.load(std::memory_order_relaxed) &
+                (1u << static_cast<unsigned>(category)));
+    }
+
+    template <LogCategory category = LogCategory::GENERAL>
+    [[nodiscard]] static bool isInfoEnabled() {
+        if constexpr (LOG_LEVEL > LOG_LEVEL_INFO) return false;
+        return infoOutput.load(std::memory_order_relaxed) &&
+               (categoryMask.load(std::memory_order_relaxed) &
+                (1u << static_cast<unsigned>(category)));
+    }
+
+    // 任一子系统开启了信息输出
+    [[nodiscard]] static bool isAnyInfoEnabled() {
+        if constexpr (LOG_LEVEL > LOG_LEVEL_INFO) return false;
+        return infoOutput.load(std::memory_order_relaxed) &&
+               categoryMask.load(std::memory_order_relaxed) != 0;
+    }
+
+    template <LogCategory category = LogCategory::GENERAL, typename... Args>
+    static void Debug(const char *format, Args... args) {
+        if (isDebugEnabled<category>())
+            write("[  DEBUG  ] ", format, args...);
+    }
+
+    template <LogCategory category = LogCategory::GENERAL, typename... Args>
+    static void Info(const char *format, Args... args) {
+        if (isInfoEnabled<category>()) write("[  INFO   ] ", format, args...);
+    }
+
     static void Warn(const char *format, ...);
     static void Error(const char *format, ...);
 };
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "cache.h"
+#include "defines.h"
+
+enum class ProcessorType { normal, predict, cache };
+
+/**
+ * @brief 一台模拟机器的完整描述：处理器类型、乱序核的结构参数与存储层次
+ * 默认值与编译期常量一致，未在配置文件中给出的项保持默认值。
+ * 配置文件为 INI 格式，分为 [core]、[memory] 与 [cache] 三节，
+ * 每行一个 key = value，# 或 ; 之后为注释，键名见 set
+ */
+struct MachineConfig {
+    ProcessorType type = ProcessorType::normal;
+    unsigned robSize = ROB_SIZE;
+    // 每个执行单元的保留站表项数
+    unsigned rsSize = 4;
+    unsigned btbSize = 1024;
+    // 各执行单元的执行周期数，以 FUType 为下标
+    std::array<unsigned, 5> fuLatency{};
+
+    unsigned latency = 5;
+    // 主存延迟与随机替换的种子
+    int seed = 0;
+
+    unsigned cacheSize = 4096;
+    unsigned blockSize = 16;
+    unsigned associativity = 2;
+    bool writeThrough = false;
+    ReplaceType replaceType = ReplaceType::LRU;
+    // 允许的最大 Cache 容量，只用于检查配置
+    unsigned maxCacheSize = MAX_CACHE_SIZE;
+
+    MachineConfig();
+
+    void set(const std::string &key, const std::string &value);
+    [[nodiscard]] const char *invalidReason() const;
+    void validate() const;
+    [[nodiscard]] std::string toString() const;
+};
+
+const char *getProcessorTypeName(ProcessorType type);
+const char *getReplaceTypeName(ReplaceType type);
+
+MachineConfig readMachineConfig(const std::string &fileName);
+void printMachineConfig(const MachineConfig &config);
+
+/**
+ * @brief 由命令行得到机器描述
+ * 给出 --config 时读取该文件，否则从 base 开始；之后命令行中出现的选项
+ * 覆盖对应的配置项。overrides 的每一项为选项名与配置键名，选项的值按字符串
+ * 读取后交给 MachineConfig::set 解析
+ *
+ * @param result cxxopts 的解析结果
+ * @param overrides
+ * @param base 没有配置文件时的初始配置
+ * @return MachineConfig 检查过能否实例化的配置
+ */
+template <typename ParseResult, size_t N>
+MachineConfig parseMachineOptions(const ParseResult &result,
+                                  const char *const (&overrides)[N][2],
+                                  const MachineConfig &base = MachineConfig()) {
+    auto config = result.count("config") != 0
+                      ? readMachineConfig(
+                            result["config"].template as<std::string>())
+                      : base;
+    for (const auto &x : overrides)
+        if (result.count(x[0]) != 0)
+            config.set(x[1], result[x[0]].template as<std::string>());
+    config.validate();
+    return config;
+}
@@ -1,41 +1,192 @@
 #pragma once
+#include <stdexcept>
 #include <string>
 
+#include "defines.h"
+
+/**
+ * @brief 指令编码模式，由 (mask, match) 两个 32 位整数表示
+ * mask 中为 1 的位需要与 match 相同，其余位不关心
+ * 所有模式均在编译期由 opcode/funct3/funct7 字面量生成，匹配只需一次与运算和比较
+ */
 class MaskedLiteral {
-    std::string literal;
+    unsigned mask;
+    unsigned match;
+
+    /**
+     * @brief 将 '0'/'1'/'-' 组成的字符串追加到 (mask, match) 的低位
+     */
+    static constexpr void append(const char *s,
+                                 unsigned &mask,
+                                 unsigned &match,
+                                 int &length) {
+        for (; *s != '\0'; s++, length++) {
+            mask <<= 1u;
+            match <<= 1u;
+            if (*s == '0' || *s == '1') {
+                mask |= 1u;
+                match |= (unsigned) (*s - '0');
+            } else if (*s != '-') {
+                throw std::invalid_argument(
+                    "Literals can only contain '0', '1' and '-'");
+            }
+        }
+    }
+
+    static constexpr MaskedLiteral build(const char *funct7,
+                                         int skip,
+                                         const char *funct3,
+                                         const char *opcode) {
+        unsigned mask = 0, match = 0;
+        int length = 0;
+        append(funct7, mask, match, length);
+        mask <<= skip;
+        match <<= skip;
+        length += skip;
+        append(funct3, mask, match, length);
+        mask <<= 5u;
+        match <<= 5u;
+        length += 5;
+        append(opcode, mask, match, length);
+        if (length != XLEN) {
+            throw std::invalid_argument(
+                "Literals' length must be 32 in RV32 Machines");
+        }
+        return MaskedLiteral(mask, match);
+    }
 
 public:
-    explicit MaskedLiteral(std::string s);
+    constexpr MaskedLiteral(unsigned mask, unsigned match)
+        : mask(mask), match(match) {}
+    explicit MaskedLiteral(const std::string &s);
+
     bool operator==(const std::string &s) const;
-    bool operator==(const unsigned &x) const;
-
-    static MaskedLiteral UType(std::string opcode);
-    static MaskedLiteral IType(std::string opcode, std::string funct3);
-    static MaskedLiteral RType(std::string opcode,
-                               std::string funct3,
-                               std::string funct7);
-    friend bool operator==(const unsigned &lhs, const MaskedLiteral &rhs);
+    constexpr bool operator==(unsigned x) const { return (x & mask) == match; }
+    constexpr bool operator!=(unsigned x) const { return !(*this == x); }
+
+    [[nodiscard]] constexpr unsigned getMask() const { return mask; }
+    [[nodiscard]] constexpr unsigned getMatch() const { return match; }
+
+    /**
+     * @brief 用于生成U，J类指令编码
+     */
+    static constexpr MaskedLiteral UType(const char *opcode) {
+        return build("", 20, "", opcode);
+    }
+
+    /**
+     * @brief 用于生成I，B，S类指令编码
+     */
+    static constexpr MaskedLiteral IType(const char *opcode,
+                                         const char *funct3) {
+        return build("", 17, funct3, opcode);
+    }
+
+    /**
+     * @brief 用于生成R类指令编码
+     */
+    static constexpr MaskedLiteral RType(const char *opcode,
+                                         const char *funct3,
+                                         const char *funct7) {
+        return build(funct7, 10, funct3, opcode);
+    }
+
+    friend constexpr bool operator==(unsigned lhs, const MaskedLiteral &rhs) {
+        return rhs == lhs;
+    }
+    friend constexpr bool operator!=(unsigned lhs, const MaskedLiteral &rhs) {
+        return rhs != lhs;
+    }
 };
 
 namespace RV32I {
-extern const MaskedLiteral LUI, AUIPC;
-extern const MaskedLiteral JAL, JALR;
-extern const MaskedLiteral BEQ, BNE, BLT, BGE, BLTU, BGEU;
-extern const MaskedLiteral LB, LH, LW, LBU, LHU;
-extern const MaskedLiteral SB, SH, SW;
-extern const MaskedLiteral ADDI, SLTI, SLTIU, XORI, ORI, ANDI, SLLI, SRLI, SRAI;
-extern const MaskedLiteral ADD, SUB, SLL, SLT, SLTU, XOR, SRL, SRA, OR, AND;
-
-extern const MaskedLiteral FENCE;
-extern const MaskedLiteral ECALL, EBREAK;
-extern const MaskedLiteral CSRRW, CSRRS, CSRRC, CSRRWI, CSRRSI, CSRRCI;
+inline constexpr MaskedLiteral LUI = MaskedLiteral::UType("0110111");
+inline constexpr MaskedLiteral AUIPC = MaskedLiteral::UType("0010111");
+inline constexpr MaskedLiteral JAL = MaskedLiteral::UType("1101111");
+
+inline constexpr MaskedLiteral JALR = MaskedLiteral::IType("1100111", "000");
+
+inline constexpr MaskedLiteral BEQ = MaskedLiteral::IType("1100011", "000");
+inline constexpr MaskedLiteral BNE = MaskedLiteral::IType("1100011", "001");
+inline constexpr MaskedLiteral BLT = MaskedLiteral::IType("1100011", "100");
+inline constexpr MaskedLiteral BGE = MaskedLiteral::IType("1100011", "101");
+inline constexpr MaskedLiteral BLTU = MaskedLiteral::IType("1100011", "110");
+inline constexpr MaskedLiteral BGEU = MaskedLiteral::IType("1100011", "111");
+
+inline constexpr MaskedLiteral LB = MaskedLiteral::IType("0000011", "000");
+inline constexpr MaskedLiteral LH = MaskedLiteral::IType("0000011", "001");
+inline constexpr MaskedLiteral LW = MaskedLiteral::IType("0000011", "010");
+inline constexpr MaskedLiteral LBU = MaskedLiteral::IType("0000011", "100");
+inline constexpr MaskedLiteral LHU = MaskedLiteral::IType("0000011", "101");
+
+inline constexpr MaskedLiteral SB = MaskedLiteral::IType("0100011", "000");
+inline constexpr MaskedLiteral SH = MaskedLiteral::IType("0100011", "001");
+inline constexpr MaskedLiteral SW = MaskedLiteral::IType("0100011", "010");
+
+inline constexpr MaskedLiteral ADDI = MaskedLiteral::IType("0010011", "000");
+inline constexpr MaskedLiteral SLTI = MaskedLiteral::IType("0010011", "010");
+inline constexpr MaskedLiteral SLTIU = MaskedLiteral::IType("0010011", "011");
+inline constexpr MaskedLiteral XORI = MaskedLiteral::IType("0010011", "100");
+inline constexpr MaskedLiteral ORI = MaskedLiteral::IType("0010011", "110");
+inline constexpr MaskedLiteral ANDI = MaskedLiteral::IType("0010011", "111");
+
+inline constexpr MaskedLiteral SLLI =
+    MaskedLiteral::RType("0010011", "001", "0000000");
+inline constexpr MaskedLiteral SRLI =
+    MaskedLiteral::RType("0010011", "101", "0000000");
+inline constexpr MaskedLiteral SRAI =
+    MaskedLiteral::RType("0010011", "101", "0100000");
+
+inline constexpr MaskedLiteral ADD =
+    MaskedLiteral::RType("0110011", "000", "0000000");
+inline constexpr MaskedLiteral SUB =
+    MaskedLiteral::RType("0110011", "000", "0100000");
+inline constexpr MaskedLiteral SLL =
+    MaskedLiteral::RType("0110011", "001", "0000000");
+inline constexpr MaskedLiteral SLT =
+    MaskedLiteral::RType("0110011", "010", "0000000");
+inline constexpr MaskedLiteral SLTU =
+    MaskedLiteral::RType("0110011", "011", "0000000");
+inline constexpr MaskedLiteral XOR =
+    MaskedLiteral::RType("0110011", "100", "0000000");
+inline constexpr MaskedLiteral SRL =
+    MaskedLiteral::RType("0110011", "101", "0000000");
+inline constexpr MaskedLiteral SRA =
+    MaskedLiteral::RType("0110011", "101", "0100000");
+inline constexpr MaskedLiteral OR =
+    MaskedLiteral::RType("0110011", "110", "0000000");
+inline constexpr MaskedLiteral AND =
+    MaskedLiteral::RType("0110011", "111", "0000000");
+
+inline constexpr MaskedLiteral FENCE = MaskedLiteral::IType("0001111", "000");
+
+inline constexpr MaskedLiteral CSRRW = MaskedLiteral::IType("1110011", "001");
+inline constexpr MaskedLiteral CSRRS = MaskedLiteral::IType("1110011", "010");
+inline constexpr MaskedLiteral CSRRC = MaskedLiteral::IType("1110011", "011");
+inline constexpr MaskedLiteral CSRRWI = MaskedLiteral::IType("1110011", "101");
+inline constexpr MaskedLiteral CSRRSI = MaskedLiteral::IType("1110011", "110");
+inline constexpr MaskedLiteral CSRRCI = MaskedLiteral::IType("1110011", "111");
 }  // namespace RV32I
 
 namespace RV32M {
-extern const MaskedLiteral MUL, MULH, MULHSU, MULHU;
-extern const MaskedLiteral DIV, DIVU, REM, REMU;
+inline constexpr MaskedLiteral MUL =
+    MaskedLiteral::RType("0110011", "000", "0000001");
+inline constexpr MaskedLiteral MULH =
+    MaskedLiteral::RType("0110011", "001", "0000001");
+inline constexpr MaskedLiteral MULHSU =
+    MaskedLiteral::RType("0110011", "010", "0000001");
+inline constexpr MaskedLiteral MULHU =
+    MaskedLiteral::RType("0110011", "011", "0000001");
+inline constexpr MaskedLiteral DIV =
+    MaskedLiteral::RType("0110011", "100", "0000001");
+inline constexpr MaskedLiteral DIVU =
+    MaskedLiteral::RType("0110011", "101", "0000001");
+inline constexpr MaskedLiteral REM =
+    MaskedLiteral::RType("0110011", "110", "0000001");
+inline constexpr MaskedLiteral REMU =
+    MaskedLiteral::RType("0110011", "111", "0000001");
 }  // namespace RV32M
 
 namespace EXTRA {
-extern const MaskedLiteral EXIT;
+inline constexpr MaskedLiteral EXIT = MaskedLiteral::UType("0001011");
 }  // namespace EXTRA
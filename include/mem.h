@@ -4,21 +4,64 @@
 #include <memory>
 #include <optional>
 #include <random>
+#include <vector>
+
+#include "defines.h"
+#include "program_image.h"
+
+class CheckpointWriter;
+class CheckpointReader;
 
 class Memory {
-    unsigned int *data;
+    // 页表，尚未写入的页指向程序映像的数据区或共享的全零页，
+    // 首次写入不同的数据时才分配并复制
+    std::vector<const unsigned *> pages;
+    std::vector<std::unique_ptr<unsigned[]>> storage;
+    // 页表引用的程序映像，保证其在映射期间有效
+    ProgramImagePtr image;
+
     unsigned saveAddress;
     bool saveWriteFlag;
     unsigned remainingTime;
+    // 请求开始与完成的累计次数，不含倒计时
+    unsigned long activity;
 
     const unsigned latency;
 
     std::default_random_engine engine;
     std::uniform_int_distribution<int> generator;
 
+    // 快照生效期间被写入过的页在第一次写入前的内容，
+    // 恢复快照后保留缓冲区，重复实验时不再分配
+    std::vector<std::unique_ptr<unsigned[]>> snapshotPages;
+    std::vector<bool> pagePreserved;
+    std::vector<unsigned> dirtyPages;
+    // 建立快照时的延迟发生器与连续访问的地址，恢复后访存延迟与快照之后的
+    // 第一次执行相同
+    std::default_random_engine snapshotEngine;
+    unsigned snapshotSaveAddress = 0;
+    bool snapshotSaveWriteFlag = false;
+    bool snapshot = false;
+
+    void allocatePage(unsigned page);
+    void preservePage(unsigned page);
+
+    [[nodiscard]] unsigned load(unsigned address) const {
+        return pages[address / MEMORY_PAGE_WORDS][address % MEMORY_PAGE_WORDS];
+    }
+    // 所有写入数据的路径都经过这里，保证快照能恢复被修改的页
+    void store(unsigned address, unsigned value) {
+        unsigned page = address / MEMORY_PAGE_WORDS;
+        if (!storage[page]) {
+            if (value == load(address)) return;
+            allocatePage(page);
+        }
+        if (snapshot && !pagePreserved[page]) preservePage(page);
+        storage[page][address % MEMORY_PAGE_WORDS] = value;
+    }
+
 public:
     explicit Memory(unsigned latency, int seed = 0);
-    ~Memory();
     // Returns std::nullopt if read is incomplete
     std::optional<unsigned> read(unsigned address);
     // Returns false if write is incomplete
@@ -31,5 +74,30 @@ public:
     [[nodiscard]] std::vector<unsigned> functionalRead(unsigned address,
                                                        unsigned length) const;
 
+    // single word access without timing, used by functional simulation
+    [[nodiscard]] unsigned functionalRead(unsigned address) const {
+        return address < (DATA_MEM_SIZE >> 2u) ? load(address) : 0u;
+    }
+    void functionalWrite(unsigned address, unsigned value) {
+        if (address < (DATA_MEM_SIZE >> 2u)) store(address, value);
+    }
+
     void resetState();
+    // 丢弃全部内容与快照，改为引用程序映像的数据区
+    void mapImage(const ProgramImagePtr &image);
+    // 丢弃全部内容与快照，改为 other 的当前内容，只复制其写入过的页
+    void copyPagesFrom(const Memory &other);
+
+    // 写时复制快照，恢复时只复制快照之后被写入过的页
+    void takeSnapshot();
+    void restoreSnapshot();
+    void discardSnapshot();
+    [[nodiscard]] bool hasSnapshot() const { return snapshot; }
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
+
+    [[nodiscard]] unsigned getRemainingTime() const { return remainingTime; }
+    [[nodiscard]] unsigned long getActivity() const { return activity; }
+    // 跳过空闲周期时直接推进当前请求的倒计时
+    void advance(unsigned time) { remainingTime -= time; }
 };
\ No newline at end of file
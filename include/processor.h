@@ -1,13 +1,17 @@
 #pragma once
+#include <array>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include "defines.h"
 #include "instructions.h"
 #include "load_buffer.h"
+#include "machine_config.h"
+#include "program_image.h"
 #include "register_file.h"
 #include "reservation_station.hpp"
 #include "rob.h"
@@ -15,33 +19,50 @@
 
 class Frontend {
     unsigned int pc = 0x80000000;
-    unsigned data[INST_MEM_SIZE >> 2u];
+    // 共享的只读程序映像，取指时直接复制其中的预译码结果
+    ProgramImagePtr image;
 
     bool dispatchHalt = false;
 
     std::optional<Instruction> IF1, IF2, ID, DISPATCH;
+    // 流水级之间发生移动的累计次数
+    unsigned long activity = 0;
+
+    [[nodiscard]] Instruction fetch(unsigned address) const;
 
 protected:
     virtual BranchPredictBundle bpuFrontendUpdate(unsigned int pc);
 
 public:
     explicit Frontend(const std::vector<unsigned> &inst);
-    virtual std::optional<Instruction> step() final;
+    // 基础前端没有可配置的结构
+    Frontend(const std::vector<unsigned> &inst,
+             [[maybe_unused]] const MachineConfig &config)
+        : Frontend(inst) {}
+    virtual ~Frontend() = default;
+    template <typename Self>
+    std::optional<Instruction> step();
     virtual void jump(unsigned int jumpAddress) final;
     virtual void haltDispatch() final;
     [[nodiscard]] virtual unsigned calculateNextPC(unsigned pc) const;
     virtual void bpuBackendUpdate(const BpuUpdateData &x);
 
-    virtual void reset(const std::vector<unsigned> &inst, unsigned entry);
+    virtual void reset(const ProgramImagePtr &image, unsigned entry);
+    virtual void save(CheckpointWriter &out) const;
+    virtual void restore(CheckpointReader &in);
+
+    [[nodiscard]] unsigned long getActivity() const { return activity; }
 };
 
 class ExecutePipeline {
-    const std::string name;
+    const FUType type;
+    const unsigned latency;
     IssueSlot executeSlot;
     unsigned counter;
+    unsigned long activity = 0;
 
 public:
-    explicit ExecutePipeline(std::string name);
+    ExecutePipeline(FUType type, unsigned latency);
     std::optional<ROBStatusWritePort> step(Memory &memory,
                                            LoadBuffer &ldBuf,
                                            ReorderBuffer &rob,
@@ -54,6 +75,15 @@ public:
     void execute(const IssueSlot &x);
     [[nodiscard]] bool canExecute() const;
     void flush();
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
+
+    [[nodiscard]] unsigned getCounter() const {
+        return executeSlot.busy ? counter : 0;
+    }
+    [[nodiscard]] unsigned long getActivity() const { return activity; }
+    // 跳过空闲周期时直接推进执行倒计时
+    void advance(unsigned cycles) { counter -= cycles; }
 };
 
 class Backend {
@@ -61,8 +91,8 @@ class Backend {
 
 protected:
     ReorderBuffer rob;
-    ReservationStation<4> rsALU, rsBRU, rsMUL, rsDIV;
-    ReservationStation<4> rsLSU;
+    ReservationStation rsALU, rsBRU, rsMUL, rsDIV;
+    ReservationStation rsLSU;
     StoreBuffer storeBuffer;
     LoadBuffer loadBuffer;
 
@@ -78,48 +108,85 @@ protected:
                                       unsigned byteEnable);
 
 public:
+    // 各执行单元的剩余周期与主存请求的剩余时间
+    using Timers = std::array<unsigned, CDB_WIDTH + 1>;
+
+    Backend(const std::vector<unsigned> &data,
+            RegisterFile *reg,
+            unsigned memoryLatency,
+            int seed = 0);
     Backend(const std::vector<unsigned> &data,
             RegisterFile *reg,
-            unsigned memoryLatency);
+            const MachineConfig &config);
     bool dispatchInstruction(const Instruction &inst);
-    bool step(Frontend &frontend);
+    template <typename Self, typename FrontendPolicy>
+    bool step(FrontendPolicy &frontend);
     [[nodiscard]] virtual unsigned read(unsigned addr) const;
-    virtual bool commitInstruction(const ROBEntry &entry, Frontend &frontend);
-
-    virtual void reset(const std::vector<unsigned> &data);
+    template <typename FrontendPolicy>
+    bool commitInstruction(const ROBEntry &entry, FrontendPolicy &frontend);
+
+    virtual void reset(const ProgramImagePtr &image);
+    // 数据内存在装载完成时建立快照，之后可以快速回到该状态
+    void takeSnapshot() { memory.takeSnapshot(); }
+    // 应在 reset 之后调用，数据内存改为 data 的当前内容
+    void copyMemory(const Memory &data) { memory.copyPagesFrom(data); }
+    virtual void restoreSnapshot();
+    virtual void save(CheckpointWriter &out) const;
+    virtual void restore(CheckpointReader &in);
     void functionalWrite(unsigned addr, unsigned value);
+
+    [[nodiscard]] unsigned long getActivity() const;
+    [[nodiscard]] Timers getTimers() const;
+    void advanceTimers(const Timers &delta, unsigned long cycles);
+
+    [[nodiscard]] unsigned long getCommittedInstructions() const {
+        return rob.getCommitted();
+    }
+    // 没有数据 Cache 的后端无需预热
+    void warmDataAccess([[maybe_unused]] unsigned address,
+                        [[maybe_unused]] bool write) {}
 };
 
 class ProcessorAbstract {
 public:
+    virtual ~ProcessorAbstract() = default;
     virtual bool step() = 0;
+    // 返回跳过的空闲周期数，至多为 limit，不支持跳过的处理器返回 0
+    virtual unsigned long skipIdleCycles(
+        [[maybe_unused]] unsigned long limit = -1ul) {
+        return 0;
+    }
     virtual void loadProgram(const std::vector<unsigned> &inst,
                              const std::vector<unsigned> &data,
                              unsigned entry) = 0;
+    // 装载共享的程序映像，不复制指令区与数据区
+    virtual void loadImage(const ProgramImagePtr &image) = 0;
+    // 装载映像的指令区，数据内存取 memory 的当前内容，从 pc 开始执行
+    virtual void loadState(const ProgramImagePtr &image,
+                           const Memory &memory,
+                           unsigned pc) = 0;
+    [[nodiscard]] virtual unsigned readReg(unsigned addr) const = 0;
+    [[nodiscard]] virtual unsigned readMem(unsigned addr) const = 0;
     virtual void writeReg(unsigned addr, unsigned value) = 0;
     virtual void writeMem(unsigned addr, unsigned value) = 0;
-};
-
-class Processor : public ProcessorAbstract {
-    // NOTE: Order is crucial, prevent initialization reordering
-    RegisterFile regFile;
-    Frontend frontend;
-    Backend backend;
-
-public:
-    Processor(const std::vector<unsigned> &inst,
-              const std::vector<unsigned> &data,
-              unsigned entry,
-              unsigned memoryLatency);
 
-    bool step() override;
-    [[nodiscard]] unsigned readMem(unsigned addr) const;
-    [[nodiscard]] unsigned readReg(unsigned addr) const;
-
-    void writeReg(unsigned addr, unsigned value) override;
-    void writeMem(unsigned addr, unsigned value) override;
-
-    void loadProgram(const std::vector<unsigned> &inst,
-                     const std::vector<unsigned> &data,
-                     unsigned entry) override;
+    // 自装载程序以来提交的指令条数
+    [[nodiscard]] virtual unsigned long getCommittedInstructions() const = 0;
+    // 功能预热接口，应在装载体系结构状态之后调用
+    virtual void warmDataAccess(unsigned address, bool write) = 0;
+    virtual void warmBranchPredictor(const BpuUpdateData &x) = 0;
+
+    // 保存完整的模拟器状态，cycle 为此前已经执行的周期数
+    virtual void saveCheckpoint(const std::string &file,
+                                unsigned long cycle) const = 0;
+    // 恢复 saveCheckpoint 保存的状态，返回保存时的周期数
+    virtual unsigned long restoreCheckpoint(const std::string &file) = 0;
+
+    // 为刚装载的映像建立快照；elf 改变后 readProgramImage 返回新的映像，
+    // 因此以映像而不是路径识别之后装载的是否为同一程序
+    virtual void snapshotProgram(const ProgramImagePtr &image) = 0;
+    // 存在 image 的快照时回到其装载完成时的状态并返回 true
+    virtual bool restoreProgram(const ProgramImagePtr &image) = 0;
 };
+
+#include "processor_core.hpp"
@@ -0,0 +1,464 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "checkpoint.h"
+#include "logger.h"
+#include "processor.h"
+#include "trace.h"
+
+/**
+ * @brief 前端步进函数
+ * Self 为前端的实际类型，分支预测接口按 Self 静态绑定，可被内联
+ *
+ * @return std::optional<Instruction>
+ * 前端有指令需要流出时，返回指令，否则返回std::nullopt
+ */
+template <typename Self>
+std::optional<Instruction> Frontend::step() {
+    auto &self = static_cast<Self &>(*this);
+    Logger::Info<LogCategory::FRONTEND>(
+        "Dispatch halt: %s", dispatchHalt ? "true" : "false");
+    if (DISPATCH == std::nullopt || !dispatchHalt) {
+        if (DISPATCH.has_value() || ID.has_value()) activity++;
+        DISPATCH = ID;
+        ID = std::nullopt;
+    }
+    dispatchHalt = false;
+    auto instruction = DISPATCH;
+    if (ID == std::nullopt) {
+        if (IF2.has_value()) activity++;
+        ID = IF2;
+        IF2 = std::nullopt;
+    }
+    if (IF2 == std::nullopt) {
+        if (IF1.has_value()) activity++;
+        IF2 = IF1;
+        if (IF2.has_value())
+            IF2.value().predictBundle =
+                self.Self::bpuFrontendUpdate(IF2.value().pc);
+        if (IF1 != EXTRA::EXIT) {
+            IF1 = std::nullopt;
+        } else {
+            Logger::Info<LogCategory::FRONTEND>(
+                "Fetching EXIT, Frontend pipeline stalled!");
+        }
+    }
+    if (IF1 == std::nullopt) {
+        IF1 = std::make_optional<Instruction>(fetch(pc));
+        activity++;
+        Tracer::recordInstruction(TraceEvent::FETCH, IF1.value());
+        pc = self.Self::calculateNextPC(pc);
+    }
+    return instruction;
+}
+
+/**
+ * @brief 后端执行函数
+ * Self 为后端的实际类型，执行与提交按 Self 静态绑定，可被内联
+ *
+ * @param frontend cpu的前端，用于调用前端接口
+ * @return true 提交了EXIT指令
+ * @return false 未提交EXIT指令
+ */
+template <typename Self, typename FrontendPolicy>
+bool Backend::step(FrontendPolicy &frontend) {
+    auto &self = static_cast<Self &>(*this);
+    auto commit = rob.getFront();
+
+    // 每个执行单元在 CDB 上占用一个固定的写回槽
+    std::array<std::optional<ROBStatusWritePort>, CDB_WIDTH> writeSave{
+        self.Self::execute(alu),
+        self.Self::execute(bru),
+        self.Self::execute(mul),
+        self.Self::execute(div),
+        self.Self::execute(lsu),
+    };
+
+    if (rsALU.canIssue() && alu.canExecute()) alu.execute(rsALU.issue());
+    if (rsBRU.canIssue() && bru.canExecute()) bru.execute(rsBRU.issue());
+    if (rsMUL.canIssue() && mul.canExecute()) mul.execute(rsMUL.issue());
+    if (rsDIV.canIssue() && div.canExecute()) div.execute(rsDIV.issue());
+    if (rsLSU.canIssue() && lsu.canExecute()) lsu.execute(rsLSU.issue());
+
+    std::for_each(writeSave.begin(),
+                  writeSave.end(),
+                  [this](std::optional<ROBStatusWritePort> &tmp) {
+                      if (tmp.has_value()) {
+                          rsALU.wakeup(tmp.value());
+                          rsBRU.wakeup(tmp.value());
+                          rsMUL.wakeup(tmp.value());
+                          rsDIV.wakeup(tmp.value());
+                          rsLSU.wakeup(tmp.value());
+                          rob.writeState(tmp.value());
+                      }
+                  });
+
+    bool executeExit = false;
+
+    if (commit.has_value() && commit.value().state.ready) {
+        auto &entry = commit.value();
+        executeExit = self.Self::commitInstruction(entry, frontend);
+    }
+    return executeExit;
+}
+
+/**
+ * @brief 由前端与后端组合成的处理器
+ * 是否使用分支预测、是否使用缓存在编译期由模板参数决定，
+ * 新的处理器变种只需组合新的前端或后端类型
+ *
+ * @tparam FrontendPolicy Frontend 或其派生类
+ * @tparam BackendPolicy Backend 或其派生类，决定存储层次
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+class ProcessorCore final : public ProcessorAbstract {
+    // NOTE: Order is crucial, prevent initialization reordering
+    RegisterFile regFile;
+    FrontendPolicy frontend;
+    BackendPolicy backend;
+
+    // 上一周期没有任何状态变化，只有计时器在倒计时
+    bool idle = false;
+    // 空闲周期内各计时器每周期的减少量
+    Backend::Timers timerDelta{};
+
+    // 最近一次装载的程序入口，以及装载完成时的快照
+    unsigned entry = 0;
+    ProgramImagePtr snapshotImage;
+    RegisterFile snapshotRegFile;
+
+    [[nodiscard]] unsigned long getActivity() const {
+        return frontend.getActivity() + backend.getActivity();
+    }
+
+public:
+    template <typename... BackendArgs>
+    ProcessorCore(const std::vector<unsigned> &inst,
+                  const std::vector<unsigned> &data,
+                  unsigned entry,
+                  unsigned memoryLatency,
+                  BackendArgs... backendArgs);
+    // 按机器描述构造，程序之后由 loadProgram 或 loadImage 装载
+    explicit ProcessorCore(const MachineConfig &config);
+
+    bool step() override;
+    unsigned long skipIdleCycles(unsigned long limit = -1ul) override;
+    [[nodiscard]] unsigned readMem(unsigned addr) const override;
+    [[nodiscard]] unsigned readReg(unsigned addr) const override;
+
+    void writeReg(unsigned addr, unsigned value) override;
+    void writeMem(unsigned addr, unsigned value) override;
+
+    void loadProgram(const std::vector<unsigned> &inst,
+                     const std::vector<unsigned> &data,
+                     unsigned entry) override;
+    void loadImage(const ProgramImagePtr &image) override;
+    void loadState(const ProgramImagePtr &image,
+                   const Memory &memory,
+                   unsigned pc) override;
+
+    [[nodiscard]] unsigned long getCommittedInstructions() const override {
+        return backend.getCommittedInstructions();
+    }
+    void warmDataAccess(unsigned address, bool write) override {
+        backend.warmDataAccess(address, write);
+    }
+    void warmBranchPredictor(const BpuUpdateData &x) override {
+        frontend.FrontendPolicy::bpuBackendUpdate(x);
+    }
+
+    void saveCheckpoint(const std::string &file,
+                        unsigned long cycle) const override;
+    unsigned long restoreCheckpoint(const std::string &file) override;
+
+    void snapshotProgram(const ProgramImagePtr &image) override;
+    bool restoreProgram(const ProgramImagePtr &image) override;
+
+    // 仅在后端提供相应统计时可用
+    [[nodiscard]] unsigned long getTotalMemoryTime() const {
+        return backend.getTotalMemoryTime();
+    }
+    [[nodiscard]] unsigned long getTotalCacheHitTime() const {
+        return backend.getTotalCacheHitTime();
+    }
+};
+
+template <typename FrontendPolicy, typename BackendPolicy>
+template <typename... BackendArgs>
+ProcessorCore<FrontendPolicy, BackendPolicy>::ProcessorCore(
+    const std::vector<unsigned> &inst,
+    const std::vector<unsigned> &data,
+    unsigned entry,
+    unsigned memoryLatency,
+    BackendArgs... backendArgs)
+    : regFile(), frontend(inst),
+      backend(data, &regFile, memoryLatency, backendArgs...) {
+    frontend.jump(entry);
+}
+
+template <typename FrontendPolicy, typename BackendPolicy>
+ProcessorCore<FrontendPolicy, BackendPolicy>::ProcessorCore(
+    const MachineConfig &config)
+    : regFile(), frontend(std::vector<unsigned>(), config),
+      backend(std::vector<unsigned>(), &regFile, config) {
+    frontend.jump(0x80000000u);
+}
+
+/**
+ * @brief Processor 步进函数
+ *
+ * @return true 提交了EXTRA::EXIT
+ * @return false 其他情况
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+bool ProcessorCore<FrontendPolicy, BackendPolicy>::step() {
+    Tracer::nextCycle();
+    auto timers = backend.getTimers();
+    auto activity = getActivity();
+    bool finish = backend.template step<BackendPolicy>(frontend);
+    auto newInst = frontend.template step<FrontendPolicy>();
+    if (newInst.has_value()) {
+        if (!backend.dispatchInstruction(newInst.value()))
+            frontend.haltDispatch();
+        else if (Logger::isInfoEnabled<LogCategory::FRONTEND>()) {
+            std::stringstream ss;
+            ss << newInst.value();
+            Logger::Info<LogCategory::FRONTEND>(
+                "Dispatching %s with pc = %08x\n",
+                ss.str().c_str(),
+                newInst.value().pc);
+        }
+    }
+
+    idle = !finish && getActivity() == activity;
+    if (idle) {
+        auto current = backend.getTimers();
+        for (unsigned i = 0; i < current.size(); i++) {
+            if (current[i] > timers[i]) idle = false;
+            timerDelta[i] = timers[i] - current[i];
+        }
+    }
+    return finish;
+}
+
+/**
+ * @brief 跳过空闲周期
+ * 上一周期没有任何状态变化时，之后的周期在某个计时器到期之前都会重复同样的
+ * 行为，因此可以直接把计时器推进到即将到期的位置。开启信息输出时不跳过，
+ * 以保持逐周期的日志完整
+ *
+ * @param limit 最多跳过的周期数，用于按周期预算运行
+ * @return unsigned long 跳过的周期数，调用者应将其计入周期计数
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+unsigned long ProcessorCore<FrontendPolicy, BackendPolicy>::skipIdleCycles(
+    unsigned long limit) {
+    if (!idle || Logger::isAnyInfoEnabled()) return 0;
+    idle = false;
+
+    auto timers = backend.getTimers();
+    unsigned long cycles = -1ul;
+    for (unsigned i = 0; i < timers.size(); i++) {
+        if (timerDelta[i] == 0) continue;
+        // 保留最后一次倒计时，由下一次 step 完成到期时的状态变化
+        unsigned long remaining =
+            timers[i] == 0 ? 0 : (timers[i] - 1) / timerDelta[i];
+        cycles = std::min(cycles, remaining);
+    }
+    if (cycles == -1ul) return 0;
+    cycles = std::min(cycles, limit);
+    if (cycles == 0) return 0;
+
+    backend.advanceTimers(timerDelta, cycles);
+    Tracer::advanceCycle(cycles);
+    return cycles;
+}
+
+/**
+ * @brief 用于读取数据内存中的内容
+ *
+ * @param addr
+ * @return unsigned
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+unsigned ProcessorCore<FrontendPolicy, BackendPolicy>::readMem(
+    unsigned addr) const {
+    return backend.read(addr);
+}
+
+/**
+ * @brief 用于写入数据内存
+ *
+ * @param addr
+ * @param val
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+void ProcessorCore<FrontendPolicy, BackendPolicy>::writeMem(unsigned addr,
+                                                            unsigned val) {
+    backend.functionalWrite(addr, val);
+}
+
+/**
+ * @brief 用于读取寄存器当中的内容
+ *
+ * @param addr
+ * @return unsigned
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+unsigned ProcessorCore<FrontendPolicy, BackendPolicy>::readReg(
+    unsigned addr) const {
+    return regFile.read(addr);
+}
+
+/**
+ * @brief 用于写入寄存器
+ *
+ * @param addr
+ * @param value
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+void ProcessorCore<FrontendPolicy, BackendPolicy>::writeReg(unsigned addr,
+                                                            unsigned value) {
+    regFile.functionalWrite(addr, value);
+}
+
+/**
+ * @brief 让 CPU 加载指定程序
+ *
+ * @param inst
+ * @param data
+ * @param entry
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+void ProcessorCore<FrontendPolicy, BackendPolicy>::loadProgram(
+    const std::vector<unsigned> &inst,
+    const std::vector<unsigned> &data,
+    unsigned entry) {
+    loadImage(makeProgramImage(inst, data, entry));
+}
+
+/**
+ * @brief 装载程序映像，前端与后端只保留映像的引用
+ * 同一映像可以同时装载进任意多个处理器
+ *
+ * @param image 程序映像
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+void ProcessorCore<FrontendPolicy, BackendPolicy>::loadImage(
+    const ProgramImagePtr &image) {
+    frontend.reset(image, image->entry);
+    backend.reset(image);
+    regFile.reset();
+    idle = false;
+    Tracer::setCycle(0);
+    entry = image->entry;
+    snapshotImage.reset();
+}
+
+/**
+ * @brief 装载其他模型执行到一半的程序，寄存器堆清零
+ * 指令区沿用原映像，数据内存只复制 memory 中写入过的页
+ *
+ * @param image 程序映像
+ * @param memory 数据内存的当前内容
+ * @param pc 下一条执行的指令地址
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+void ProcessorCore<FrontendPolicy, BackendPolicy>::loadState(
+    const ProgramImagePtr &image, const Memory &memory, unsigned pc) {
+    frontend.reset(image, pc);
+    backend.reset(image);
+    backend.copyMemory(memory);
+    regFile.reset();
+    idle = false;
+    Tracer::setCycle(0);
+    entry = pc;
+    snapshotImage.reset();
+}
+
+/**
+ * @brief 为刚装载的程序建立快照
+ * 指令区在执行过程中不会被写入，快照只需记录寄存器堆与数据内存，
+ * 数据内存采用写时复制，建立快照本身不复制任何页
+ *
+ * @param image 刚装载的程序映像
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+void ProcessorCore<FrontendPolicy, BackendPolicy>::snapshotProgram(
+    const ProgramImagePtr &image) {
+    backend.takeSnapshot();
+    snapshotRegFile = regFile;
+    snapshotImage = image;
+}
+
+/**
+ * @brief 回到程序装载完成时的状态
+ * 不重新读取 elf，只恢复建立快照之后写入过的数据内存页
+ *
+ * @param image 要执行的程序映像
+ * @return true 已恢复
+ * @return false 没有该映像的快照，需要重新装载
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+bool ProcessorCore<FrontendPolicy, BackendPolicy>::restoreProgram(
+    const ProgramImagePtr &image) {
+    if (snapshotImage == nullptr || image != snapshotImage) return false;
+    frontend.reset(snapshotImage, entry);
+    backend.restoreSnapshot();
+    regFile = snapshotRegFile;
+    idle = false;
+    Tracer::setCycle(0);
+    return true;
+}
+
+/**
+ * @brief 把寄存器堆、前端与后端的完整状态保存到检查点文件
+ * 应在两次 step 之间调用，恢复后继续 step 与不中断的执行完全一致
+ *
+ * @param file 检查点路径
+ * @param cycle 此前已经执行的周期数
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+void ProcessorCore<FrontendPolicy, BackendPolicy>::saveCheckpoint(
+    const std::string &file, unsigned long cycle) const {
+    CheckpointWriter out;
+    out.write(cycle);
+    regFile.save(out);
+    frontend.save(out);
+    backend.save(out);
+    out.saveFile(file);
+    Logger::Warn("Saved checkpoint %s at cycle %lu", file.c_str(), cycle);
+}
+
+/**
+ * @brief 从检查点文件恢复完整状态，处理器类型与配置须与保存时一致
+ *
+ * @param file 检查点路径
+ * @return unsigned long 保存时已经执行的周期数
+ */
+template <typename FrontendPolicy, typename BackendPolicy>
+unsigned long ProcessorCore<FrontendPolicy, BackendPolicy>::restoreCheckpoint(
+    const std::string &file) {
+    CheckpointReader in(file);
+    unsigned long cycle;
+    in.read(cycle);
+    regFile.restore(in);
+    frontend.restore(in);
+    backend.restore(in);
+    if (!in.atEnd()) {
+        Logger::Error("Checkpoint %s has trailing data", file.c_str());
+        throw std::runtime_error("Checkpoint does not match processor");
+    }
+
+    idle = false;
+    snapshotImage.reset();
+    Tracer::setCycle(cycle);
+    Logger::Warn("Restored checkpoint %s at cycle %lu", file.c_str(), cycle);
+    return cycle;
+}
+
+using Processor = ProcessorCore<Frontend, Backend>;
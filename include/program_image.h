@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "instructions.h"
+
+// elf 符号表中的一项，type 与 bind 取值见 elf.h 中的 STT_* 与 STB_*
+struct ProgramSymbol {
+    std::string name;
+    unsigned value;
+    unsigned size;
+    unsigned char type;
+    unsigned char bind;
+};
+
+/**
+ * @brief 装载完成后只读的程序映像
+ * 由 elf 构造一次，通过 ProgramImagePtr 在任意多个前端、后端与功能模型之间
+ * 共享，装载程序时只复制指针
+ */
+struct ProgramImage {
+    // 从 0x80000000 开始的指令区，不含结尾附加的 EXIT
+    std::vector<unsigned> text;
+    // 指令区的预译码结果，末尾多一条 EXIT
+    std::vector<Instruction> decoded;
+    // 从 0x80400000 开始的数据区，之后直到数据内存结尾（含 .bss）均为 0
+    std::vector<unsigned> data;
+    unsigned entry = 0x80000000u;
+    // 按地址排序的符号表，不是从 elf 读入的映像为空
+    std::vector<ProgramSymbol> symbols;
+
+    // 指令区之后紧接 EXIT，再往后读作 0
+    [[nodiscard]] unsigned word(unsigned index) const {
+        return index < decoded.size() ? decoded[index].instruction : 0u;
+    }
+
+    [[nodiscard]] const ProgramSymbol *findSymbol(
+        const std::string &name) const;
+    [[nodiscard]] const ProgramSymbol *symbolAt(unsigned address) const;
+};
+
+using ProgramImagePtr = std::shared_ptr<const ProgramImage>;
+
+ProgramImagePtr makeProgramImage(const std::vector<unsigned> &text,
+                                 const std::vector<unsigned> &data,
+                                 unsigned entry);
+// 读取 elf，同一路径且修改时间未变时直接返回缓存的映像
+ProgramImagePtr readProgramImage(const std::string &name);
@@ -1,5 +1,8 @@
 #pragma once
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class RegisterFile {
     unsigned reg[32];
     bool busy[32] = {false};
@@ -16,4 +19,7 @@ public:
     void flush();
 
     void reset();
+
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "cache.h"
+#include "inst_trace.h"
+#include "machine_config.h"
+#include "processor.h"
+#include "runner.h"
+
+struct ReplayResult {
+    unsigned long cycles = 0;
+    unsigned long instructions = 0;
+    unsigned long mispredicts = 0;
+    // 统计方式与 BackendWithCache 相同，只有 cache 处理器统计
+    unsigned long memoryAccesses = 0;
+    unsigned long cacheHits = 0;
+};
+
+/**
+ * @brief 由指令追踪驱动的乱序核时序模型
+ * 流水线结构与周期级模型相同：四级前端、ROB、每个执行单元一个保留站与一条
+ * 执行流水线、每周期提交一条指令，访存指令按程序顺序发射，store 在提交时
+ * 写入存储层次。指令的操作数与结果不被计算，依赖关系由译码得到的寄存器号
+ * 决定，访存地址与跳转结果来自追踪。主存与 Cache 使用周期级模型的实现，
+ * 只用于计时，其中的数据始终为 0。
+ * 追踪中没有错误路径上的指令，预测错误的跳转之后前端停止取指，
+ * 直到该跳转提交后从正确的地址重新取指。
+ * 机器描述与周期级模型相同，修改结构参数不需要重新记录追踪。
+ * 与周期级模型的一致性尚未验证，周期级模型可以运行后用 trace-replay
+ * 的 --check 比较两者的周期数
+ */
+class ReplayCore {
+    // 取指得到的一条记录，mispredict 在取指时由预测器决定
+    struct FetchSlot {
+        unsigned long seq;
+        bool mispredict;
+    };
+    struct ROBSlot {
+        unsigned long seq;
+        bool ready, mispredict, executed, cacheHit;
+    };
+    struct RSSlot {
+        unsigned long seq;
+        unsigned robIdx;
+        // 等待的 ROB 表项，NONE 表示操作数已经就绪
+        unsigned wait[2];
+        bool busy;
+    };
+    struct Unit {
+        unsigned robIdx;
+        unsigned counter;
+        bool busy;
+    };
+    static constexpr unsigned NONE = -1u;
+
+    const MachineConfig config;
+    const InstTrace &trace;
+
+    std::unique_ptr<Frontend> predictor;
+    Memory memory;
+    std::unique_ptr<Cache> dcache;
+
+    std::optional<FetchSlot> IF1, IF2, ID, DISPATCH;
+    bool dispatchHalt = false;
+    unsigned long fetchSeq = 0;
+    // 取到预测错误的跳转后停止取指
+    bool fetchBlocked = false;
+
+    std::vector<ROBSlot> rob;
+    unsigned robHead = 0, robCount = 0;
+    std::array<std::vector<RSSlot>, 5> stations;
+    std::array<Unit, 5> units{};
+    // 各寄存器最近的写者所在的 ROB 表项
+    std::array<unsigned, 32> producer{};
+
+    ReplayResult result;
+
+    [[nodiscard]] const Instruction &decode(unsigned long seq) const {
+        return trace.decode(trace[seq]);
+    }
+    [[nodiscard]] unsigned operand(unsigned reg) const;
+
+    std::optional<FetchSlot> fetch();
+    void jump(unsigned long seq);
+    std::optional<FetchSlot> stepFrontend();
+    bool dispatch(const FetchSlot &x);
+    bool access(unsigned robIdx);
+    bool commit();
+    void flush();
+
+public:
+    ReplayCore(const InstTrace &trace, const MachineConfig &config);
+
+    bool step();
+    ReplayResult run();
+};
+
+ReplayResult replayTrace(const InstTrace &trace, const MachineConfig &config);
@@ -2,19 +2,21 @@
 #include <algorithm>
 #include <memory>
 #include <sstream>
+#include <vector>
 
+#include "checkpoint.h"
 #include "instructions.h"
 #include "issue_slot.h"
 #include "logger.h"
 #include "register_file.h"
 #include "rob.h"
 
-template <unsigned size>
+// 表项数在构造时给出
 class ReservationStation {
-    IssueSlot buffer[size];
+    std::vector<IssueSlot> buffer;
 
 public:
-    ReservationStation();
+    explicit ReservationStation(unsigned size);
     [[nodiscard]] bool hasEmptySlot() const;
     void insertInstruction(const Instruction &inst,
                            unsigned robIdx,
@@ -24,24 +26,25 @@ public:
     [[nodiscard]] bool canIssue() const;
     IssueSlot issue();
     void flush();
+
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
 };
 
-template <unsigned size>
-ReservationStation<size>::ReservationStation() {
+inline ReservationStation::ReservationStation(unsigned size) : buffer(size) {
     for (auto &slot : buffer) {
         slot.busy = false;
     }
 }
 
-template <unsigned size>
-bool ReservationStation<size>::hasEmptySlot() const {
-    return std::any_of(buffer, buffer + size, [](const IssueSlot &slot) {
-        return !slot.busy;
-    });
+inline bool ReservationStation::hasEmptySlot() const {
+    return std::any_of(
+        buffer.begin(), buffer.end(), [](const IssueSlot &slot) {
+            return !slot.busy;
+        });
 }
 
-template <unsigned size>
-void ReservationStation<size>::insertInstruction(
+inline void ReservationStation::insertInstruction(
     [[maybe_unused]] const Instruction &inst,
     [[maybe_unused]] unsigned robIdx,
     [[maybe_unused]] RegisterFile *const regFile,
@@ -59,32 +62,39 @@ void ReservationStation<size>::insertInstruction(
         "station.");
 }
 
-template <unsigned size>
-void ReservationStation<size>::wakeup(
+inline void ReservationStation::wakeup(
     [[maybe_unused]] const ROBStatusWritePort &x) {
     // TODO: Wakeup instructions according to ROB Write
     Logger::Error("Wakeup not implemented");
     std::__throw_runtime_error("Wakeup not implemented");
 }
 
-template <unsigned size>
-bool ReservationStation<size>::canIssue() const {
+inline bool ReservationStation::canIssue() const {
     // TODO: Decide whether an issueSlot is ready to issue.
     // Warning: Store instructions must be issued in order!!
     return false;
 }
 
-template <unsigned size>
-IssueSlot ReservationStation<size>::issue() {
+inline IssueSlot ReservationStation::issue() {
     // TODO: Issue a ready issue slot and remove it from reservation station.
     // Warning: Store instructions must be issued in order!!
     Logger::Error("No available slots for issuing");
     std::__throw_runtime_error("No available slots for issuing");
 }
 
-template <unsigned size>
-void ReservationStation<size>::flush() {
+inline void ReservationStation::flush() {
     for (auto &slot : buffer) {
         slot.busy = false;
     }
-}
\ No newline at end of file
+}
+inline void ReservationStation::save(CheckpointWriter &out) const {
+    out.writeTag("RS  ");
+    out.write((unsigned) buffer.size());
+    for (const auto &slot : buffer) out.write(slot);
+}
+
+inline void ReservationStation::restore(CheckpointReader &in) {
+    in.expectTag("RS  ");
+    in.expect((unsigned) buffer.size(), "reservation station size");
+    for (auto &slot : buffer) in.read(slot);
+}
@@ -1,8 +1,13 @@
 #pragma once
 #include <optional>
+#include <vector>
 
+#include "defines.h"
 #include "instructions.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 struct ROBStatusBundle {
     // ALU section
     unsigned result;
@@ -29,11 +34,15 @@ struct ROBEntry {
 };
 
 class ReorderBuffer {
-    ROBEntry buffer[ROB_SIZE];
+    std::vector<ROBEntry> buffer;
     unsigned pushPtr, popPtr;  // [popPtr, pushPtr)
+    // 推入、写回、提交与清空的累计次数
+    unsigned long activity = 0;
+    // 已提交的指令条数
+    unsigned long committed = 0;
 
 public:
-    ReorderBuffer();
+    explicit ReorderBuffer(unsigned size = ROB_SIZE);
     [[nodiscard]] bool canPush() const;
     [[nodiscard]] bool canPop() const;
     unsigned push(const Instruction &x, bool ready);
@@ -44,4 +53,10 @@ public:
     [[nodiscard]] unsigned getPopPtr() const;
     [[nodiscard]] unsigned read(unsigned addr) const;
     [[nodiscard]] bool checkReady(unsigned addr) const;
+    [[nodiscard]] unsigned long getActivity() const { return activity; }
+    [[nodiscard]] unsigned long getCommitted() const { return committed; }
+    void resetCommitted() { committed = 0; }
+
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
 };
@@ -1,9 +1,16 @@
+#pragma once
+
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "machine_config.h"
 #include "processor.h"
 #include "with_cache.h"
 
-enum class ProcessorType { normal, predict, cache };
+// 按机器描述实例化处理器与存储层次，程序之后由 execute 等装载
+std::unique_ptr<ProcessorAbstract> makeProcessor(const MachineConfig &config);
 
 unsigned execute(ProcessorAbstract *p, const std::string &name, int argc, ...);
 unsigned executeWithCache(ProcessorWithCache *p,
@@ -12,3 +19,40 @@ unsigned executeWithCache(ProcessorWithCache *p,
                           const std::string &name,
                           int argc,
                           ...);
+// 参数以数组给出的版本
+unsigned execute(ProcessorAbstract *p,
+                 const std::string &name,
+                 const std::vector<int> &args);
+unsigned executeWithCache(ProcessorWithCache *p,
+                          unsigned long &totalMemoryTime,
+                          unsigned long &totalCacheHitTime,
+                          const std::string &name,
+                          const std::vector<int> &args);
+
+// 在已装载程序的 CPU 上从第 counter 个周期继续执行，到程序结束、周期数达到
+// limit 返回的上限时停止，返回总周期数；checkpoint 非空时在第
+// checkpointCycle 个周期保存检查点
+unsigned long runUntil(ProcessorAbstract *p,
+                       unsigned long counter,
+                       bool &finished,
+                       const std::function<unsigned long()> &limit = nullptr,
+                       const std::string &checkpoint = "",
+                       unsigned long checkpointCycle = 0);
+
+// 执行到程序结束，或周期数达到 limit 返回的上限时停止；limit 每隔一段周期
+// 重新读取，finished 表示程序是否执行结束
+unsigned long executeWithLimit(ProcessorAbstract *p,
+                               const std::string &name,
+                               const std::vector<int> &args,
+                               const std::function<unsigned long()> &limit,
+                               bool &finished);
+
+// 执行到不少于 cycle 个周期时保存检查点，然后继续执行到程序结束
+unsigned executeWithCheckpoint(ProcessorAbstract *p,
+                               const std::string &checkpoint,
+                               unsigned long cycle,
+                               const std::string &name,
+                               int argc,
+                               ...);
+// 从检查点继续执行到程序结束，返回的周期数包含检查点之前的部分
+unsigned resume(ProcessorAbstract *p, const std::string &checkpoint);
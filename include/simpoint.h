@@ -0,0 +1,69 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "processor.h"
+
+// 一个区间的基本块向量，元素为（基本块编号，在该块中执行的指令条数）
+using BasicBlockVector = std::vector<std::pair<unsigned, unsigned long>>;
+
+struct BasicBlockProfile {
+    unsigned long intervalSize = 0;
+    std::vector<BasicBlockVector> intervals;
+    // 每个区间实际执行的指令条数，最后一个区间可能不满
+    std::vector<unsigned long> lengths;
+    // 基本块编号从 1 开始，按第一次执行的顺序分配
+    unsigned blockCount = 0;
+    unsigned long instructions = 0;
+};
+
+// 代表一个聚类的区间，weight 为该类占全部指令的比例
+struct SimPoint {
+    unsigned long interval;
+    unsigned cluster;
+    double weight;
+};
+
+struct SimPointConfig {
+    unsigned long intervalSize = 100000;
+    // 功能预热与周期级预热的指令条数
+    unsigned long warmup = 20000;
+    unsigned long detailedWarmup = 2000;
+};
+
+struct SimPointResult {
+    // 各代表区间按权重合成的 CPI
+    double cpi = 0;
+    unsigned long instructions = 0;
+    double estimatedCycles = 0;
+    // 周期级模型实际使用的周期数，含预热
+    unsigned long detailedCycles = 0;
+    unsigned long measuredPoints = 0;
+};
+
+BasicBlockProfile profileBasicBlocks(const std::string &name,
+                                     unsigned long intervalSize,
+                                     int argc,
+                                     ...);
+void writeBasicBlockVectors(const BasicBlockProfile &profile,
+                            std::ostream &out);
+
+std::vector<SimPoint> chooseSimPoints(const BasicBlockProfile &profile,
+                                      unsigned maxK,
+                                      unsigned seed = 0);
+void writeSimPoints(const std::vector<SimPoint> &points,
+                    std::ostream &simpoints,
+                    std::ostream &weights);
+std::vector<SimPoint> readSimPoints(std::istream &simpoints,
+                                    std::istream &weights);
+
+SimPointResult executeSimPoints(ProcessorAbstract *p,
+                                const std::string &name,
+                                const std::vector<SimPoint> &points,
+                                const SimPointConfig &config,
+                                int argc,
+                                ...);
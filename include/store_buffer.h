@@ -1,9 +1,13 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include "defines.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 struct StoreBufferSlot {
     unsigned storeAddress;
     unsigned storeData;
@@ -12,14 +16,16 @@ struct StoreBufferSlot {
 };
 
 class StoreBuffer {
-    StoreBufferSlot buffer[ROB_SIZE];
+    std::vector<StoreBufferSlot> buffer;
     unsigned pushPtr, popPtr;
 
 public:
-    StoreBuffer();
+    explicit StoreBuffer(unsigned size = ROB_SIZE);
     void push(unsigned addr, unsigned value, unsigned robIdx);
     StoreBufferSlot pop();
     StoreBufferSlot front();
     void flush();
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
     std::optional<unsigned> query(unsigned addr, unsigned robIdx, unsigned robPopPtr);
 };
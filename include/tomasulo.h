@@ -0,0 +1,131 @@
+#pragma once
+
+/*
+ * libtomasulo 的 C 接口
+ * 一个进程中可以同时存在任意多个处理器与程序映像，不同处理器可以在不同线程
+ * 中同时运行；同一个处理器不能被多个线程同时使用。
+ * 除特别说明外，函数返回 TOMASULO_OK 或负数的错误码，
+ * 出错原因可以通过 tomasulo_last_error 读取
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOMASULO_API __attribute__((visibility("default")))
+
+// 接口不兼容地修改时递增
+#define TOMASULO_API_VERSION 1
+
+enum tomasulo_status {
+    TOMASULO_OK = 0,
+    // 周期预算用完，程序尚未结束
+    TOMASULO_RUNNING = 1,
+    // 已提交 EXIT
+    TOMASULO_EXITED = 2,
+    TOMASULO_ERROR_ARGUMENT = -1,
+    TOMASULO_ERROR_NO_PROGRAM = -2,
+    TOMASULO_ERROR_INTERNAL = -3,
+};
+
+enum tomasulo_processor_type {
+    TOMASULO_NORMAL = 0,
+    TOMASULO_PREDICT = 1,
+    TOMASULO_CACHE = 2,
+};
+
+enum tomasulo_replace_type {
+    TOMASULO_FIFO = 0,
+    TOMASULO_LRU = 1,
+    TOMASULO_RANDOM = 2,
+};
+
+// 处理器配置，应先用 tomasulo_default_config 填入默认值再修改
+struct tomasulo_config {
+    int type;
+    unsigned latency;
+    // 以下只对 TOMASULO_CACHE 有效
+    unsigned cache_size;
+    unsigned block_size;
+    unsigned associativity;
+    int write_through;
+    int replace_type;
+    // 随机替换使用的种子
+    int seed;
+};
+
+// 自最近一次装载程序以来的统计
+struct tomasulo_stats {
+    uint64_t cycles;
+    uint64_t instructions;
+    // 只有 TOMASULO_CACHE 统计
+    uint64_t memory_accesses;
+    uint64_t cache_hits;
+    int exited;
+};
+
+typedef struct tomasulo_image tomasulo_image;
+typedef struct tomasulo_processor tomasulo_processor;
+
+TOMASULO_API int tomasulo_api_version(void);
+// 当前线程最近一次出错的原因，没有出错时为空串
+TOMASULO_API const char *tomasulo_last_error(void);
+// 打开或关闭警告输出，对进程中的全部处理器生效
+TOMASULO_API void tomasulo_set_warnings(int enabled);
+
+// 读取 elf，同一路径只读取一次；映像只读，可以同时装载进多个处理器
+TOMASULO_API tomasulo_image *tomasulo_image_load(const char *path);
+// 已装载该映像的处理器不受影响
+TOMASULO_API void tomasulo_image_free(tomasulo_image *image);
+TOMASULO_API uint32_t tomasulo_image_entry(const tomasulo_image *image);
+
+TOMASULO_API void tomasulo_default_config(struct tomasulo_config *config);
+// 配置无效时返回 NULL
+TOMASULO_API tomasulo_processor *tomasulo_create(
+    const struct tomasulo_config *config);
+// 按 INI 格式的机器配置文件创建，可以设置 ROB、保留站等全部结构参数；
+// 文件无法读取或配置无效时返回 NULL
+TOMASULO_API tomasulo_processor *tomasulo_create_from_file(const char *path);
+TOMASULO_API void tomasulo_destroy(tomasulo_processor *p);
+
+// 装载映像并清空全部状态与统计，sp、gp 取初始值，pc 为映像入口。
+// 主存延迟的随机数序列延续上一次运行，需要逐位重现时应使用新的处理器
+TOMASULO_API int tomasulo_load(tomasulo_processor *p,
+                               const tomasulo_image *image);
+
+// 批量读写寄存器 first 到 first + count - 1，写入 x0 被忽略
+TOMASULO_API int tomasulo_read_registers(const tomasulo_processor *p,
+                                         unsigned first,
+                                         uint32_t *values,
+                                         unsigned count);
+TOMASULO_API int tomasulo_write_registers(tomasulo_processor *p,
+                                          unsigned first,
+                                          const uint32_t *values,
+                                          unsigned count);
+
+// 批量读写数据内存，address 按 4 字节对齐，范围为 0x80400000 - 0x807fffff。
+// 写入不经过 Cache，应在装载之后、运行之前进行
+TOMASULO_API int tomasulo_read_memory(const tomasulo_processor *p,
+                                      uint32_t address,
+                                      uint32_t *words,
+                                      size_t count);
+TOMASULO_API int tomasulo_write_memory(tomasulo_processor *p,
+                                       uint32_t address,
+                                       const uint32_t *words,
+                                       size_t count);
+
+// 最多运行 cycles 个周期，0 表示运行到程序结束。
+// 返回 TOMASULO_RUNNING 或 TOMASULO_EXITED，ran 可以为 NULL
+TOMASULO_API int tomasulo_run(tomasulo_processor *p,
+                              uint64_t cycles,
+                              uint64_t *ran);
+
+TOMASULO_API int tomasulo_get_stats(const tomasulo_processor *p,
+                                    struct tomasulo_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "instructions.h"
+
+// 事件追踪记录的种类
+enum class TraceEvent : unsigned char {
+    FETCH,
+    DISPATCH,
+    ISSUE,
+    WRITEBACK,
+    COMMIT,
+    CACHE_HIT,
+    CACHE_MISS,
+    CACHE_EVICT,
+    MEMORY_READ,
+    MEMORY_WRITE,
+    NUM_EVENTS
+};
+
+/**
+ * @brief 定长的二进制事件记录
+ * 指令相关的事件填写 pc、instruction 与 robIdx，
+ * 访存相关的事件填写 address 与 value
+ */
+struct TraceRecord {
+    unsigned long cycle;
+    unsigned pc;
+    unsigned instruction;
+    unsigned address;
+    unsigned value;
+    unsigned short robIdx;
+    TraceEvent event;
+    // 执行单元（FUType）或 Cache 访问类型（0 读 1 写）
+    unsigned char unit;
+    unsigned reserved;
+};
+static_assert(sizeof(TraceRecord) == 32, "Trace record layout changed");
+
+constexpr char TRACE_MAGIC[8] = {'T', 'O', 'M', 'T', 'R', 'A', 'C', 'E'};
+constexpr unsigned TRACE_VERSION = 1u;
+constexpr unsigned short TRACE_NO_ROB = 0xFFFFu;
+
+// 追踪文件头，其后紧跟 capacity 条记录组成的环形缓冲区
+struct TraceHeader {
+    char magic[8];
+    unsigned version;
+    unsigned recordSize;
+    unsigned long capacity;
+    // 累计写入的记录数，超过 capacity 后最旧的记录被覆盖
+    unsigned long written;
+};
+static_assert(sizeof(TraceHeader) == 32, "Trace header layout changed");
+
+/**
+ * @brief 二进制事件追踪
+ * 记录写入映射到文件的环形缓冲区，进程异常退出时已写入的记录仍保留在
+ * 文件中，由 trace-decode 离线转换为可读的文本。
+ * 状态按线程保存，只记录调用 open 的线程上运行的处理器
+ */
+class Tracer {
+    static thread_local TraceHeader *header;
+    static thread_local TraceRecord *records;
+    static thread_local unsigned long next;
+    static thread_local unsigned long cycle;
+
+public:
+    static void open(const char *fileName, unsigned long capacity);
+    static void close();
+
+    [[nodiscard]] static bool isEnabled() { return records != nullptr; }
+
+    static void setCycle(unsigned long value) { cycle = value; }
+    static void nextCycle() { cycle++; }
+    static void advanceCycle(unsigned long cycles) { cycle += cycles; }
+
+    static void record(TraceEvent event,
+                       unsigned pc,
+                       unsigned instruction,
+                       unsigned address,
+                       unsigned value,
+                       unsigned robIdx,
+                       unsigned unit) {
+        if (records == nullptr) return;
+        auto &entry = records[next];
+        entry.cycle = cycle;
+        entry.pc = pc;
+        entry.instruction = instruction;
+        entry.address = address;
+        entry.value = value;
+        entry.robIdx = static_cast<unsigned short>(robIdx);
+        entry.event = event;
+        entry.unit = static_cast<unsigned char>(unit);
+        entry.reserved = 0;
+        if (++next == header->capacity) next = 0;
+        header->written++;
+    }
+
+    static void recordInstruction(TraceEvent event,
+                                  const Instruction &inst,
+                                  unsigned robIdx = TRACE_NO_ROB,
+                                  unsigned value = 0,
+                                  unsigned unit = 0) {
+        record(event, inst.pc, inst.instruction, 0, value, robIdx, unit);
+    }
+
+    static void recordAccess(TraceEvent event,
+                             unsigned address,
+                             unsigned value,
+                             unsigned unit = 0) {
+        record(event, 0, 0, address, value, TRACE_NO_ROB, unit);
+    }
+};
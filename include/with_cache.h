@@ -3,7 +3,10 @@
 #include "processor.h"
 #include "rob.h"
 
-class BackendWithCache : public Backend {
+class BackendWithCache final : public Backend {
+    // 后端步进函数静态调用执行接口
+    friend class Backend;
+
     Cache dcache;
     unsigned long totalMemoryTime, totalCacheHitTime;
 
@@ -24,45 +27,30 @@ public:
                      unsigned cacheBlockSize,
                      unsigned cacheAssociativity,
                      bool cacheWriteThrough,
-                     ReplaceType cacheReplaceType);
+                     ReplaceType cacheReplaceType,
+                     int seed = 0);
+    BackendWithCache(const std::vector<unsigned> &data,
+                     RegisterFile *reg,
+                     const MachineConfig &config);
     [[nodiscard]] unsigned read(unsigned addr) const override;
     bool writeMemoryHierarchy(unsigned address,
                               unsigned data,
                               unsigned byteEnable) override;
-    bool commitInstruction(const ROBEntry &entry, Frontend &frontend) override;
+    template <typename FrontendPolicy>
+    bool commitInstruction(const ROBEntry &entry, FrontendPolicy &frontend);
 
-    void reset(const std::vector<unsigned> &data) override;
-};
-
-class ProcessorWithCache : public ProcessorAbstract {
-    RegisterFile regFile;
-    Frontend frontend;
-    BackendWithCache backend;
+    void reset(const ProgramImagePtr &image) override;
+    void restoreSnapshot() override;
+    void save(CheckpointWriter &out) const override;
+    void restore(CheckpointReader &in) override;
 
-public:
-    ProcessorWithCache(const std::vector<unsigned> &inst,
-                       const std::vector<unsigned> &data,
-                       unsigned entry,
-                       unsigned memoryLatency,
-                       unsigned cacheSize,
-                       unsigned cacheBlockSize,
-                       unsigned cacheAssociativity,
-                       bool cacheWriteThrough,
-                       ReplaceType cacheReplaceType);
-    bool step() override;
-    [[nodiscard]] unsigned readMem(unsigned addr) const;
-    [[nodiscard]] unsigned readReg(unsigned addr) const;
-
-    void loadProgram(const std::vector<unsigned> &inst,
-                     const std::vector<unsigned> &data,
-                     unsigned entry) override;
-    void writeReg(unsigned addr, unsigned value) override;
-    void writeMem(unsigned addr, unsigned value) override;
-
-    unsigned long getTotalMemoryTime() const {
-        return backend.getTotalMemoryTime();
+    [[nodiscard]] unsigned long getActivity() const {
+        return Backend::getActivity() + dcache.getActivity();
     }
-    unsigned long getTotalCacheHitTime() const {
-        return backend.getTotalCacheHitTime();
+
+    void warmDataAccess(unsigned address, bool write) {
+        dcache.warm(address, write, memory);
     }
-};
\ No newline at end of file
+};
+
+using ProcessorWithCache = ProcessorCore<Frontend, BackendWithCache>;
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "processor.h"
 
 struct BTBEntry {
@@ -7,38 +9,26 @@ struct BTBEntry {
     bool valid;
 };
 
-class FrontendWithPredict : public Frontend {
-    BTBEntry btb[1024];
+class FrontendWithPredict final : public Frontend {
+    // 前端步进函数静态调用预测接口
+    friend class Frontend;
+
+    std::vector<BTBEntry> btb;
 
 protected:
     BranchPredictBundle bpuFrontendUpdate(unsigned int pc) override;
 
 public:
     explicit FrontendWithPredict(const std::vector<unsigned> &inst);
+    // BTB 的表项数来自 config
+    FrontendWithPredict(const std::vector<unsigned> &inst,
+                        const MachineConfig &config);
     [[nodiscard]] unsigned calculateNextPC(unsigned pc) const override;
     void bpuBackendUpdate(const BpuUpdateData &x) override;
 
-    void reset(const std::vector<unsigned> &inst, unsigned entry) override;
+    void reset(const ProgramImagePtr &image, unsigned entry) override;
+    void save(CheckpointWriter &out) const override;
+    void restore(CheckpointReader &in) override;
 };
 
-class ProcessorWithPredict : public ProcessorAbstract {
-    RegisterFile regFile;
-    FrontendWithPredict frontend;
-    Backend backend;
-
-public:
-    ProcessorWithPredict(const std::vector<unsigned> &inst,
-                         const std::vector<unsigned> &data,
-                         unsigned entry,
-                         unsigned memoryLatency);
-    bool step() override;
-    [[nodiscard]] unsigned readMem(unsigned addr) const;
-    [[nodiscard]] unsigned readReg(unsigned addr) const;
-
-    void loadProgram(const std::vector<unsigned> &inst,
-                     const std::vector<unsigned> &data,
-                     unsigned entry) override;
-
-    void writeReg(unsigned addr, unsigned value) override;
-    void writeMem(unsigned addr, unsigned value) override;
-};
+using ProcessorWithPredict = ProcessorCore<FrontendWithPredict, Backend>;
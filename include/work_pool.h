@@ -0,0 +1,18 @@
+#pragma once
+
+#include <functional>
+
+/**
+ * @brief 用 threads 个线程并行执行 body(0) 到 body(count - 1)
+ * 任务预先轮流分配到各线程的队列，线程从自己队列的头部取任务，
+ * 队列为空时从其他线程队列的尾部窃取，耗时不均的任务也能保持所有线程忙碌。
+ * threads 为 0 时使用全部硬件线程；body 抛出异常后不再开始新的任务，
+ * 全部线程结束后重新抛出第一个异常
+ *
+ * @param count 任务数
+ * @param threads 线程数
+ * @param body 任务函数，参数为任务编号
+ */
+void parallelFor(unsigned long count,
+                 unsigned threads,
+                 const std::function<void(unsigned long)> &body);
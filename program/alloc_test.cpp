@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "logger.h"
+#include "runner.h"
+
+namespace {
+
+// 全局 operator new 的调用次数
+unsigned long allocations = 0;
+
+/**
+ * @brief 在新建的处理器上执行 elf 两次，统计第二次执行中的内存分配次数
+ * 第一次执行作为预热：稀疏内存在首次写入某页时分配该页，写时复制快照
+ * 在首次写入时分配保存旧内容的缓冲区，这些都只发生一次。
+ * 恢复快照后的第二次执行中 step 与 skipIdleCycles 不应再分配内存
+ *
+ * @param type 处理器类型
+ * @param name elf 路径
+ * @return true 第二次执行没有分配且周期数与第一次相同
+ * @return false 其他情况
+ */
+bool check(ProcessorType type, const std::string &name) {
+    MachineConfig config;
+    config.type = type;
+    auto p = makeProcessor(config);
+    unsigned long first = execute(p.get(), name, std::vector<int>());
+    if (!p->restoreProgram(readProgramImage(name))) {
+        printf("%-8s cannot restore the program snapshot\n",
+               getProcessorTypeName(type));
+        return false;
+    }
+    p->writeReg(11, 0x807fff00);
+
+    unsigned long cycles = 0, base = allocations;
+    bool finish = false;
+    do {
+        finish = p->step();
+        cycles++;
+        if (!finish) cycles += p->skipIdleCycles();
+    } while (!finish);
+
+    unsigned long count = allocations - base;
+    printf("%-8s %lu cycles, %lu allocations after warm-up\n",
+           getProcessorTypeName(type),
+           cycles,
+           count);
+    return count == 0 && cycles == first;
+}
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+    allocations++;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, [[maybe_unused]] std::size_t size) noexcept {
+    std::free(p);
+}
+
+int main() {
+    std::string name;
+    std::cout << "Elf file name: ";
+    std::cin >> name;
+
+    // 日志会格式化字符串，关闭后 step 的路径上不应有分配
+    Logger::setInfoOutput(false);
+    Logger::setWarnOutput(false);
+
+    bool passed = true;
+    for (auto type :
+         {ProcessorType::normal, ProcessorType::predict, ProcessorType::cache})
+        passed = check(type, name) && passed;
+    printf(passed ? "PASSED\n" : "FAILED\n");
+    return passed ? 0 : 1;
+}
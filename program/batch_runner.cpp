@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "cxxopts.hpp"
+#include "logger.h"
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("tomasulo-batch-runner",
+                             "Tomasulo Parallel Batch Runner");
+    auto adder = options.add_options();
+    adder("h,help", "Print Usage");
+    adder("m,manifest",
+          "Job manifest, one elf with key=value options per line",
+          cxxopts::value<std::string>());
+    adder("config",
+          "Machine configuration file used by jobs as default",
+          cxxopts::value<std::string>());
+    adder("o,output",
+          "Result file, stdout if omitted",
+          cxxopts::value<std::string>());
+    adder("format",
+          "Result format: csv or json",
+          cxxopts::value<std::string>()->default_value("csv"));
+    adder("j,threads",
+          "Worker threads, 0 for all hardware threads",
+          cxxopts::value<unsigned>()->default_value("0"));
+    adder("v,verbose", "Print progress of each job");
+    adder("d,debug", "Print debug infos");
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") != 0 || !result.unmatched().empty() ||
+        result.count("manifest") == 0) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+    Logger::setInfoOutput(result.count("debug") != 0);
+    Logger::setWarnOutput(result.count("verbose") != 0 ||
+                          result.count("debug") != 0);
+
+    auto formatString = result["format"].as<std::string>();
+    BatchFormat format;
+    if (formatString == "csv") {
+        format = BatchFormat::CSV;
+    } else if (formatString == "json") {
+        format = BatchFormat::JSON;
+    } else {
+        Logger::Error("Unknown result format %s", formatString.c_str());
+        return -1;
+    }
+
+    auto manifestName = result["manifest"].as<std::string>();
+    std::ifstream manifest(manifestName);
+    if (!manifest) {
+        Logger::Error("Cannot open manifest %s", manifestName.c_str());
+        return -1;
+    }
+    // 未给出配置文件时与 runner、sampler 一样使用带 Cache 的处理器
+    MachineConfig machine;
+    machine.type = ProcessorType::cache;
+    if (result.count("config") != 0)
+        machine = readMachineConfig(result["config"].as<std::string>());
+    auto jobs = readBatchManifest(manifest, machine);
+
+    std::ofstream file;
+    if (result.count("output") != 0) {
+        file.open(result["output"].as<std::string>());
+        if (!file) {
+            Logger::Error("Cannot open output file %s",
+                          result["output"].as<std::string>().c_str());
+            return -1;
+        }
+    }
+    std::ostream &out = file.is_open() ? file : std::cout;
+
+    auto start = std::chrono::steady_clock::now();
+    writeBatchHeader(out, format);
+    auto results = runBatch(
+        jobs, result["threads"].as<unsigned>(), [&](const BatchResult &x) {
+            writeBatchResult(out, format, jobs[x.job], x);
+        });
+    double wall = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+    unsigned long failed = 0;
+    double busy = 0;
+    for (const auto &x : results) {
+        failed += !x.error.empty();
+        busy += x.seconds;
+    }
+    fprintf(stderr,
+            "[  BATCH  ] %lu jobs, %lu failed, %.2f s wall, %.2f s in jobs\n",
+            results.size(),
+            failed,
+            wall,
+            busy);
+    return failed == 0 ? 0 : 1;
+}
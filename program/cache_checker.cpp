@@ -9,11 +9,10 @@
 #include "cache-exp.h"
 #include "cxxopts.hpp"
 #include "logger.h"
+#include "machine_config.h"
 #include "processor.h"
 #include "with_cache.h"
 
-[[maybe_unused]] ProcessorWithCache *processorWC = nullptr;
-
 int main(int argc, char **argv) {
     cxxopts::Options options("tomasulo-cache-runner",
                              "Tomasulo With Cache Runner");
@@ -23,8 +22,14 @@ int main(int argc, char **argv) {
           cxxopts::value<std::string>()->default_value("output.log"));
     adder("h,help", "Print Usage");
     adder("f,file", "Input check file", cxxopts::value<std::string>());
+    adder("config",
+          "Machine configuration file, cache parameters come from check file",
+          cxxopts::value<std::string>());
     // adder("s,script-file", "Script file", cxxopts::value<std::string>());
     adder("d,debug", "Print debug infos");
+    adder("log-categories",
+          "Subsystems printed with --debug, e.g. cache,rob",
+          cxxopts::value<std::string>());
 
     auto result = options.parse(argc, argv);
     if (result.count("help") != 0 || !result.unmatched().empty() || argc == 1) {
@@ -36,8 +41,16 @@ int main(int argc, char **argv) {
     } else {
         Logger::setInfoOutput(false);
     }
+    if (result.count("log-categories") != 0 &&
+        !Logger::setCategoryOutput(
+            result["log-categories"].as<std::string>().c_str()))
+        return -1;
 
     auto inputFile = result["file"].as<std::string>();
+    MachineConfig machine;
+    if (result.count("config") != 0)
+        machine = readMachineConfig(result["config"].as<std::string>());
+    machine.type = ProcessorType::cache;
 
     int T;
     FILE *input = fopen(inputFile.c_str(), "r");
@@ -70,15 +83,15 @@ int main(int argc, char **argv) {
         fscanf(input, "%d", &buffer);
         bool doMatMul = buffer != 0;
 
-        processorWC = new ProcessorWithCache(std::vector<unsigned>(),
-                                             std::vector<unsigned>(),
-                                             0x80000000u,
-                                             latency,
-                                             cacheSize,
-                                             blockSize,
-                                             associativity,
-                                             writeThrough,
-                                             replaceType);
+        auto config = machine;
+        config.latency = latency;
+        config.cacheSize = cacheSize;
+        config.blockSize = blockSize;
+        config.associativity = associativity;
+        config.writeThrough = writeThrough;
+        config.replaceType = replaceType;
+        auto processor = std::make_unique<ProcessorWithCache>(config);
+        auto *processorWC = processor.get();
 
         int cacheSizeResult = sizeOK ? (int) MeasureCacheSize(processorWC) : 0;
 
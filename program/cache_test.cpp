@@ -9,12 +9,12 @@
 #include "cache-exp.h"
 #include "cxxopts.hpp"
 #include "logger.h"
+#include "machine_config.h"
 #include "processor.h"
 #include "runner.h"
+#include "trace.h"
 #include "with_cache.h"
 
-[[maybe_unused]] ProcessorWithCache *processorWC = nullptr;
-
 int main(int argc, char **argv) {
     cxxopts::Options options("tomasulo-cache-runner",
                              "Tomasulo With Cache Runner");
@@ -24,12 +24,24 @@ int main(int argc, char **argv) {
           cxxopts::value<std::string>()->default_value("output.log"));
     adder("h,help", "Print Usage");
     adder("d,debug", "Print debug infos");
-    adder("l,latency",
-          "Memory Latency",
-          cxxopts::value<int>()->default_value("0"));
-    adder("cache-size", "Cache Size", cxxopts::value<int>());
-    adder("block-size", "Cache Block Size", cxxopts::value<int>());
-    adder("a,associativity", "Cache Associativity", cxxopts::value<int>());
+    adder("log-categories",
+          "Subsystems printed with --debug, e.g. cache,rob",
+          cxxopts::value<std::string>());
+    adder("trace",
+          "Record binary pipeline events into file",
+          cxxopts::value<std::string>());
+    adder("trace-size",
+          "Number of records kept in the trace ring buffer",
+          cxxopts::value<unsigned long>()->default_value("1048576"));
+    adder("config",
+          "Machine configuration file, overridden by the options below",
+          cxxopts::value<std::string>());
+    adder("l,latency", "Memory Latency", cxxopts::value<std::string>());
+    adder("cache-size", "Cache Size", cxxopts::value<std::string>());
+    adder("block-size", "Cache Block Size", cxxopts::value<std::string>());
+    adder("a,associativity",
+          "Cache Associativity",
+          cxxopts::value<std::string>());
     adder("write-through", "Cache Write Through");
     adder("replace-type", "Cache Replace Type", cxxopts::value<std::string>());
     adder("matmul", "Do Matrix Multiplication");
@@ -44,35 +56,39 @@ int main(int argc, char **argv) {
     } else {
         Logger::setInfoOutput(false);
     }
-
-    std::vector<unsigned> inst, data;
-    auto latency = result["latency"].as<int>();
-
-    auto cacheSize = result["cache-size"].as<int>();
-    auto blockSize = result["block-size"].as<int>();
-    auto associativity = result["associativity"].as<int>();
-    bool writeThrough = result.count("write-through") != 0;
-    auto typeString = result["replace-type"].as<std::string>();
+    if (result.count("log-categories") != 0 &&
+        !Logger::setCategoryOutput(
+            result["log-categories"].as<std::string>().c_str()))
+        return -1;
+    if (result.count("trace") != 0)
+        Tracer::open(result["trace"].as<std::string>().c_str(),
+                     result["trace-size"].as<unsigned long>());
+
+    const char *const overrides[][2] = {
+        {"latency", "memory.latency"},
+        {"cache-size", "cache.size"},
+        {"block-size", "cache.block_size"},
+        {"associativity", "cache.associativity"},
+        {"replace-type", "cache.replace"},
+    };
+    // 没有配置文件时主存延迟默认为 0
+    MachineConfig base;
+    base.latency = 0;
+    auto machine = parseMachineOptions(result, overrides, base);
+    machine.type = ProcessorType::cache;
+    if (result.count("write-through") != 0) machine.writeThrough = true;
+    printMachineConfig(machine);
+
+    int cacheSize = (int) machine.cacheSize;
+    int blockSize = (int) machine.blockSize;
+    int associativity = (int) machine.associativity;
+    bool writeThrough = machine.writeThrough;
+    auto replaceType = machine.replaceType;
 
     bool doMatMul = result.count("matmul") != 0;
 
-    ReplaceType replaceType;
-    if (typeString == "FIFO")
-        replaceType = ReplaceType::FIFO;
-    else if (typeString == "LRU")
-        replaceType = ReplaceType::LRU;
-    else
-        replaceType = ReplaceType::RANDOM;
-
-    processorWC = new ProcessorWithCache(std::vector<unsigned>(),
-                                         std::vector<unsigned>(),
-                                         0x80000000u,
-                                         latency,
-                                         cacheSize,
-                                         blockSize,
-                                         associativity,
-                                         writeThrough,
-                                         replaceType);
+    auto processor = std::make_unique<ProcessorWithCache>(machine);
+    auto *processorWC = processor.get();
 
     int cacheSizeResult = (int) MeasureCacheSize(processorWC);
 
@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "tomasulo.h"
+
+namespace {
+
+// 一次执行结束时的可见结果
+struct RunResult {
+    int status = TOMASULO_ERROR_INTERNAL;
+    tomasulo_stats stats{};
+    unsigned long long hash = 0;
+};
+
+/**
+ * @brief 通过 C 接口新建处理器，按 slice 个周期的预算反复运行到程序结束
+ *
+ * @param config 处理器配置
+ * @param image 程序映像
+ * @param slice 每次调用 tomasulo_run 的周期预算，0 表示一次运行到结束
+ * @return RunResult 状态、统计以及寄存器堆与数据内存的散列
+ */
+RunResult run(const tomasulo_config &config,
+              const tomasulo_image *image,
+              uint64_t slice) {
+    RunResult result;
+    tomasulo_processor *p = tomasulo_create(&config);
+    if (p == nullptr) return result;
+
+    uint32_t argument = 0x807fff00;
+    result.status = tomasulo_load(p, image);
+    if (result.status == TOMASULO_OK)
+        result.status = tomasulo_write_registers(p, 11, &argument, 1);
+
+    uint64_t total = 0;
+    while (result.status == TOMASULO_OK || result.status == TOMASULO_RUNNING) {
+        uint64_t ran = 0;
+        result.status = tomasulo_run(p, slice, &ran);
+        total += ran;
+    }
+    if (result.status == TOMASULO_EXITED) {
+        tomasulo_get_stats(p, &result.stats);
+        // 每次调用报告的周期数之和应等于统计中的周期数
+        if (total != result.stats.cycles)
+            result.status = TOMASULO_ERROR_INTERNAL;
+
+        // FNV-1a
+        result.hash = 0xcbf29ce484222325ull;
+        auto mix = [&](uint32_t x) {
+            result.hash ^= x;
+            result.hash *= 0x100000001b3ull;
+        };
+        uint32_t registers[32];
+        tomasulo_read_registers(p, 0, registers, 32);
+        for (uint32_t x : registers) mix(x);
+        static uint32_t memory[0x400000 / 4];
+        tomasulo_read_memory(p, 0x80400000u, memory, 0x400000 / 4);
+        for (uint32_t x : memory) mix(x);
+    }
+    tomasulo_destroy(p);
+    return result;
+}
+
+}  // namespace
+
+int main() {
+    std::string name;
+    std::cout << "Elf file name: ";
+    std::cin >> name;
+
+    tomasulo_set_warnings(0);
+    bool passed = tomasulo_api_version() == TOMASULO_API_VERSION;
+
+    // 无效的配置不创建处理器，并给出原因
+    tomasulo_config invalid{};
+    tomasulo_default_config(&invalid);
+    invalid.type = 7;
+    tomasulo_processor *rejected = tomasulo_create(&invalid);
+    bool reported = rejected == nullptr && strlen(tomasulo_last_error()) != 0;
+    printf("invalid config: %s\n", reported ? "rejected" : "accepted");
+    tomasulo_destroy(rejected);
+    passed = passed && reported;
+
+    tomasulo_image *image = tomasulo_image_load(name.c_str());
+    if (image == nullptr) {
+        printf("Cannot load %s: %s\nFAILED\n", name.c_str(),
+               tomasulo_last_error());
+        return 1;
+    }
+
+    const int types[] = {TOMASULO_NORMAL, TOMASULO_PREDICT, TOMASULO_CACHE};
+    const char *typeNames[] = {"normal", "predict", "cache"};
+    for (int type : types) {
+        tomasulo_config config{};
+        tomasulo_default_config(&config);
+        config.type = type;
+        auto whole = run(config, image, 0);
+        auto sliced = run(config, image, 1000);
+        bool same = whole.status == TOMASULO_EXITED &&
+                    sliced.status == TOMASULO_EXITED &&
+                    whole.stats.cycles == sliced.stats.cycles &&
+                    whole.stats.instructions == sliced.stats.instructions &&
+                    whole.stats.cache_hits == sliced.stats.cache_hits &&
+                    whole.hash == sliced.hash;
+        printf("%-8s: %llu cycles whole, %llu in slices, state %s\n",
+               typeNames[type],
+               (unsigned long long) whole.stats.cycles,
+               (unsigned long long) sliced.stats.cycles,
+               whole.hash == sliced.hash ? "equal" : "different");
+        if (whole.status != TOMASULO_EXITED)
+            printf("%-8s: %s\n", typeNames[type], tomasulo_last_error());
+        passed = passed && same;
+    }
+    tomasulo_image_free(image);
+
+    printf(passed ? "PASSED\n" : "FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -7,13 +7,44 @@
 #include <vector>
 
 #include "cxxopts.hpp"
+#include "dbt.h"
+#include "fast_forward.h"
+#include "functional.h"
+#include "interval.h"
 #include "logger.h"
+#include "machine_config.h"
 #include "processor.h"
 #include "runner.h"
-#include "with_predict.h"
+#include "trace.h"
 
-[[maybe_unused]] Processor *processor = nullptr;
-[[maybe_unused]] ProcessorWithPredict *processorWP = nullptr;
+/**
+ * @brief 不建模时序，仅用功能模型执行 elf，可用于生成和核对标准答案
+ *
+ * @param name elf 路径
+ * @param native 使用二进制翻译执行
+ * @param regFile 功能模型的寄存器堆
+ * @param memory 功能模型的数据内存
+ * @return unsigned long 执行的指令条数
+ */
+unsigned long executeFunctional(const std::string &name,
+                                bool native,
+                                RegisterFile &regFile,
+                                Memory &memory) {
+    auto image = readProgramImage(name);
+    memory.mapImage(image);
+    regFile.functionalWrite(11, 0x807fff00);
+
+    if (native) {
+        DBTCore core(regFile, memory);
+        core.reset(image, image->entry);
+        Logger::Warn("Running %s on binary translator", name.c_str());
+        return core.run();
+    }
+    FunctionalCore core(regFile, memory);
+    core.reset(image, image->entry);
+    Logger::Warn("Running %s on functional core", name.c_str());
+    return core.run();
+}
 
 int main(int argc, char **argv) {
     cxxopts::Options options("tomasulo-tester", "Tomasulo Simulator Tester");
@@ -25,10 +56,42 @@ int main(int argc, char **argv) {
     adder("f,file", "Input elf file", cxxopts::value<std::string>());
     adder("c,chk-file", "Check file", cxxopts::value<std::string>());
     adder("d,debug", "Print debug infos");
+    adder("log-categories",
+          "Subsystems printed with --debug, e.g. cache,rob",
+          cxxopts::value<std::string>());
+    adder("trace",
+          "Record binary pipeline events into file",
+          cxxopts::value<std::string>());
+    adder("trace-size",
+          "Number of records kept in the trace ring buffer",
+          cxxopts::value<unsigned long>()->default_value("1048576"));
     adder("p,predict", "Use frontend with predictor");
-    adder("l,latency",
-          "Memory Latency",
-          cxxopts::value<int>()->default_value("5"));
+    adder("functional", "Run on functional core without timing");
+    adder("dbt", "Run on binary translator without timing");
+    adder("interval",
+          "Estimate cycles with the interval model on the functional core");
+    adder("fast-forward",
+          "Instructions executed functionally before warm-up",
+          cxxopts::value<unsigned long>()->default_value("0"));
+    adder("warmup",
+          "Instructions executed functionally while warming cache and BTB",
+          cxxopts::value<unsigned long>()->default_value("0"));
+    adder("detail",
+          "Instructions executed on the Tomasulo core, 0 runs to the end",
+          cxxopts::value<unsigned long>()->default_value("0"));
+    adder("save-checkpoint",
+          "Save the full simulator state into file",
+          cxxopts::value<std::string>());
+    adder("checkpoint-cycle",
+          "Cycle at which the checkpoint is saved",
+          cxxopts::value<unsigned long>()->default_value("0"));
+    adder("restore-checkpoint",
+          "Resume the Tomasulo core from a checkpoint instead of the elf",
+          cxxopts::value<std::string>());
+    adder("config",
+          "Machine configuration file, overridden by the options below",
+          cxxopts::value<std::string>());
+    adder("l,latency", "Memory Latency", cxxopts::value<std::string>());
 
     auto result = options.parse(argc, argv);
     if (result.count("help") != 0 || !result.unmatched().empty() || argc == 1) {
@@ -40,43 +103,143 @@ int main(int argc, char **argv) {
     } else {
         Logger::setInfoOutput(false);
     }
+    if (result.count("log-categories") != 0 &&
+        !Logger::setCategoryOutput(
+            result["log-categories"].as<std::string>().c_str()))
+        return -1;
+    if (result.count("trace") != 0)
+        Tracer::open(result["trace"].as<std::string>().c_str(),
+                     result["trace-size"].as<unsigned long>());
 
-    bool withPredict = false;
-    if (result.count("predict") != 0) {
-        withPredict = true;
-        Logger::Warn("Running branch prediction testcase");
+    const char *const overrides[][2] = {{"latency", "memory.latency"}};
+    auto machine = parseMachineOptions(result, overrides);
+    if (result.count("predict") != 0) machine.type = ProcessorType::predict;
+    printMachineConfig(machine);
+    bool withPredict = machine.type == ProcessorType::predict;
+    if (withPredict) Logger::Warn("Running branch prediction testcase");
+
+    FastForwardConfig config;
+    config.fastForward = result["fast-forward"].as<unsigned long>();
+    config.warmup = result["warmup"].as<unsigned long>();
+    config.detail = result["detail"].as<unsigned long>();
+    config.native = result.count("dbt") != 0;
+    bool fastForward = result.count("fast-forward") != 0 ||
+                       result.count("warmup") != 0 ||
+                       result.count("detail") != 0;
+
+    bool native = !fastForward && config.native;
+    bool functional = native || result.count("functional") != 0;
+    if (functional && withPredict) {
+        Logger::Error("Functional core does not model branch prediction");
+        return -1;
+    }
+    if (functional && fastForward) {
+        Logger::Error("Fast-forward mode ends on the Tomasulo core");
+        return -1;
     }
 
-    auto elfFile = result["file"].as<std::string>();
-
-    auto latency = result["latency"].as<int>();
-
-    if (!withPredict)
-        processor = new Processor(std::vector<unsigned int>(),
-                                  std::vector<unsigned int>(),
-                                  0x80000000u,
-                                  latency);
-    else {
-        processor = new Processor(std::vector<unsigned int>(),
-                                  std::vector<unsigned int>(),
-                                  0x80000000u,
-                                  latency);
-        processorWP = new ProcessorWithPredict(std::vector<unsigned int>(),
-                                               std::vector<unsigned int>(),
-                                               0x80000000u,
-                                               latency);
+    auto saveCheckpoint = result.count("save-checkpoint") != 0
+                              ? result["save-checkpoint"].as<std::string>()
+                              : std::string();
+    auto restoreCheckpoint =
+        result.count("restore-checkpoint") != 0
+            ? result["restore-checkpoint"].as<std::string>()
+            : std::string();
+    auto checkpointCycle = result["checkpoint-cycle"].as<unsigned long>();
+    bool checkpoint = !saveCheckpoint.empty() || !restoreCheckpoint.empty();
+    if (checkpoint && (functional || fastForward)) {
+        Logger::Error("Checkpoints are only taken on the Tomasulo core");
+        return -1;
+    }
+    bool interval = result.count("interval") != 0;
+    if (interval && (functional || fastForward || checkpoint)) {
+        Logger::Error("Interval model runs the whole program functionally");
+        return -1;
     }
 
-    unsigned counter = execute(withPredict ? (ProcessorAbstract *) processorWP
-                                           : (ProcessorAbstract *) processor,
-                               elfFile,
-                               0);
+    auto elfFile = result.count("file") != 0
+                       ? result["file"].as<std::string>()
+                       : std::string();
+    if (elfFile.empty() && (restoreCheckpoint.empty() || withPredict)) {
+        Logger::Error("Input elf file is required");
+        return -1;
+    }
 
-    Logger::Warn("Finished in %u cycles.", counter);
+    // 分支预测测例与结构相同但不带预测器的处理器比较
+    auto baseline = machine;
+    if (withPredict) baseline.type = ProcessorType::normal;
+    auto processor = makeProcessor(baseline);
+    std::unique_ptr<ProcessorAbstract> processorWP;
+    if (withPredict) processorWP = makeProcessor(machine);
+    RegisterFile functionalRegFile;
+    Memory functionalMemory(0);
+
+    // 快进模式下只统计周期级模型执行的部分
+    bool finished = true;
+    // 检查点只用于被测的处理器，对照组从头执行
+    auto run = [&](ProcessorAbstract *p) -> unsigned {
+        bool tested = withPredict ? p == processorWP.get()
+                                  : p == processor.get();
+        if (tested && !restoreCheckpoint.empty())
+            return resume(p, restoreCheckpoint);
+        if (tested && !saveCheckpoint.empty())
+            return executeWithCheckpoint(
+                p, saveCheckpoint, checkpointCycle, elfFile, 0);
+        if (!fastForward) return execute(p, elfFile, 0);
+        auto stats = executeFastForward(p, elfFile, config, 0);
+        Logger::Warn(
+            "Skipped %lu and warmed %lu instructions, then committed %lu "
+            "instructions in %lu cycles.",
+            stats.fastForwarded,
+            stats.warmed,
+            stats.committed,
+            stats.cycles);
+        finished = finished && stats.finished;
+        return stats.cycles;
+    };
+
+    IntervalConfig intervalConfig;
+    intervalConfig.machine = machine;
+    auto runInterval = [&](ProcessorType type) -> unsigned {
+        intervalConfig.machine.type = type;
+        functionalRegFile.reset();
+        auto stats = executeInterval(
+            elfFile, intervalConfig, functionalRegFile, functionalMemory, {});
+        Logger::Warn(
+            "Interval model: %lu instructions, %lu mispredicts, %lu "
+            "multiplies and divides, %lu memory accesses.",
+            stats.instructions,
+            stats.mispredicts,
+            stats.multiplies + stats.divides,
+            stats.memoryAccesses);
+        Logger::Warn(
+            "Estimated cycles: base %.0f, branch %.0f, long latency %.0f, "
+            "memory %.0f.",
+            stats.baseCycles,
+            stats.branchCycles,
+            stats.longLatencyCycles,
+            stats.memoryCycles);
+        return stats.cycles;
+    };
+
+    unsigned counter = 0;
+    if (interval) {
+        counter = runInterval(machine.type);
+        Logger::Warn("Finished in about %u cycles.", counter);
+    } else if (functional) {
+        unsigned long count = executeFunctional(
+            elfFile, native, functionalRegFile, functionalMemory);
+        Logger::Warn("Finished in %lu instructions.", count);
+    } else {
+        counter = run(withPredict ? processorWP.get() : processor.get());
+        Logger::Warn("Finished in %u cycles.", counter);
+    }
 
     if (withPredict) {
         Logger::Warn("Running normal testcase");
-        unsigned counterWithoutPredict = execute(processor, elfFile, 0);
+        unsigned counterWithoutPredict =
+            interval ? runInterval(ProcessorType::normal)
+                     : run(processor.get());
 
         Logger::Warn("Finished in %u cycles.", counterWithoutPredict);
         Logger::Warn(
@@ -92,6 +255,24 @@ int main(int argc, char **argv) {
                 "[   OK    ] Branch prediction running time check passed\n");
     }
 
+    if (!finished) {
+        Logger::Warn("Program did not reach EXIT, skipping result check");
+        return 0;
+    }
+
+    auto readMem = [&](unsigned addr) {
+        if (functional || interval) {
+            return functionalMemory.functionalRead((addr - 0x80400000u) >> 2u);
+        }
+        return withPredict ? processorWP->readMem(addr)
+                           : processor->readMem(addr);
+    };
+    auto readReg = [&](unsigned addr) {
+        if (functional || interval) return functionalRegFile.read(addr);
+        return withPredict ? processorWP->readReg(addr)
+                           : processor->readReg(addr);
+    };
+
     auto chkFile = result["chk-file"].as<std::string>();
     std::ifstream chkIn(chkFile);
 
@@ -119,8 +300,7 @@ int main(int argc, char **argv) {
             }
             uint32_t answer;
             ss >> answer;
-            auto result = withPredict ? processorWP->readMem(addr)
-                                      : processor->readMem(addr);
+            auto result = readMem(addr);
             if (result != answer) {
                 fprintf(stderr,
                         "[ FAILED  ] On testcase %d, answer is %d, but %d "
@@ -135,8 +315,7 @@ int main(int argc, char **argv) {
             ss >> addr;
             uint32_t answer;
             ss >> answer;
-            auto result = withPredict ? processorWP->readReg(addr)
-                                      : processor->readReg(addr);
+            auto result = readReg(addr);
             if (result != answer) {
                 fprintf(stderr,
                         "[ FAILED  ] On testcase %d, answer is %d, but %d "
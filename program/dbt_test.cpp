@@ -0,0 +1,366 @@
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dbt.h"
+#include "defines.h"
+#include "functional.h"
+#include "logger.h"
+#include "mem.h"
+#include "program_image.h"
+#include "register_file.h"
+
+namespace {
+
+// RV32IM 指令编码
+unsigned rType(unsigned funct7,
+               unsigned rs2,
+               unsigned rs1,
+               unsigned funct3,
+               unsigned rd,
+               unsigned opcode) {
+    return funct7 << 25u | rs2 << 20u | rs1 << 15u | funct3 << 12u | rd << 7u |
+           opcode;
+}
+
+unsigned iType(int imm, unsigned rs1, unsigned funct3, unsigned rd,
+               unsigned opcode) {
+    return ((unsigned) imm & 0xFFFu) << 20u | rs1 << 15u | funct3 << 12u |
+           rd << 7u | opcode;
+}
+
+unsigned sType(int imm, unsigned rs2, unsigned rs1, unsigned funct3) {
+    auto x = (unsigned) imm;
+    return (x >> 5u & 0x7Fu) << 25u | rs2 << 20u | rs1 << 15u |
+           funct3 << 12u | (x & 0x1Fu) << 7u | 0x23u;
+}
+
+unsigned bType(int offset, unsigned rs2, unsigned rs1, unsigned funct3) {
+    auto x = (unsigned) offset;
+    return (x >> 12u & 1u) << 31u | (x >> 5u & 0x3Fu) << 25u | rs2 << 20u |
+           rs1 << 15u | funct3 << 12u | (x >> 1u & 0xFu) << 8u |
+           (x >> 11u & 1u) << 7u | 0x63u;
+}
+
+unsigned uType(unsigned imm, unsigned rd, unsigned opcode) {
+    return (imm & 0xFFFFFu) << 12u | rd << 7u | opcode;
+}
+
+unsigned jType(int offset, unsigned rd) {
+    auto x = (unsigned) offset;
+    return (x >> 20u & 1u) << 31u | (x >> 1u & 0x3FFu) << 21u |
+           (x >> 11u & 1u) << 20u | (x >> 12u & 0xFFu) << 12u | rd << 7u |
+           0x6Fu;
+}
+
+constexpr unsigned EXIT_INSTRUCTION = 0x0Bu;
+
+// x1 保存返回地址，x10 保存数据区基址，x11 为循环计数，其余寄存器随机写入
+constexpr unsigned RA = 1, BASE = 10, COUNTER = 11;
+constexpr unsigned DATA_WORDS = 1024;
+constexpr unsigned COMPARED_WORDS = 16 * MEMORY_PAGE_WORDS;
+
+unsigned uniform(std::mt19937 &random, unsigned low, unsigned high) {
+    return std::uniform_int_distribution<unsigned>(low, high)(random);
+}
+
+// 随机写入的寄存器之一，包括 x0
+unsigned randomTarget(std::mt19937 &random) {
+    unsigned x = uniform(random, 0, 28);
+    return x == 0 ? 0 : x < 9 ? x + 1 : x + 3;
+}
+
+/**
+ * @brief 随机的运算指令，目标总是随机写入的寄存器
+ *
+ * @param random
+ * @return unsigned 指令编码
+ */
+unsigned randomAluOp(std::mt19937 &random) {
+    unsigned rd = randomTarget(random);
+    unsigned rs1 = uniform(random, 0, 31), rs2 = uniform(random, 0, 31);
+    switch (uniform(random, 0, 3)) {
+    case 0: {
+        // ADD SUB SLL SLT SLTU XOR SRL SRA OR AND
+        const unsigned funct3[] = {0, 0, 1, 2, 3, 4, 5, 5, 6, 7};
+        const unsigned funct7[] = {0, 0x20, 0, 0, 0, 0, 0, 0x20, 0, 0};
+        unsigned i = uniform(random, 0, 9);
+        return rType(funct7[i], rs2, rs1, funct3[i], rd, 0x33u);
+    }
+    case 1:
+        // MUL MULH MULHSU MULHU DIV DIVU REM REMU
+        return rType(1, rs2, rs1, uniform(random, 0, 7), rd, 0x33u);
+    case 2: {
+        unsigned funct3 = uniform(random, 0, 7);
+        int imm = (int) uniform(random, 0, 4095) - 2048;
+        if (funct3 == 1) imm &= 0x1F;
+        if (funct3 == 5) imm = (imm & 0x1F) | (imm & 0x400);
+        return iType(imm, rs1, funct3, rd, 0x13u);
+    }
+    default:
+        return uType(uniform(random, 0, 0xFFFFF),
+                     rd,
+                     uniform(random, 0, 1) ? 0x37u : 0x17u);
+    }
+}
+
+struct GeneratedProgram {
+    std::vector<unsigned> text;
+    std::vector<unsigned> data;
+    // 只写随机寄存器的运算指令，可以替换为另一条运算指令
+    std::vector<unsigned> patchable;
+};
+
+/**
+ * @brief 生成随机的 RV32IM 程序
+ * 程序由若干个计数循环组成，循环体中有运算、访存、向前的分支与跳转、
+ * 经 AUIPC 与 JALR 的间接跳转以及对子程序的调用，最后以 EXIT 结束。
+ * 访存都落在数据区开头的 4KB 中，循环次数固定，因此程序总能执行结束
+ */
+class ProgramGenerator {
+    std::mt19937 &random;
+    GeneratedProgram program;
+    // 调用指令的位置与被调用的子程序编号
+    std::vector<std::pair<unsigned, unsigned>> calls;
+
+    unsigned uniform(unsigned low, unsigned high) {
+        return ::uniform(random, low, high);
+    }
+
+    unsigned target() { return randomTarget(random); }
+
+    unsigned source() { return uniform(0, 31); }
+
+    void emit(unsigned x) { program.text.push_back(x); }
+
+    void memoryOp() {
+        unsigned kind = uniform(0, 7);
+        // LB LH LW LBU LHU SB SH SW 的 funct3 与对齐要求
+        const unsigned funct3[] = {0, 1, 2, 4, 5, 0, 1, 2};
+        const unsigned align[] = {1, 2, 4, 1, 2, 1, 2, 4};
+        int offset = (int) (uniform(0, 4095) / align[kind] * align[kind]) -
+                     2048;
+        if (kind < 5)
+            emit(iType(offset, BASE, funct3[kind], target(), 0x03u));
+        else
+            emit(sType(offset, source(), BASE, funct3[kind]));
+    }
+
+    void straight(unsigned count) {
+        for (unsigned i = 0; i < count; i++) {
+            if (uniform(0, 3) == 0) {
+                memoryOp();
+            } else {
+                program.patchable.push_back(program.text.size());
+                emit(randomAluOp(random));
+            }
+        }
+    }
+
+    void loopBody() {
+        unsigned pieces = uniform(1, 6);
+        for (unsigned i = 0; i < pieces; i++) {
+            unsigned skip = uniform(1, 3);
+            switch (uniform(0, 5)) {
+            case 0: {
+                const unsigned funct3[] = {0, 1, 4, 5, 6, 7};
+                emit(bType(4 * (int) (skip + 1),
+                           source(),
+                           source(),
+                           funct3[uniform(0, 5)]));
+                straight(skip);
+                break;
+            }
+            case 1:
+                emit(jType(4 * (int) (skip + 1), target()));
+                straight(skip);
+                break;
+            case 2: {
+                // JALR 的目标是 AUIPC 所在地址加上偏移
+                unsigned base = target();
+                if (base == 0) base = 2;
+                emit(uType(0, base, 0x17u));
+                emit(iType(4 * (int) (skip + 2), base, 0, target(), 0x67u));
+                straight(skip);
+                break;
+            }
+            case 3:
+                calls.emplace_back(program.text.size(), uniform(0, 2));
+                emit(0);
+                break;
+            default:
+                straight(uniform(1, 8));
+                break;
+            }
+        }
+    }
+
+public:
+    explicit ProgramGenerator(std::mt19937 &random) : random(random) {}
+
+    GeneratedProgram generate() {
+        program.data.resize(DATA_WORDS);
+        for (unsigned &x : program.data) x = random();
+
+        emit(uType(0x80401, BASE, 0x37u));
+        emit(iType(-2048, BASE, 0, BASE, 0x13u));
+        for (unsigned i = 2; i < 32; i++) {
+            if (i == BASE || i == COUNTER) continue;
+            emit(uType(random(), i, 0x37u));
+            emit(iType((int) uniform(0, 4095) - 2048, i, 0, i, 0x13u));
+        }
+
+        unsigned loops = uniform(1, 6);
+        for (unsigned i = 0; i < loops; i++) {
+            emit(iType((int) uniform(1, 8), 0, 0, COUNTER, 0x13u));
+            auto begin = (unsigned) program.text.size();
+            // 偶尔生成很短的循环体，整个循环只有一个基本块
+            if (uniform(0, 4) == 0)
+                straight(1);
+            else
+                loopBody();
+            emit(iType(-1, COUNTER, 0, COUNTER, 0x13u));
+            auto back = ((int) begin - (int) program.text.size()) * 4;
+            emit(bType(back, 0, COUNTER, 1));
+        }
+        emit(EXIT_INSTRUCTION);
+
+        // 子程序不修改 x1，最后经 JALR 返回
+        std::vector<unsigned> entries;
+        for (unsigned i = 0; i < 3; i++) {
+            entries.push_back(program.text.size());
+            straight(uniform(1, 10));
+            emit(iType(0, RA, 0, 0, 0x67u));
+        }
+        for (auto [position, index] : calls) {
+            auto offset = ((int) entries[index] - (int) position) * 4;
+            program.text[position] = jType(offset, RA);
+        }
+        return program;
+    }
+};
+
+// 执行方式：一次执行到结束、按随机预算分段执行、分段执行并在段间修改指令
+enum class Mode { whole, sliced, patched };
+
+const char *getModeName(Mode mode) {
+    switch (mode) {
+    case Mode::whole:
+        return "whole";
+    case Mode::sliced:
+        return "sliced";
+    default:
+        return "sliced+patch";
+    }
+}
+
+/**
+ * @brief 在 FunctionalCore 与 DBTCore 上执行同一程序并比较体系结构状态
+ * 每段执行后比较寄存器、pc、已执行的指令条数与是否结束，结束后比较
+ * 数据内存开头的 64KB。修改指令时 DBTCore 使用 writeInstruction，
+ * FunctionalCore 以修改后的映像重新装载并从当前 pc 继续
+ *
+ * @param seed 随机数种子
+ * @param mode 执行方式
+ * @param instructions 累加执行的指令条数
+ * @return true 两者的状态始终一致
+ */
+bool compare(unsigned seed, Mode mode, unsigned long &instructions) {
+    std::mt19937 random(seed);
+    auto program = ProgramGenerator(random).generate();
+    auto image = makeProgramImage(program.text, program.data, 0x80000000u);
+
+    RegisterFile refRegs, dbtRegs;
+    Memory refMemory(0), dbtMemory(0);
+    refMemory.mapImage(image);
+    dbtMemory.mapImage(image);
+    FunctionalCore ref(refRegs, refMemory);
+    DBTCore dbt(dbtRegs, dbtMemory);
+    ref.reset(image, image->entry);
+    dbt.reset(image, image->entry);
+
+    unsigned long refCount = 0, dbtCount = 0;
+    auto text = program.text;
+    try {
+        while (!ref.hasExited()) {
+            unsigned long budget = mode == Mode::whole
+                                       ? -1ul
+                                       : std::uniform_int_distribution<
+                                             unsigned long>(1, 40)(random);
+            refCount += ref.run(budget);
+            dbtCount += dbt.run(budget);
+
+            bool same = refCount == dbtCount &&
+                        ref.getPC() == dbt.getPC() &&
+                        ref.hasExited() == dbt.hasExited();
+            for (unsigned i = 0; i < 32; i++)
+                same = same && refRegs.read(i) == dbtRegs.read(i);
+            if (!same) {
+                printf("seed %u %s: diverged after %lu instructions, "
+                       "pc 0x%08x / 0x%08x\n",
+                       seed,
+                       getModeName(mode),
+                       refCount,
+                       ref.getPC(),
+                       dbt.getPC());
+                return false;
+            }
+
+            if (mode == Mode::patched && !ref.hasExited() &&
+                random() % 4 == 0) {
+                unsigned index =
+                    program.patchable[random() % program.patchable.size()];
+                text[index] = randomAluOp(random);
+                dbt.writeInstruction(0x80000000u + (index << 2u), text[index]);
+                ref.reset(makeProgramImage(text, program.data, image->entry),
+                          ref.getPC());
+            }
+        }
+    } catch (const std::exception &e) {
+        printf("seed %u %s: %s\n", seed, getModeName(mode), e.what());
+        return false;
+    }
+
+    // 访存只落在开头的 4KB，比较更大的范围以发现写错位置的存储
+    if (refMemory.functionalRead(0, COMPARED_WORDS) !=
+        dbtMemory.functionalRead(0, COMPARED_WORDS)) {
+        printf("seed %u %s: data memory differs\n", seed, getModeName(mode));
+        return false;
+    }
+    instructions += refCount;
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    Logger::setInfoOutput(false);
+    Logger::setWarnOutput(false);
+
+    constexpr unsigned programs = 200;
+    {
+        RegisterFile regFile;
+        Memory memory(0);
+        DBTCore probe(regFile, memory);
+        printf("DBT backend: %s\n",
+               probe.isNative() ? "native x86-64" : "interpreter");
+    }
+
+    bool passed = true;
+    for (auto mode : {Mode::whole, Mode::sliced, Mode::patched}) {
+        unsigned long instructions = 0;
+        unsigned failed = 0;
+        for (unsigned seed = 1; seed <= programs; seed++)
+            if (!compare(seed, mode, instructions)) failed++;
+        printf("%-12s: %u programs, %lu instructions, %u mismatched\n",
+               getModeName(mode),
+               programs,
+               instructions,
+               failed);
+        passed = passed && failed == 0;
+    }
+    printf(passed ? "PASSED\n" : "FAILED\n");
+    return passed ? 0 : 1;
+}
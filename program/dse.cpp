@@ -0,0 +1,132 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cxxopts.hpp"
+#include "dse.h"
+#include "logger.h"
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("tomasulo-dse",
+                             "Tomasulo Design Space Exploration");
+    auto adder = options.add_options();
+    adder("h,help", "Print Usage");
+    adder("f,file", "Input elf file", cxxopts::value<std::string>());
+    adder("a,args",
+          "Comma separated program arguments",
+          cxxopts::value<std::vector<int>>());
+    adder("config",
+          "Machine configuration for parameters outside the space",
+          cxxopts::value<std::string>());
+    adder("s,space",
+          "Design space file, the built-in space if omitted",
+          cxxopts::value<std::string>());
+    adder("strategy",
+          "Search strategy: grid, random or hill-climb",
+          cxxopts::value<std::string>()->default_value("random"));
+    adder("n,samples",
+          "Points evaluated by random and hill-climb search",
+          cxxopts::value<unsigned long>()->default_value("64"));
+    adder("seed",
+          "Seed of random sampling",
+          cxxopts::value<unsigned>()->default_value("0"));
+    adder("max-storage",
+          "Skip configurations with more on-chip bytes, 0 for no limit",
+          cxxopts::value<unsigned long>()->default_value("0"));
+    adder("no-prune", "Run every configuration to the end");
+    adder("c,cache",
+          "Result cache, resumes an interrupted exploration",
+          cxxopts::value<std::string>());
+    adder("o,output",
+          "Result file, stdout if omitted",
+          cxxopts::value<std::string>());
+    adder("j,threads",
+          "Worker threads, 0 for all hardware threads",
+          cxxopts::value<unsigned>()->default_value("0"));
+    adder("v,verbose", "Print progress of each configuration");
+    adder("d,debug", "Print debug infos");
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") != 0 || !result.unmatched().empty() ||
+        result.count("file") == 0) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+    Logger::setInfoOutput(result.count("debug") != 0);
+    Logger::setWarnOutput(result.count("verbose") != 0 ||
+                          result.count("debug") != 0);
+
+    DseOptions dse;
+    auto strategy = result["strategy"].as<std::string>();
+    if (strategy == "grid") {
+        dse.strategy = SearchStrategy::grid;
+    } else if (strategy == "random") {
+        dse.strategy = SearchStrategy::random;
+    } else if (strategy == "hill-climb") {
+        dse.strategy = SearchStrategy::hillClimb;
+    } else {
+        Logger::Error("Unknown search strategy %s", strategy.c_str());
+        return -1;
+    }
+    dse.elf = result["file"].as<std::string>();
+    if (result.count("args") != 0)
+        dse.args = result["args"].as<std::vector<int>>();
+    dse.threads = result["threads"].as<unsigned>();
+    dse.samples = result["samples"].as<unsigned long>();
+    dse.seed = result["seed"].as<unsigned>();
+    dse.maxStorage = result["max-storage"].as<unsigned long>();
+    dse.prune = result.count("no-prune") == 0;
+    if (result.count("cache") != 0)
+        dse.cacheFile = result["cache"].as<std::string>();
+
+    // 未给出配置文件时与 runner、batch-runner 一样使用带 Cache 的处理器
+    MachineConfig machine;
+    machine.type = ProcessorType::cache;
+    if (result.count("config") != 0)
+        machine = readMachineConfig(result["config"].as<std::string>());
+    // 探索的各点在这一基准配置上修改参数
+    printMachineConfig(machine);
+    auto space = result.count("space") != 0
+                     ? readDseSpace(result["space"].as<std::string>(), machine)
+                     : defaultDseSpace(machine);
+
+    std::ofstream file;
+    if (result.count("output") != 0) {
+        file.open(result["output"].as<std::string>());
+        if (!file) {
+            Logger::Error("Cannot open output file %s",
+                          result["output"].as<std::string>().c_str());
+            return -1;
+        }
+    }
+    std::ostream &out = file.is_open() ? file : std::cout;
+
+    auto start = std::chrono::steady_clock::now();
+    auto results = exploreDesignSpace(space, dse);
+    double wall = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+    writeDseHeader(out, space);
+    unsigned long counts[3] = {}, cached = 0, front = 0;
+    for (const auto &x : results) {
+        writeDseResult(out, space, x);
+        counts[static_cast<int>(x.status)]++;
+        cached += x.cached;
+        front += x.pareto;
+    }
+    fprintf(stderr,
+            "[   DSE   ] %lu configurations: %lu done, %lu pruned, "
+            "%lu failed, %lu cached, %lu on the Pareto front, %.2f s\n",
+            results.size(),
+            counts[static_cast<int>(DseStatus::done)],
+            counts[static_cast<int>(DseStatus::pruned)],
+            counts[static_cast<int>(DseStatus::failed)],
+            cached,
+            front,
+            wall);
+    return counts[static_cast<int>(DseStatus::failed)] == 0 ? 0 : 1;
+}
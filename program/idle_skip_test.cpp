@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "defines.h"
+#include "logger.h"
+#include "runner.h"
+
+namespace {
+
+// 执行结束时的可见状态
+struct RunState {
+    unsigned long cycles = 0;
+    unsigned long instructions = 0;
+    unsigned long long hash = 0;
+};
+
+/**
+ * @brief 在新建的处理器上执行 elf 到结束
+ *
+ * @param config 机器配置
+ * @param name elf 路径
+ * @param skip 是否跳过空闲周期
+ * @return RunState 周期数、提交的指令条数以及寄存器堆与数据内存的散列
+ */
+RunState run(const MachineConfig &config, const std::string &name, bool skip) {
+    auto p = makeProcessor(config);
+    p->loadImage(readProgramImage(name));
+    p->writeReg(11, 0x807fff00);
+
+    RunState state;
+    bool finish = false;
+    do {
+        finish = p->step();
+        state.cycles++;
+        if (!finish && skip) state.cycles += p->skipIdleCycles();
+    } while (!finish);
+    state.instructions = p->getCommittedInstructions();
+
+    // FNV-1a
+    state.hash = 0xcbf29ce484222325ull;
+    auto mix = [&](unsigned x) {
+        state.hash ^= x;
+        state.hash *= 0x100000001b3ull;
+    };
+    for (unsigned i = 0; i < 32; i++) mix(p->readReg(i));
+    for (unsigned i = 0; i < DATA_MEM_SIZE; i += 4)
+        mix(p->readMem(0x80400000u + i));
+    return state;
+}
+
+}  // namespace
+
+int main() {
+    std::string name;
+    std::cout << "Elf file name: ";
+    std::cin >> name;
+
+    // 开启信息输出时不跳过空闲周期，两次执行将没有区别
+    Logger::setInfoOutput(false);
+    Logger::setWarnOutput(false);
+
+    const ProcessorType types[] = {
+        ProcessorType::normal, ProcessorType::predict, ProcessorType::cache};
+    bool passed = true;
+    for (auto type : types) {
+        for (unsigned latency : {5u, 100u}) {
+            MachineConfig config;
+            config.type = type;
+            config.latency = latency;
+            auto full = run(config, name, false);
+            auto skipped = run(config, name, true);
+            bool same = full.cycles == skipped.cycles &&
+                        full.instructions == skipped.instructions &&
+                        full.hash == skipped.hash;
+            printf("%-8s latency %3u: %lu cycles stepped, %lu with skipping, "
+                   "state %s\n",
+                   getProcessorTypeName(type),
+                   latency,
+                   full.cycles,
+                   skipped.cycles,
+                   full.hash == skipped.hash ? "equal" : "different");
+            passed = passed && same;
+        }
+    }
+    printf(passed ? "PASSED\n" : "FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cxxopts.hpp"
+#include "interval.h"
+#include "logger.h"
+#include "machine_config.h"
+#include "runner.h"
+
+namespace {
+
+/**
+ * @brief 用功能模型执行 elf，返回区间模型的事件数与估计
+ *
+ * @param name elf 路径
+ * @param config 区间模型的参数
+ * @param args 4字节整型参数
+ * @return IntervalResult
+ */
+IntervalResult estimate(const std::string &name,
+                        const IntervalConfig &config,
+                        const std::vector<int> &args) {
+    RegisterFile regFile;
+    Memory memory(0);
+    return executeInterval(name, config, regFile, memory, args);
+}
+
+double relativeError(unsigned long estimate, unsigned long cycles) {
+    return ((double) estimate - (double) cycles) / (double) cycles;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("tomasulo-interval-calibrate",
+                             "Fit interval model coefficients to the "
+                             "detailed model");
+    auto adder = options.add_options();
+    adder("h,help", "Print Usage");
+    adder("f,file",
+          "Comma separated input elf files",
+          cxxopts::value<std::vector<std::string>>());
+    adder("a,args",
+          "Comma separated program arguments, used for every elf",
+          cxxopts::value<std::vector<int>>());
+    adder("config",
+          "Machine configuration file for parameters not swept",
+          cxxopts::value<std::string>());
+    adder("latencies",
+          "Comma separated memory latencies",
+          cxxopts::value<std::vector<unsigned>>()->default_value("5,20"));
+    adder("cache-sizes",
+          "Comma separated cache sizes of the cache processor",
+          cxxopts::value<std::vector<unsigned>>()->default_value(
+              "256,1024,4096"));
+    adder("d,debug", "Print debug infos");
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") != 0 || !result.unmatched().empty() ||
+        result.count("file") == 0) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+    Logger::setInfoOutput(result.count("debug") != 0);
+    Logger::setWarnOutput(result.count("debug") != 0);
+
+    auto files = result["file"].as<std::vector<std::string>>();
+    std::vector<int> args;
+    if (result.count("args") != 0) args = result["args"].as<std::vector<int>>();
+    MachineConfig base;
+    if (result.count("config") != 0)
+        base = readMachineConfig(result["config"].as<std::string>());
+
+    // 每个程序在每个延迟下运行不带 Cache 与各容量带 Cache 的处理器
+    auto latencies = result["latencies"].as<std::vector<unsigned>>();
+    auto cacheSizes = result["cache-sizes"].as<std::vector<unsigned>>();
+    std::vector<MachineConfig> machines;
+    for (unsigned latency : latencies) {
+        MachineConfig machine = base;
+        machine.type = ProcessorType::normal;
+        machine.latency = latency;
+        machines.push_back(machine);
+        for (unsigned size : cacheSizes) {
+            machine.type = ProcessorType::cache;
+            machine.cacheSize = size;
+            machines.push_back(machine);
+        }
+    }
+    for (const auto &machine : machines) machine.validate();
+
+    IntervalConfig initial;
+    std::vector<IntervalSample> samples;
+    std::vector<std::string> names;
+    for (const auto &name : files) {
+        for (const auto &machine : machines) {
+            IntervalSample x;
+            x.machine = machine;
+            auto p = makeProcessor(machine);
+            x.cycles = execute(p.get(), name, args);
+            initial.machine = machine;
+            x.events = estimate(name, initial, args);
+            samples.push_back(x);
+            names.push_back(name);
+        }
+    }
+
+    auto fitted = calibrateInterval(initial, samples);
+
+    double before = 0, after = 0;
+    printf("%-24s %-6s %7s %6s %10s %10s %10s\n",
+           "elf",
+           "type",
+           "latency",
+           "cache",
+           "detailed",
+           "initial",
+           "fitted");
+    for (unsigned i = 0; i < samples.size(); i++) {
+        const auto &x = samples[i];
+        fitted.machine = x.machine;
+        auto cycles = estimate(names[i], fitted, args).cycles;
+        before += std::fabs(relativeError(x.events.cycles, x.cycles));
+        after += std::fabs(relativeError(cycles, x.cycles));
+        printf("%-24s %-6s %7u %6u %10lu %10lu %10lu\n",
+               names[i].c_str(),
+               getProcessorTypeName(x.machine.type),
+               x.machine.latency,
+               x.machine.type == ProcessorType::cache ? x.machine.cacheSize
+                                                      : 0,
+               x.cycles,
+               x.events.cycles,
+               cycles);
+    }
+    printf("mean relative error: %.2f%% initial, %.2f%% fitted\n",
+           before / (double) samples.size() * 100,
+           after / (double) samples.size() * 100);
+    printf("resolveCycles = %.4f\n", fitted.resolveCycles);
+    printf("longLatencyExposure = %.4f\n", fitted.longLatencyExposure);
+    printf("hitExposure = %.4f\n", fitted.hitExposure);
+    printf("missExposure = %.4f\n", fitted.missExposure);
+    return 0;
+}
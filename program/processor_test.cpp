@@ -4,8 +4,6 @@
 
 #include "logger.h"
 
-[[maybe_unused]] Processor *processor = nullptr;
-
 int main() {
     std::string name;
     std::cout << "Elf file name: ";
@@ -18,16 +16,16 @@ int main() {
 
     unsigned entry = readElf(name, inst, data);
 
-    processor = new Processor(inst, data, entry, 4);
+    Processor processor(inst, data, entry, 4);
 
     bool finish = false;
     do {
-        finish = processor->step();
+        finish = processor.step();
     } while (!finish);
 
     for (int p = 0; p < 64; p += 4) {
         printf(
-            "%08x: %u\n", 0x80400000 + p, processor->readMem(0x80400000 + p));
+            "%08x: %u\n", 0x80400000 + p, processor.readMem(0x80400000 + p));
     }
 
     return 0;
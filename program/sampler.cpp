@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cxxopts.hpp"
+#include "fast_forward.h"
+#include "logger.h"
+#include "machine_config.h"
+#include "with_cache.h"
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("tomasulo-sampler",
+                             "Tomasulo Statistical Sampling Runner");
+    auto adder = options.add_options();
+    adder("h,help", "Print Usage");
+    adder("f,file", "Input elf file", cxxopts::value<std::string>());
+    adder("d,debug", "Print debug infos");
+    adder("log-categories",
+          "Subsystems printed with --debug, e.g. cache,rob",
+          cxxopts::value<std::string>());
+    adder("config",
+          "Machine configuration file, overridden by the options below",
+          cxxopts::value<std::string>());
+    adder("l,latency", "Memory Latency", cxxopts::value<std::string>());
+    adder("cache-size", "Cache Size", cxxopts::value<std::string>());
+    adder("block-size", "Cache Block Size", cxxopts::value<std::string>());
+    adder("a,associativity",
+          "Cache Associativity",
+          cxxopts::value<std::string>());
+    adder("write-through", "Cache Write Through");
+    adder("replace-type",
+          "Cache Replace Type",
+          cxxopts::value<std::string>());
+    adder("period",
+          "Instructions between two measurement units",
+          cxxopts::value<unsigned long>()->default_value("100000"));
+    adder("warmup",
+          "Instructions of functional warm-up before each unit",
+          cxxopts::value<unsigned long>()->default_value("20000"));
+    adder("detail-warmup",
+          "Instructions of detailed warm-up before each unit",
+          cxxopts::value<unsigned long>()->default_value("2000"));
+    adder("unit",
+          "Instructions in each measurement unit",
+          cxxopts::value<unsigned long>()->default_value("1000"));
+    adder("error",
+          "Relative error bound of CPI to stop early",
+          cxxopts::value<double>()->default_value("0.03"));
+    adder("confidence",
+          "Two-sided confidence level between 0 and 1",
+          cxxopts::value<double>()->default_value("0.95"));
+    adder("min-units",
+          "Units measured before stopping early",
+          cxxopts::value<unsigned long>()->default_value("30"));
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") != 0 || !result.unmatched().empty() ||
+        result.count("file") == 0) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+    if (result.count("debug") != 0) {
+        Logger::setInfoOutput(true);
+    } else {
+        Logger::setInfoOutput(false);
+    }
+    if (result.count("log-categories") != 0 &&
+        !Logger::setCategoryOutput(
+            result["log-categories"].as<std::string>().c_str()))
+        return -1;
+
+    const char *const overrides[][2] = {
+        {"latency", "memory.latency"},
+        {"cache-size", "cache.size"},
+        {"block-size", "cache.block_size"},
+        {"associativity", "cache.associativity"},
+        {"replace-type", "cache.replace"},
+    };
+    auto machine = parseMachineOptions(result, overrides);
+    // 抽样统计 Cache 命中率，总是使用带 Cache 的处理器
+    machine.type = ProcessorType::cache;
+    if (result.count("write-through") != 0) machine.writeThrough = true;
+    printMachineConfig(machine);
+    auto processor = std::make_unique<ProcessorWithCache>(machine);
+
+    SamplingConfig config;
+    config.period = result["period"].as<unsigned long>();
+    config.warmup = result["warmup"].as<unsigned long>();
+    config.detailedWarmup = result["detail-warmup"].as<unsigned long>();
+    config.unit = result["unit"].as<unsigned long>();
+    config.errorBound = result["error"].as<double>();
+    config.confidence = result["confidence"].as<double>();
+    config.minUnits = result["min-units"].as<unsigned long>();
+
+    auto stats = executeSampling(
+        processor.get(), result["file"].as<std::string>(), config, 0);
+
+    fprintf(stderr,
+            "[ SAMPLE  ] %lu units over %lu instructions%s, %lu detailed "
+            "cycles\n",
+            stats.cpi.count,
+            stats.instructions,
+            stats.finished ? "" : " (stopped early)",
+            stats.detailedCycles);
+    fprintf(stderr,
+            "[ SAMPLE  ] CPI = %.4f +- %.4f (%.1f%% confidence)\n",
+            stats.cpi.mean(),
+            stats.cpi.halfWidth(stats.z),
+            config.confidence * 100);
+    fprintf(stderr,
+            "[ SAMPLE  ] Cache hit rate = %.4f +- %.4f\n",
+            stats.hitRate.mean(),
+            stats.hitRate.halfWidth(stats.z));
+    if (stats.finished && stats.cpi.count != 0)
+        fprintf(stderr,
+                "[ SAMPLE  ] Estimated total cycles = %.0f\n",
+                stats.cpi.mean() * (double) stats.instructions);
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cxxopts.hpp"
+#include "logger.h"
+#include "runner.h"
+#include "simpoint.h"
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("tomasulo-simpoint",
+                             "Basic Block Vector Profiler and SimPoint Runner");
+    auto adder = options.add_options();
+    adder("h,help", "Print Usage");
+    adder("f,file", "Input elf file", cxxopts::value<std::string>());
+    adder("o,output",
+          "Prefix of .bb, .simpoints and .weights files",
+          cxxopts::value<std::string>()->default_value("simpoint"));
+    adder("d,debug", "Print debug infos");
+    adder("log-categories",
+          "Subsystems printed with --debug, e.g. cache,rob",
+          cxxopts::value<std::string>());
+    adder("simulate", "Simulate the chosen intervals instead of profiling");
+    adder("interval",
+          "Instructions in each interval",
+          cxxopts::value<unsigned long>()->default_value("100000"));
+    adder("max-k",
+          "Maximum number of clusters",
+          cxxopts::value<unsigned>()->default_value("10"));
+    adder("seed",
+          "Seed of projection and clustering",
+          cxxopts::value<unsigned>()->default_value("0"));
+    adder("warmup",
+          "Instructions of functional warm-up before each interval",
+          cxxopts::value<unsigned long>()->default_value("20000"));
+    adder("detail-warmup",
+          "Instructions of detailed warm-up before each interval",
+          cxxopts::value<unsigned long>()->default_value("2000"));
+    adder("config",
+          "Machine configuration file, overridden by the options below",
+          cxxopts::value<std::string>());
+    adder("p,predict", "Use frontend with predictor");
+    adder("l,latency", "Memory Latency", cxxopts::value<std::string>());
+    adder("cache-size",
+          "Simulate with a data cache of this size",
+          cxxopts::value<std::string>());
+    adder("block-size", "Cache Block Size", cxxopts::value<std::string>());
+    adder("a,associativity",
+          "Cache Associativity",
+          cxxopts::value<std::string>());
+    adder("write-through", "Cache Write Through");
+    adder("replace-type",
+          "Cache Replace Type",
+          cxxopts::value<std::string>());
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") != 0 || !result.unmatched().empty() ||
+        result.count("file") == 0) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+    if (result.count("debug") != 0) {
+        Logger::setInfoOutput(true);
+    } else {
+        Logger::setInfoOutput(false);
+    }
+    if (result.count("log-categories") != 0 &&
+        !Logger::setCategoryOutput(
+            result["log-categories"].as<std::string>().c_str()))
+        return -1;
+
+    auto elfFile = result["file"].as<std::string>();
+    auto prefix = result["output"].as<std::string>();
+    auto interval = result["interval"].as<unsigned long>();
+
+    if (result.count("simulate") == 0) {
+        auto profile = profileBasicBlocks(elfFile, interval, 0);
+        auto points = chooseSimPoints(profile,
+                                      result["max-k"].as<unsigned>(),
+                                      result["seed"].as<unsigned>());
+
+        std::ofstream bb(prefix + ".bb");
+        std::ofstream simpoints(prefix + ".simpoints");
+        std::ofstream weights(prefix + ".weights");
+        writeBasicBlockVectors(profile, bb);
+        writeSimPoints(points, simpoints, weights);
+        fprintf(stderr,
+                "[ PROFILE ] %lu instructions, %zu intervals, %u basic "
+                "blocks, %zu simulation points\n",
+                profile.instructions,
+                profile.intervals.size(),
+                profile.blockCount,
+                points.size());
+        return 0;
+    }
+
+    std::ifstream simpoints(prefix + ".simpoints");
+    std::ifstream weights(prefix + ".weights");
+    if (!simpoints || !weights) {
+        Logger::Error("Cannot open %s.simpoints or %s.weights",
+                      prefix.c_str(),
+                      prefix.c_str());
+        return -1;
+    }
+    auto points = readSimPoints(simpoints, weights);
+
+    const char *const overrides[][2] = {
+        {"latency", "memory.latency"},
+        {"cache-size", "cache.size"},
+        {"block-size", "cache.block_size"},
+        {"associativity", "cache.associativity"},
+        {"replace-type", "cache.replace"},
+    };
+    auto machine = parseMachineOptions(result, overrides);
+    if (result.count("cache-size") != 0) {
+        machine.type = ProcessorType::cache;
+    } else if (result.count("predict") != 0) {
+        machine.type = ProcessorType::predict;
+    }
+    if (result.count("write-through") != 0) machine.writeThrough = true;
+    printMachineConfig(machine);
+    auto processor = makeProcessor(machine);
+
+    SimPointConfig config;
+    config.intervalSize = interval;
+    config.warmup = result["warmup"].as<unsigned long>();
+    config.detailedWarmup = result["detail-warmup"].as<unsigned long>();
+
+    auto stats =
+        executeSimPoints(processor.get(), elfFile, points, config, 0);
+    fprintf(stderr,
+            "[ SIMPNT  ] %lu of %zu points simulated in %lu detailed cycles\n",
+            stats.measuredPoints,
+            points.size(),
+            stats.detailedCycles);
+    fprintf(stderr,
+            "[ SIMPNT  ] Weighted CPI = %.4f, %lu instructions, estimated "
+            "%.0f cycles\n",
+            stats.cpi,
+            stats.instructions,
+            stats.estimatedCycles);
+    return 0;
+}
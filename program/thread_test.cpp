@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "logger.h"
+#include "runner.h"
+#include "work_pool.h"
+
+namespace {
+
+// 一次执行的可见结果
+struct RunResult {
+    unsigned long cycles = 0;
+    unsigned long memoryTime = 0;
+    unsigned long cacheHitTime = 0;
+    unsigned long long hash = 0;
+
+    bool operator==(const RunResult &other) const {
+        return cycles == other.cycles && memoryTime == other.memoryTime &&
+               cacheHitTime == other.cacheHitTime && hash == other.hash;
+    }
+};
+
+/**
+ * @brief 在新建的带 Cache 的处理器上执行 elf 到结束
+ *
+ * @param config 机器配置
+ * @param name elf 路径
+ * @return RunResult 周期数、访存时间、Cache 命中时间以及寄存器堆与
+ * 数据内存的散列
+ */
+RunResult run(const MachineConfig &config, const std::string &name) {
+    auto p = makeProcessor(config);
+    auto cpu = static_cast<ProcessorWithCache *>(p.get());
+    RunResult result;
+    result.cycles = executeWithCache(cpu,
+                                     result.memoryTime,
+                                     result.cacheHitTime,
+                                     name,
+                                     std::vector<int>());
+
+    // FNV-1a
+    result.hash = 0xcbf29ce484222325ull;
+    auto mix = [&](unsigned x) {
+        result.hash ^= x;
+        result.hash *= 0x100000001b3ull;
+    };
+    for (unsigned i = 0; i < 32; i++) mix(p->readReg(i));
+    for (unsigned i = 0; i < DATA_MEM_SIZE; i += 4)
+        mix(p->readMem(0x80400000u + i));
+    return result;
+}
+
+}  // namespace
+
+int main() {
+    std::string name;
+    std::cout << "Elf file name: ";
+    std::cin >> name;
+
+    Logger::setInfoOutput(false);
+    Logger::setWarnOutput(false);
+
+    // 随机替换使用各处理器自己的发生器，不同种子的结果应互不影响
+    const unsigned threads = 6;
+    std::vector<MachineConfig> configs(threads);
+    for (unsigned i = 0; i < threads; i++) {
+        configs[i].type = ProcessorType::cache;
+        configs[i].replaceType = ReplaceType::RANDOM;
+        configs[i].seed = static_cast<int>(i % 3);
+        configs[i].cacheSize = i < 3 ? 1024 : 4096;
+    }
+
+    std::vector<RunResult> serial(threads), parallel(threads);
+    for (unsigned i = 0; i < threads; i++) serial[i] = run(configs[i], name);
+    parallelFor(threads, threads, [&](unsigned long i) {
+        parallel[i] = run(configs[i], name);
+    });
+
+    bool passed = true;
+    for (unsigned i = 0; i < threads; i++) {
+        bool same = serial[i] == parallel[i];
+        printf("seed %d cache %4u: %lu cycles serial, %lu on thread %u, %s\n",
+               configs[i].seed,
+               configs[i].cacheSize,
+               serial[i].cycles,
+               parallel[i].cycles,
+               i,
+               same ? "equal" : "different");
+        passed = passed && same;
+    }
+    printf(passed ? "PASSED\n" : "FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "cxxopts.hpp"
+#include "instructions.h"
+#include "logger.h"
+#include "trace.h"
+
+/**
+ * @brief 反汇编追踪记录中的指令，无法识别的编码原样输出
+ *
+ * @param record
+ * @return std::string
+ */
+std::string disassemble(const TraceRecord &record) {
+    auto inst = Instruction::predecode(record.instruction);
+    inst.pc = record.pc;
+    std::stringstream ss;
+    if (inst.opcode == Opcode::INVALID) {
+        ss << "unknown 0x" << std::hex << record.instruction;
+    } else {
+        ss << inst;
+    }
+    return ss.str();
+}
+
+/**
+ * @brief 以与模拟器信息输出相同的格式打印一条追踪记录
+ *
+ * @param record
+ */
+void print(const TraceRecord &record) {
+    static const char *const accessType[] = {"read", "write"};
+    printf("[  INFO   ] cycle %lu: ", record.cycle);
+    switch (record.event) {
+    case TraceEvent::FETCH:
+        printf("Fetching %s with pc = %08x\n",
+               disassemble(record).c_str(),
+               record.pc);
+        break;
+    case TraceEvent::DISPATCH:
+        printf("Dispatching %s with pc = %08x, ROB index: %u\n",
+               disassemble(record).c_str(),
+               record.pc,
+               record.robIdx);
+        break;
+    case TraceEvent::ISSUE:
+        printf("Execute pipeline %s: Running %s, ROB Index: %u\n",
+               getFUName(static_cast<FUType>(record.unit)),
+               disassemble(record).c_str(),
+               record.robIdx);
+        break;
+    case TraceEvent::WRITEBACK:
+        printf("Writing entry %u, pc = %08x, result = %u\n",
+               record.robIdx,
+               record.pc,
+               record.value);
+        break;
+    case TraceEvent::COMMIT:
+        printf("Committing instruction %s: ROB index: %u, pc = %08x, "
+               "value = %u\n",
+               disassemble(record).c_str(),
+               record.robIdx,
+               record.pc,
+               record.value);
+        break;
+    case TraceEvent::CACHE_HIT:
+        printf("Cache %s hit, address: 0x%08x, index = %u\n",
+               accessType[record.unit & 1u],
+               record.address,
+               record.value);
+        break;
+    case TraceEvent::CACHE_MISS:
+        printf("Cache %s miss, address: 0x%08x, ReplaceID = %u\n",
+               accessType[record.unit & 1u],
+               record.address,
+               record.value);
+        break;
+    case TraceEvent::CACHE_EVICT:
+        printf("Cache %s evicts block 0x%08x%s\n",
+               accessType[record.unit & 1u],
+               record.address,
+               record.value != 0 ? ", writing back" : "");
+        break;
+    case TraceEvent::MEMORY_READ:
+        printf("Reading Memory 0x%08x, data = %d\n",
+               record.address,
+               record.value);
+        break;
+    case TraceEvent::MEMORY_WRITE:
+        printf("Writing Memory 0x%08x, data = %d\n",
+               record.address,
+               record.value);
+        break;
+    default:
+        printf("Unknown event %u\n", static_cast<unsigned>(record.event));
+        break;
+    }
+}
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("trace-decode", "Tomasulo Trace Decoder");
+    auto adder = options.add_options();
+    adder("h,help", "Print Usage");
+    adder("f,file", "Input trace file", cxxopts::value<std::string>());
+    adder("begin", "First cycle to print", cxxopts::value<unsigned long>());
+    adder("end", "Last cycle to print", cxxopts::value<unsigned long>());
+    adder("pc",
+          "Only print events of this pc (hex)",
+          cxxopts::value<std::string>());
+    adder("rob",
+          "Only print events of this ROB index",
+          cxxopts::value<unsigned>());
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") != 0 || !result.unmatched().empty() ||
+        result.count("file") == 0) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    auto fileName = result["file"].as<std::string>();
+    FILE *file = fopen(fileName.c_str(), "rb");
+    if (file == nullptr) {
+        Logger::Error("Cannot open trace file %s", fileName.c_str());
+        return -1;
+    }
+
+    TraceHeader header{};
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        std::string(header.magic, sizeof(header.magic)) !=
+            std::string(TRACE_MAGIC, sizeof(TRACE_MAGIC)) ||
+        header.version != TRACE_VERSION ||
+        header.recordSize != sizeof(TraceRecord) || header.capacity == 0) {
+        Logger::Error("%s is not a valid trace file", fileName.c_str());
+        fclose(file);
+        return -1;
+    }
+
+    unsigned long begin =
+        result.count("begin") != 0 ? result["begin"].as<unsigned long>() : 0;
+    unsigned long end = result.count("end") != 0
+                            ? result["end"].as<unsigned long>()
+                            : -1ul;
+    bool filterPC = result.count("pc") != 0;
+    unsigned pc = filterPC
+                      ? std::stoul(result["pc"].as<std::string>(), nullptr, 16)
+                      : 0;
+    bool filterROB = result.count("rob") != 0;
+    unsigned rob = filterROB ? result["rob"].as<unsigned>() : 0;
+
+    // 缓冲区写满后，最旧的记录位于下一次写入的位置
+    unsigned long count = std::min(header.written, header.capacity);
+    unsigned long first = header.written > header.capacity
+                              ? header.written % header.capacity
+                              : 0;
+    if (header.written > header.capacity) {
+        Logger::Warn("Trace buffer wrapped, %lu oldest records are lost",
+                     header.written - header.capacity);
+    }
+
+    for (unsigned long i = 0; i < count; i++) {
+        auto slot = (first + i) % header.capacity;
+        TraceRecord record{};
+        bool seek = i == 0 || slot == 0;
+        if ((seek && fseek(file,
+                           static_cast<long>(sizeof(TraceHeader) +
+                                             slot * sizeof(TraceRecord)),
+                           SEEK_SET) != 0) ||
+            fread(&record, sizeof(record), 1, file) != 1) {
+            Logger::Error("Trace file %s is truncated", fileName.c_str());
+            fclose(file);
+            return -1;
+        }
+        if (record.cycle < begin || record.cycle > end) continue;
+        if (filterPC && record.pc != pc) continue;
+        if (filterROB && record.robIdx != rob) continue;
+        print(record);
+    }
+
+    fclose(file);
+    return 0;
+}
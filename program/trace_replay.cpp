@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cxxopts.hpp"
+#include "inst_trace.h"
+#include "logger.h"
+#include "replay.h"
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("tomasulo-trace-replay",
+                             "Record and replay committed instruction traces");
+    auto adder = options.add_options();
+    adder("h,help", "Print Usage");
+    adder("f,file", "Input elf file to record", cxxopts::value<std::string>());
+    adder("a,args",
+          "Comma separated program arguments",
+          cxxopts::value<std::vector<int>>());
+    adder("r,record",
+          "Record the committed instructions of the elf into file",
+          cxxopts::value<std::string>());
+    adder("t,trace", "Replay a recorded trace", cxxopts::value<std::string>());
+    adder("config",
+          "Machine configuration file, overridden by the options below",
+          cxxopts::value<std::string>());
+    adder("p,predict", "Use frontend with predictor");
+    adder("cache", "Use backend with data cache");
+    adder("l,latency", "Memory Latency", cxxopts::value<std::string>());
+    adder("cache-size", "Cache size in bytes", cxxopts::value<std::string>());
+    adder("block-size",
+          "Cache block size in bytes",
+          cxxopts::value<std::string>());
+    adder("associativity",
+          "Cache associativity",
+          cxxopts::value<std::string>());
+    adder("write-through", "Use write-through cache");
+    adder("replace",
+          "Cache replacement: FIFO, LRU or RANDOM",
+          cxxopts::value<std::string>());
+    adder("seed",
+          "Seed of memory latency and random replacement",
+          cxxopts::value<std::string>());
+    adder("rob-size", "Reorder buffer entries", cxxopts::value<std::string>());
+    adder("rs-size",
+          "Reservation station entries per execute unit",
+          cxxopts::value<std::string>());
+    adder("fu-latency",
+          "Cycles of ALU,BRU,LSU,MUL,DIV",
+          cxxopts::value<std::string>());
+    adder("check",
+          "Also run the elf on the detailed model and compare cycles");
+    adder("tolerance",
+          "Relative cycle difference accepted by --check",
+          cxxopts::value<double>()->default_value("0.05"));
+    adder("d,debug", "Print debug infos");
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") != 0 || !result.unmatched().empty() ||
+        (result.count("record") == 0 && result.count("trace") == 0)) {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+    Logger::setInfoOutput(result.count("debug") != 0);
+    bool check = result.count("check") != 0;
+    if (check && (result.count("file") == 0 || result.count("trace") == 0)) {
+        Logger::Error("--check needs both the elf and the trace");
+        return -1;
+    }
+    auto args = result.count("args") != 0
+                    ? result["args"].as<std::vector<int>>()
+                    : std::vector<int>();
+
+    if (result.count("record") != 0) {
+        if (result.count("file") == 0) {
+            Logger::Error("Input elf file is required for recording");
+            return -1;
+        }
+        RegisterFile regFile;
+        Memory memory(0);
+        recordInstTrace(result["file"].as<std::string>(),
+                        result["record"].as<std::string>(),
+                        regFile,
+                        memory,
+                        args);
+    }
+    if (result.count("trace") == 0) return 0;
+
+    const char *const overrides[][2] = {
+        {"latency", "memory.latency"},
+        {"cache-size", "cache.size"},
+        {"block-size", "cache.block_size"},
+        {"associativity", "cache.associativity"},
+        {"replace", "cache.replace"},
+        {"seed", "memory.seed"},
+        {"rob-size", "core.rob_size"},
+        {"rs-size", "core.rs_size"},
+        {"fu-latency", "core.fu_latency"},
+    };
+    auto config = parseMachineOptions(result, overrides);
+    if (result.count("cache") != 0) {
+        config.type = ProcessorType::cache;
+    } else if (result.count("predict") != 0) {
+        config.type = ProcessorType::predict;
+    }
+    if (result.count("write-through") != 0) config.writeThrough = true;
+    printMachineConfig(config);
+
+    auto start = std::chrono::steady_clock::now();
+    InstTrace trace(result["trace"].as<std::string>());
+    auto stats = replayTrace(trace, config);
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    Logger::Warn("Replayed %lu instructions with %lu mispredicts in %.3f s.",
+                 stats.instructions,
+                 stats.mispredicts,
+                 seconds);
+    if (config.type == ProcessorType::cache)
+        Logger::Warn("Memory accesses: %lu, cache hits: %lu.",
+                     stats.memoryAccesses,
+                     stats.cacheHits);
+    Logger::Warn("Finished in %lu cycles.", stats.cycles);
+    if (!check) return 0;
+
+    // 追踪应记录自同一 elf 与参数，周期级模型使用相同的机器描述
+    auto p = makeProcessor(config);
+    unsigned long cycles =
+        execute(p.get(), result["file"].as<std::string>(), args);
+    double difference =
+        ((double) stats.cycles - (double) cycles) / (double) cycles;
+    bool passed = std::fabs(difference) <= result["tolerance"].as<double>();
+    Logger::Warn("Detailed model: %lu cycles, replay differs by %+.2f%%, %s.",
+                 cycles,
+                 difference * 100,
+                 passed ? "within tolerance" : "out of tolerance");
+    return passed ? 0 : 1;
+}